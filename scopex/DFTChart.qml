@@ -51,6 +51,11 @@ ChartView {
                 dftYAxis.max = Math.ceil(maxMag * 1.1) // Add 10% headroom
             }
 
+            // Frequency axis spans DC to Nyquist of the current sample rate
+            if (dftData.length > 1) {
+                dftXAxis.max = dftData[dftData.length - 1].x
+            }
+
             // Second pass: add data points
             for (var j = 0; j < dftData.length; j++) {
                 if (dftData[j] && typeof dftData[j].x === 'number' && typeof dftData[j].y === 'number') {
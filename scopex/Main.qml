@@ -26,16 +26,19 @@ ApplicationWindow {
     property int digitalInputs: 0
     property string statusMessage: "Ready"
     property int currentTab: 0
+    property int displayMode: 0
+    property var pendingDft: null   // Newest spectrum not yet drawn
     SerialHandler {
         id: serialHandler
-        onDataReceived: function(ch1Data, ch2Data) {
-            scopeChart.updateData(ch1Data, ch2Data)
-            if (currentTab === 1) { // DFT tab
-                calculateDFT(ch1Data)
-            }
+        dftEnabled: currentTab === 1 // DFT tab
+        onMaskChanged: function(upper, lower) {
+            scopeChart.updateMask(upper, lower)
+        }
+        onEventShown: function(index, offset, width) {
+            scopeChart.centerOn(offset, Math.max(width * 4, 40))
         }
         onDftCalculated: function(dftData) {
-            dftChart.updateData(dftData)
+            pendingDft = dftData
         }
         onDigitalInputsChanged: function(inputs) {
             digitalInputs = inputs
@@ -48,6 +51,26 @@ ApplicationWindow {
         }
     }
 
+    TraceSource {
+        id: traceSource
+        handler: serialHandler
+        onDataReady: scopeChart.updateData()
+        onEnvelopeReady: scopeChart.updateEnvelope()
+    }
+
+    // Charts redraw once per rendered frame with the newest data; frames
+    // arriving faster than that are skipped for display only
+    FrameAnimation {
+        running: traceSource.pending || pendingDft !== null
+        onTriggered: {
+            traceSource.present()
+            if (pendingDft !== null) {
+                dftChart.updateData(pendingDft)
+                pendingDft = null
+            }
+        }
+    }
+
     TabBar {
         id: tabBar
         width: parent.width
@@ -78,6 +101,81 @@ ApplicationWindow {
                     triggerColor: mainWindow.triggerColor
                     triggerLevel: mainWindow.triggerLevel
                     showTriggerLine: mainWindow.showTriggerLine
+                    showEnvelope: serialHandler.acquisitionMode === SerialHandler.EnvelopeAcquisition
+                    maskChannel: serialHandler.maskChannel
+                    recordLength: serialHandler.recordLength
+                    source: traceSource
+                    visible: displayMode !== 3 && displayMode !== 6 && !serialHandler.rollMode
+                    onVisibleWindowChanged: function(first, last) {
+                        serialHandler.setVisibleWindow(first, last)
+                    }
+                }
+
+                // Samples scroll in as they are converted, newest at the right
+                RollView {
+                    id: rollView
+                    Layout.fillWidth: true
+                    Layout.fillHeight: true
+                    visible: serialHandler.rollMode && displayMode !== 3 && displayMode !== 6
+                    clip: true
+                    source: serialHandler
+                    ch1Color: mainWindow.ch1Color
+                    ch2Color: mainWindow.ch2Color
+                }
+
+                XYView {
+                    id: xyView
+                    Layout.fillWidth: true
+                    Layout.fillHeight: true
+                    visible: displayMode === 3 // XY
+                    source: serialHandler
+                    color: mainWindow.ch1Color
+                    persistence: storageCheck.checked ? 0.95 : 0.0
+                    interpolation: serialHandler.interpolationMode === SerialHandler.SincInterpolation
+                }
+
+                EyeDiagramView {
+                    id: eyeView
+                    Layout.fillWidth: true
+                    Layout.fillHeight: true
+                    visible: displayMode === 6 // Eye
+                    source: serialHandler
+                    channel: eyeChannelCombo.currentIndex
+                    unitIntervals: eyeSpanCombo.currentIndex + 1
+                    color: channel === 0 ? mainWindow.ch1Color : mainWindow.ch2Color
+                }
+
+                RowLayout {
+                    Layout.fillWidth: true
+                    visible: eyeView.visible
+                    ComboBox {
+                        id: eyeChannelCombo
+                        model: ["CH1", "CH2"]
+                    }
+                    ComboBox {
+                        id: eyeSpanCombo
+                        model: ["1 UI", "2 UI"]
+                        currentIndex: 1
+                    }
+                    Label { text: "Bit rate (0 = auto):" }
+                    TextField {
+                        text: "0"
+                        validator: DoubleValidator { bottom: 0 }
+                        onEditingFinished: eyeView.bitRate = parseFloat(text)
+                    }
+                    Button {
+                        text: "Clear"
+                        onClicked: eyeView.clear()
+                    }
+                    Label {
+                        property var m: eyeView.measurements
+                        visible: m.valid
+                        text: (m.bitRate / 1000).toFixed(2) + " kbit/s"
+                              + "  Height " + m.eyeHeight.toFixed(3) + " V"
+                              + "  Width " + (m.eyeWidth * 1e6).toFixed(2) + " µs"
+                              + "  Jitter " + (m.jitterRms * 1e9).toFixed(0) + " ns rms, "
+                              + (m.jitterPeakToPeak * 1e9).toFixed(0) + " ns p-p"
+                    }
                 }
 
                 RowLayout {
@@ -149,13 +247,87 @@ ApplicationWindow {
                     GroupBox {
                         title: "Timebase"
                         Layout.fillWidth: true
-                        ComboBox {
-                            model: [
-                                "2Mbps 0.5µs", "1Mbps 1µs", "500kbps 2µs", "200kbps 5µs",
-                                "100kbps 10µs", "50kbps 20µs", "20kbps 50µs", "10kbps 100µs",
-                                "5kbps 200µs", "2kbps 500µs", "1kbps 1ms", "500Hz 2ms",
-                                "200Hz 5ms", "100Hz 10ms"
-                            ]
+                        ColumnLayout {
+                            ComboBox {
+                                model: [
+                                    "2Mbps 0.5µs", "1Mbps 1µs", "500kbps 2µs", "200kbps 5µs",
+                                    "100kbps 10µs", "50kbps 20µs", "20kbps 50µs", "10kbps 100µs",
+                                    "5kbps 200µs", "2kbps 500µs", "1kbps 1ms", "500Hz 2ms",
+                                    "200Hz 5ms", "100Hz 10ms"
+                                ]
+                                currentIndex: 10
+                                onActivated: serialHandler.setSampleRate(currentIndex)
+                            }
+                            RowLayout {
+                                Label { text: "Record length:" }
+                                ComboBox {
+                                    model: [200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 65536]
+                                    // Follows the length in effect, which the device may have changed
+                                    currentIndex: model.indexOf(serialHandler.recordLength)
+                                    displayText: serialHandler.recordLength
+                                    onActivated: serialHandler.recordLength = model[currentIndex]
+                                }
+                            }
+                            RowLayout {
+                                Label { text: "Sample format:" }
+                                ComboBox {
+                                    model: ["8-bit", "12-bit packed", "10-bit", "16-bit"]
+                                    currentIndex: serialHandler.sampleFormat
+                                    onActivated: serialHandler.sampleFormat = currentIndex
+                                }
+                            }
+                        }
+                    }
+
+                    // Acquisition Controls
+                    GroupBox {
+                        title: "Acquisition"
+                        Layout.fillWidth: true
+                        ColumnLayout {
+                            ComboBox {
+                                model: ["Normal", "Average", "Exp. Average", "Envelope", "High Res"]
+                                onCurrentIndexChanged: serialHandler.acquisitionMode = currentIndex
+                            }
+                            SpinBox {
+                                from: 2
+                                to: 256
+                                value: serialHandler.acquisitionDepth
+                                enabled: serialHandler.acquisitionMode !== SerialHandler.NormalAcquisition
+                                         && serialHandler.acquisitionMode !== SerialHandler.EnvelopeAcquisition
+                                onValueModified: serialHandler.acquisitionDepth = value
+                            }
+                            Button {
+                                text: "Reset (" + serialHandler.acquiredFrames + ")"
+                                onClicked: serialHandler.resetAcquisition()
+                            }
+                            Label {
+                                // Only in builds that count allocations
+                                visible: serialHandler.frameStats.allocations >= 0
+                                text: serialHandler.frameStats.allocations + " allocations/frame, "
+                                      + serialHandler.frameStats.pooledFrames + " pooled frames"
+                            }
+                            Label {
+                                text: traceSource.displayStats.fps.toFixed(0) + " fps, "
+                                      + traceSource.displayStats.dropped + " skipped"
+                            }
+                            RowLayout {
+                                CheckBox {
+                                    text: "Equiv. time"
+                                    checked: serialHandler.equivalentTime
+                                    onToggled: serialHandler.equivalentTime = checked
+                                }
+                                SpinBox {
+                                    from: 10
+                                    to: 50
+                                    value: serialHandler.equivalentTimeFactor
+                                    enabled: serialHandler.equivalentTime
+                                    onValueModified: serialHandler.equivalentTimeFactor = value
+                                }
+                            }
+                            Label {
+                                visible: serialHandler.equivalentTime
+                                text: "Coverage: " + (serialHandler.equivalentTimeCoverage * 100).toFixed(0) + "%"
+                            }
                         }
                     }
 
@@ -165,10 +337,28 @@ ApplicationWindow {
                         Layout.fillWidth: true
                         ColumnLayout {
                             ComboBox {
-                                model: ["CH1+CH2", "CH1", "CH2", "XY", "CH1 DFT", "CH2 DFT"]
+                                model: ["CH1+CH2", "CH1", "CH2", "XY", "CH1 DFT", "CH2 DFT", "Eye"]
+                                onCurrentIndexChanged: displayMode = currentIndex
                             }
                             CheckBox { text: "Overplot" }
-                            CheckBox { text: "Storage" }
+                            CheckBox {
+                                id: storageCheck
+                                text: "Storage"
+                                onToggled: xyView.clear()
+                            }
+                            RowLayout {
+                                ComboBox {
+                                    model: ["Linear", "Sin(x)/x"]
+                                    onCurrentIndexChanged: serialHandler.interpolationMode = currentIndex
+                                }
+                                SpinBox {
+                                    from: 4
+                                    to: 16
+                                    value: serialHandler.interpolationFactor
+                                    enabled: serialHandler.interpolationMode === SerialHandler.SincInterpolation
+                                    onValueModified: serialHandler.interpolationFactor = value
+                                }
+                            }
                         }
                     }
                 }
@@ -188,15 +378,257 @@ ApplicationWindow {
                     }
                     Button {
                         text: "Single"
+                        enabled: !serialHandler.rollMode
                         onClicked: serialHandler.runCapture(false)
                     }
                     Button {
                         text: "Continuous"
                         onClicked: serialHandler.runCapture(true)
                     }
+                    CheckBox {
+                        text: "Roll"
+                        checked: serialHandler.rollMode
+                        onToggled: {
+                            // Switching mode stops whatever was running
+                            serialHandler.rollMode = checked
+                            isRunning = false
+                        }
+                    }
+                    SpinBox {
+                        from: 1
+                        to: 60
+                        value: serialHandler.rollSpan
+                        enabled: serialHandler.rollMode
+                        onValueModified: serialHandler.rollSpan = value
+                    }
+                    Label { text: "s" }
+                    ComboBox {
+                        id: exportFormatCombo
+                        model: ["CSV", "Binary", "WAV"]
+                    }
+                    Button {
+                        text: "Export Frame"
+                        enabled: !serialHandler.exporting
+                        onClicked: serialHandler.exportFrame("", exportFormatCombo.currentIndex)
+                    }
+                    ProgressBar {
+                        visible: serialHandler.exporting
+                        value: serialHandler.exportProgress
+                    }
+                    Button {
+                        text: "Cancel Export"
+                        visible: serialHandler.exporting
+                        onClicked: serialHandler.cancelExport()
+                    }
+                }
+
+                // Mask test: band around the current frame, counters follow every frame
+                RowLayout {
+                    Layout.fillWidth: true
+                    CheckBox {
+                        text: "Mask test"
+                        checked: serialHandler.maskEnabled
+                        enabled: serialHandler.maskDefined
+                        onToggled: serialHandler.maskEnabled = checked
+                    }
+                    ComboBox {
+                        model: ["CH1", "CH2"]
+                        currentIndex: serialHandler.maskChannel
+                        onActivated: serialHandler.maskChannel = currentIndex
+                    }
+                    Label { text: "Tolerance (V):" }
+                    TextField {
+                        id: maskToleranceField
+                        text: "0.5"
+                        validator: DoubleValidator { bottom: 0 }
+                    }
+                    Label { text: "Shift (samples):" }
+                    SpinBox {
+                        id: maskShiftBox
+                        from: 0
+                        to: 50
+                        value: 2
+                    }
                     Button {
-                        text: "Export CSV"
-                        onClicked: scopeChart.exportToCSV()
+                        text: "Mask from Frame"
+                        onClicked: serialHandler.setMaskFromReference(parseFloat(maskToleranceField.text),
+                                                                      maskShiftBox.value)
+                    }
+                    Button {
+                        text: "Clear Mask"
+                        onClicked: serialHandler.clearMask()
+                    }
+                    CheckBox {
+                        text: "Save failures"
+                        checked: serialHandler.maskSaveFailures
+                        onToggled: serialHandler.maskSaveFailures = checked
+                    }
+                    Button {
+                        text: "Reset Counters"
+                        onClicked: serialHandler.resetMaskCounters()
+                    }
+                    Label {
+                        visible: serialHandler.maskDefined
+                        color: serialHandler.maskLastPassed ? "green" : "red"
+                        text: (serialHandler.maskLastPassed ? "PASS" : "FAIL")
+                              + "  Tested " + serialHandler.maskTested
+                              + "  Failed " + serialHandler.maskFailed
+                              + "  (" + (serialHandler.maskFailureRate * 100).toFixed(2) + "%)"
+                    }
+                }
+
+                // Recording to disk and event search over an opened recording
+                RowLayout {
+                    Layout.fillWidth: true
+                    Button {
+                        text: serialHandler.recording ? "Stop Recording" : "Record"
+                        onClicked: serialHandler.recording ? serialHandler.stopRecording()
+                                                           : serialHandler.startRecording()
+                    }
+                    Label {
+                        visible: serialHandler.recording
+                        text: serialHandler.recordedFrames + " frames"
+                    }
+                    TextField {
+                        id: recordingPathField
+                        Layout.fillWidth: true
+                        placeholderText: "Recording file"
+                    }
+                    Button {
+                        text: serialHandler.playbackPath === "" ? "Open" : "Close"
+                        onClicked: serialHandler.playbackPath === ""
+                                   ? serialHandler.openRecording(recordingPathField.text)
+                                   : serialHandler.closeRecording()
+                    }
+                    Button {
+                        text: "Export Recording"
+                        enabled: serialHandler.playbackPath !== "" && !serialHandler.exporting
+                        onClicked: serialHandler.exportRecording("", exportFormatCombo.currentIndex)
+                    }
+                    ComboBox {
+                        id: searchTypeCombo
+                        model: ["Rising edge", "Falling edge", "Narrow pulse", "Wide pulse"]
+                    }
+                    ComboBox {
+                        id: searchChannelCombo
+                        model: ["CH1", "CH2"]
+                    }
+                    Label { text: "Level (V):" }
+                    TextField {
+                        id: searchLevelField
+                        text: "0"
+                        validator: DoubleValidator {}
+                    }
+                    Label { text: "Width (µs):" }
+                    TextField {
+                        id: searchWidthField
+                        text: "100"
+                        enabled: searchTypeCombo.currentIndex >= 2
+                        validator: DoubleValidator { bottom: 0 }
+                    }
+                    CheckBox {
+                        id: searchNegativeCheck
+                        text: "Negative"
+                        enabled: searchTypeCombo.currentIndex >= 2
+                    }
+                    Button {
+                        text: "Search"
+                        enabled: serialHandler.playbackPath !== "" && !serialHandler.searchRunning
+                        onClicked: serialHandler.searchRecording(searchTypeCombo.currentIndex,
+                                                                 searchChannelCombo.currentIndex,
+                                                                 parseFloat(searchLevelField.text),
+                                                                 parseFloat(searchWidthField.text) * 1e-6,
+                                                                 searchNegativeCheck.checked)
+                    }
+                    Button {
+                        text: "Prev"
+                        enabled: serialHandler.eventCount > 0
+                        onClicked: serialHandler.previousEvent()
+                    }
+                    Button {
+                        text: "Next"
+                        enabled: serialHandler.eventCount > 0
+                        onClicked: serialHandler.nextEvent()
+                    }
+                    Label {
+                        text: serialHandler.searchRunning ? "Searching..."
+                              : (serialHandler.currentEvent + 1) + " of " + serialHandler.eventCount
+                    }
+                }
+
+                // The open recording at any zoom, from its min/max/mean pyramid
+                RecordingOverview {
+                    Layout.fillWidth: true
+                    Layout.preferredHeight: 160
+                    visible: serialHandler.playbackPath !== ""
+                    source: traceSource
+                    duration: serialHandler.playbackDuration
+                    ready: serialHandler.overviewReady
+                    channel: searchChannelCombo.currentIndex
+                    color: searchChannelCombo.currentIndex === 0 ? mainWindow.ch1Color : mainWindow.ch2Color
+                }
+
+                // Serial traffic journal and replay through the parser
+                RowLayout {
+                    Layout.fillWidth: true
+                    Button {
+                        text: serialHandler.journaling ? "Stop Journal" : "Journal Serial"
+                        onClicked: serialHandler.journaling ? serialHandler.stopJournal()
+                                                            : serialHandler.startJournal()
+                    }
+                    TextField {
+                        id: journalPathField
+                        Layout.fillWidth: true
+                        placeholderText: "Journal file"
+                    }
+                    ComboBox {
+                        id: replaySpeedCombo
+                        model: ["Real time", "10x", "100x", "Fastest"]
+                    }
+                    Button {
+                        text: serialHandler.replaying ? "Stop Replay" : "Replay"
+                        onClicked: serialHandler.replaying
+                                   ? serialHandler.stopReplay()
+                                   : serialHandler.startReplay(journalPathField.text,
+                                                               [1, 10, 100, 0][replaySpeedCombo.currentIndex])
+                    }
+                    Label {
+                        visible: serialHandler.replayStats.records > 0
+                        text: (serialHandler.replayStats.progress * 100).toFixed(0) + "%  "
+                              + serialHandler.replayStats.records + " records  "
+                              + (serialHandler.replayStats.bytesPerSecond / 1e6).toFixed(1) + " MB/s parsed"
+                    }
+                }
+
+                // Streaming to remote viewers
+                RowLayout {
+                    Layout.fillWidth: true
+                    Button {
+                        text: serialHandler.streaming ? "Stop Streaming" : "Stream"
+                        onClicked: serialHandler.streaming ? serialHandler.stopStreaming()
+                                                           : serialHandler.startStreaming(parseInt(streamPortField.text),
+                                                                                          streamLanCheck.checked)
+                    }
+                    TextField {
+                        id: streamPortField
+                        text: "52100"
+                        enabled: !serialHandler.streaming
+                        validator: IntValidator { bottom: 0; top: 65535 }
+                    }
+                    CheckBox {
+                        id: streamLanCheck
+                        text: "LAN"
+                        enabled: !serialHandler.streaming
+                    }
+                    Label {
+                        visible: serialHandler.streaming
+                        text: serialHandler.streamStats.clients + " viewers  "
+                              + serialHandler.streamStats.dropped + " dropped"
+                    }
+                    Button {
+                        text: serialHandler.sharing ? "Stop Sharing" : "Share Memory"
+                        onClicked: serialHandler.sharing ? serialHandler.stopSharing()
+                                                         : serialHandler.startSharing()
                     }
                 }
             }
@@ -208,10 +640,48 @@ ApplicationWindow {
                 anchors.fill: parent
                 spacing: 5
 
-                DFTChart {
-                    id: dftChart
+                RowLayout {
                     Layout.fillWidth: true
                     Layout.fillHeight: true
+
+                    DFTChart {
+                        id: dftChart
+                        Layout.fillWidth: true
+                        Layout.fillHeight: true
+                    }
+
+                    ColumnLayout {
+                        Layout.fillWidth: true
+                        Layout.fillHeight: true
+
+                        WaterfallView {
+                            id: waterfall
+                            Layout.fillWidth: true
+                            Layout.fillHeight: true
+                            source: serialHandler
+                            channel: waterfallChannelCombo.currentIndex
+                            fftSize: 2048
+                            overlap: 0.75
+                            streaming: waterfallStreamCheck.checked
+                        }
+
+                        RowLayout {
+                            ComboBox {
+                                id: waterfallChannelCombo
+                                model: ["CH1", "CH2"]
+                            }
+                            CheckBox {
+                                id: waterfallStreamCheck
+                                text: "Continuous stream"
+                                checked: true
+                            }
+                            Button {
+                                text: "Clear"
+                                onClicked: waterfall.clear()
+                            }
+                            Label { text: waterfall.rowRate.toFixed(0) + " rows/s" }
+                        }
+                    }
                 }
 
                 RowLayout {
@@ -285,6 +755,118 @@ ApplicationWindow {
                     }
                 }
 
+                // Distortion figures of the fundamental found on one channel
+                GroupBox {
+                    title: "Distortion"
+                    Layout.fillWidth: true
+                    RowLayout {
+                        CheckBox {
+                            text: "Analyze"
+                            checked: serialHandler.distortionEnabled
+                            onToggled: serialHandler.distortionEnabled = checked
+                        }
+                        ComboBox {
+                            model: ["CH1", "CH2"]
+                            currentIndex: serialHandler.distortionChannel
+                            onActivated: serialHandler.distortionChannel = currentIndex
+                        }
+                        Label { text: "Averages:" }
+                        SpinBox {
+                            from: 1
+                            to: 64
+                            value: serialHandler.distortionAverages
+                            onValueModified: serialHandler.distortionAverages = value
+                        }
+                        Label {
+                            property var d: serialHandler.distortion
+                            visible: serialHandler.distortionEnabled && d.valid
+                            text: d.frequency.toFixed(1) + " Hz  " + d.amplitude.toFixed(3) + " Vpk"
+                                  + "  THD " + d.thd.toFixed(1) + " dB (" + d.thdPercent.toFixed(3) + "%)"
+                                  + "  THD+N " + d.thdPlusNoise.toFixed(1) + " dB"
+                                  + "  SNR " + d.snr.toFixed(1) + " dB"
+                                  + "  SINAD " + d.sinad.toFixed(1) + " dB"
+                                  + "  SFDR " + d.sfdr.toFixed(1) + " dBc"
+                                  + "  ENOB " + d.enob.toFixed(2)
+                        }
+                    }
+                }
+
+                // Delay and phase of CH2 relative to CH1
+                GroupBox {
+                    title: "Cross-Channel"
+                    Layout.fillWidth: true
+                    RowLayout {
+                        CheckBox {
+                            text: "Analyze"
+                            checked: serialHandler.crossChannelEnabled
+                            onToggled: serialHandler.crossChannelEnabled = checked
+                        }
+                        Label { text: "Averages:" }
+                        SpinBox {
+                            from: 1
+                            to: 256
+                            value: serialHandler.crossChannelAverages
+                            onValueModified: serialHandler.crossChannelAverages = value
+                        }
+                        Label {
+                            property var c: serialHandler.crossChannel
+                            visible: serialHandler.crossChannelEnabled && c.valid
+                            text: "Delay " + (c.delay * 1e6).toFixed(2) + " µs (" + c.delaySamples.toFixed(2) + " samples)"
+                                  + "  r " + c.correlation.toFixed(3)
+                                  + "  " + c.frequency.toFixed(1) + " Hz"
+                                  + "  Phase " + c.phase.toFixed(1) + "°"
+                                  + "  Gain " + c.gain.toFixed(2) + " dB"
+                                  + "  Coherence " + c.coherence.toFixed(3)
+                        }
+                    }
+                }
+
+                // Self-calibration drives the selected channel from the DDS
+                GroupBox {
+                    title: "Calibration"
+                    Layout.fillWidth: true
+                    RowLayout {
+                        ComboBox {
+                            id: calChannelCombo
+                            model: ["CH1", "CH2"]
+                            enabled: !serialHandler.calibrating
+                        }
+                        Label { text: "Reference (V):" }
+                        TextField {
+                            id: calAmplitudeField
+                            text: "5.0"
+                            validator: DoubleValidator { bottom: 0.01; top: 10 }
+                            enabled: !serialHandler.calibrating
+                        }
+                        Button {
+                            text: serialHandler.calibrating ? "Cancel" : "Self-Calibrate"
+                            onClicked: {
+                                if (serialHandler.calibrating) {
+                                    serialHandler.cancelSelfCalibration()
+                                } else {
+                                    serialHandler.startSelfCalibration(calChannelCombo.currentIndex,
+                                                                       parseFloat(calAmplitudeField.text))
+                                }
+                            }
+                        }
+                        ProgressBar {
+                            Layout.fillWidth: true
+                            value: serialHandler.calibrationProgress
+                            visible: serialHandler.calibrating
+                        }
+                        Button {
+                            text: "Reload"
+                            enabled: !serialHandler.calibrating
+                            onClicked: serialHandler.loadCalibration()
+                        }
+                        Button {
+                            text: "Clear"
+                            enabled: !serialHandler.calibrating
+                            onClicked: serialHandler.clearCalibration()
+                        }
+                    }
+                }
+
                 RowLayout {
                     Layout.fillWidth: true
                     Button {
@@ -0,0 +1,115 @@
+import QtQuick
+import QtCharts
+
+// Envelope and mean of one channel across an open recording. Each redraw
+// asks for one point per pixel column, so zooming anywhere in a long
+// recording costs the same.
+ChartView {
+    id: overviewChart
+    theme: ChartView.ChartThemeDark
+    antialiasing: true
+    animationOptions: ChartView.NoAnimation
+    legend.visible: false
+
+    // TraceSource the overview is pulled from
+    property var source: null
+    property real duration: 0
+    property bool ready: false
+    property int channel: 0
+    property color color: "red"
+
+    ValueAxis {
+        id: xAxis
+        min: 0
+        max: Math.max(duration, 1e-6)
+        titleText: "Time (s)"
+    }
+
+    ValueAxis {
+        id: yAxis
+        min: -10
+        max: 10
+        titleText: "Voltage (V)"
+    }
+
+    LineSeries {
+        id: maximumSeries
+        axisX: xAxis
+        axisY: yAxis
+        color: overviewChart.color
+        width: 1
+    }
+
+    LineSeries {
+        id: minimumSeries
+        axisX: xAxis
+        axisY: yAxis
+        color: overviewChart.color
+        width: 1
+    }
+
+    LineSeries {
+        id: meanSeries
+        axisX: xAxis
+        axisY: yAxis
+        color: "white"
+        width: 1
+    }
+
+    function refresh() {
+        if (!source || !ready) {
+            maximumSeries.clear()
+            minimumSeries.clear()
+            meanSeries.clear()
+            return
+        }
+        source.updateOverviewSeries(maximumSeries, minimumSeries, meanSeries, channel,
+                                    xAxis.min, xAxis.max, Math.max(1, Math.round(plotArea.width)))
+    }
+
+    function showAll() {
+        xAxis.min = 0
+        xAxis.max = Math.max(duration, 1e-6)
+        refresh()
+    }
+
+    onDurationChanged: showAll()
+    onReadyChanged: refresh()
+    onChannelChanged: refresh()
+    onPlotAreaChanged: refresh()
+
+    // Wheel zooms around the cursor, dragging pans, double-click shows all
+    WheelHandler {
+        acceptedDevices: PointerDevice.Mouse | PointerDevice.TouchPad
+        onWheel: function(event) {
+            var area = overviewChart.plotArea
+            var ratio = Math.min(Math.max((point.position.x - area.x) / area.width, 0), 1)
+            var span = xAxis.max - xAxis.min
+            var newSpan = event.angleDelta.y > 0 ? span / 1.25 : span * 1.25
+            newSpan = Math.min(newSpan, Math.max(duration, 1e-6))
+            var newMin = xAxis.min + (span - newSpan) * ratio
+            newMin = Math.min(Math.max(newMin, 0), Math.max(duration - newSpan, 0))
+            xAxis.min = newMin
+            xAxis.max = newMin + newSpan
+            overviewChart.refresh()
+        }
+    }
+
+    DragHandler {
+        target: null
+        property real startMin: 0
+        onActiveChanged: if (active) startMin = xAxis.min
+        onTranslationChanged: {
+            var span = xAxis.max - xAxis.min
+            var newMin = startMin - translation.x / overviewChart.plotArea.width * span
+            newMin = Math.min(Math.max(newMin, 0), Math.max(duration - span, 0))
+            xAxis.min = newMin
+            xAxis.max = newMin + span
+            overviewChart.refresh()
+        }
+    }
+
+    TapHandler {
+        onDoubleTapped: overviewChart.showAll()
+    }
+}
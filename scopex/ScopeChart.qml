@@ -14,12 +14,29 @@ ChartView {
     property real ch2Gain: 1.0
     property real triggerLevel: 0.0
     property bool showTriggerLine: true
+    property int recordLength: 200
+    property bool showEnvelope: false
+    property int maskChannel: 0
+    // TraceSource the traces are pulled from
+    property var source: null
+
+    // Emitted when zooming changes the visible sample range, so the handler
+    // only reconstructs what is on screen
+    signal visibleWindowChanged(int first, int last)
+
+    // Zooming replaces the axis bindings, so a new length resets the view
+    onRecordLengthChanged: {
+        xAxis.min = 0
+        xAxis.max = recordLength
+    }
 
     ValueAxis {
         id: xAxis
         min: 0
-        max: 200
+        max: recordLength
         titleText: "Time (µs)"
+        onMinChanged: chartView.visibleWindowChanged(Math.floor(min), Math.ceil(max) + 1)
+        onMaxChanged: chartView.visibleWindowChanged(Math.floor(min), Math.ceil(max) + 1)
     }
 
     ValueAxis {
@@ -47,6 +64,48 @@ ChartView {
         width: 2
     }
 
+    // Lower traces of the min/max envelope acquisition mode
+    LineSeries {
+        id: ch1MinSeries
+        name: "CH1 min"
+        axisX: xAxis
+        axisY: yAxis
+        color: ch1Color
+        width: 1
+        visible: showEnvelope
+    }
+
+    LineSeries {
+        id: ch2MinSeries
+        name: "CH2 min"
+        axisX: xAxis
+        axisY: yAxis
+        color: ch2Color
+        width: 1
+        visible: showEnvelope
+    }
+
+    // Mask bounds of the tested channel
+    LineSeries {
+        id: maskUpperSeries
+        name: "Mask"
+        axisX: xAxis
+        axisY: yAxis
+        color: "gray"
+        width: 1
+        style: Qt.DashLine
+    }
+
+    LineSeries {
+        id: maskLowerSeries
+        name: "Mask"
+        axisX: xAxis
+        axisY: yAxis
+        color: "gray"
+        width: 1
+        style: Qt.DashLine
+    }
+
     LineSeries {
         id: triggerLine
         name: "Trigger"
@@ -57,40 +116,76 @@ ChartView {
         visible: showTriggerLine
     }
 
-    function updateData(ch1Data, ch2Data) {
-        ch1Series.clear()
-        ch2Series.clear()
-
-        if (!ch1Data || !ch2Data) return
-
-        try {
-            // Process CH1 data
-            for (var i = 0; i < ch1Data.length; i++) {
-                if (ch1Data[i] && typeof ch1Data[i].x === 'number' && typeof ch1Data[i].y === 'number') {
-                    ch1Series.append(ch1Data[i].x, ch1Data[i].y / ch1Gain)
-                }
-            }
-
-            // Process CH2 data
-            for (var j = 0; j < ch2Data.length; j++) {
-                if (ch2Data[j] && typeof ch2Data[j].x === 'number' && typeof ch2Data[j].y === 'number') {
-                    ch2Series.append(ch2Data[j].x, ch2Data[j].y / ch2Gain)
-                }
-            }
-
-            // Update trigger line
-            if (showTriggerLine) {
-                triggerLine.clear()
-                triggerLine.append(0, triggerLevel)
-                triggerLine.append(xAxis.max, triggerLevel)
-            }
-        } catch (error) {
-            console.log("Error updating chart data:", error)
+    // Wheel zooms the time axis around the cursor, double-click resets it
+    WheelHandler {
+        acceptedDevices: PointerDevice.Mouse | PointerDevice.TouchPad
+        onWheel: function(event) {
+            var area = chartView.plotArea
+            var ratio = Math.min(Math.max((point.position.x - area.x) / area.width, 0), 1)
+            var span = xAxis.max - xAxis.min
+            var newSpan = event.angleDelta.y > 0 ? span / 1.25 : span * 1.25
+            newSpan = Math.min(Math.max(newSpan, 8), recordLength)
+            var newMin = xAxis.min + (span - newSpan) * ratio
+            newMin = Math.min(Math.max(newMin, 0), recordLength - newSpan)
+            xAxis.min = newMin
+            xAxis.max = newMin + newSpan
+        }
+    }
+
+    TapHandler {
+        onDoubleTapped: {
+            xAxis.min = 0
+            xAxis.max = recordLength
+        }
+    }
+
+    // Series and gain of each channel, in the order the handler sends them
+    function channelSeries() { return [ch1Series, ch2Series] }
+    function channelMinSeries() { return [ch1MinSeries, ch2MinSeries] }
+    function channelGains() { return [ch1Gain, ch2Gain] }
+
+    // The handler writes the visible points straight into each series
+    function updateData() {
+        if (!source) return
+
+        var series = channelSeries()
+        var gains = channelGains()
+        for (var c = 0; c < series.length; c++) source.updateSeries(series[c], c, gains[c])
+
+        // Update trigger line
+        if (showTriggerLine) {
+            triggerLine.clear()
+            triggerLine.append(0, triggerLevel)
+            triggerLine.append(xAxis.max, triggerLevel)
+        }
+    }
+
+    function updateEnvelope() {
+        if (!source) return
+
+        var series = channelMinSeries()
+        var gains = channelGains()
+        for (var c = 0; c < series.length; c++) source.updateEnvelopeSeries(series[c], c, gains[c])
+    }
+
+    function updateMask(upper, lower) {
+        maskUpperSeries.clear()
+        maskLowerSeries.clear()
+
+        var gain = maskChannel === 0 ? ch1Gain : ch2Gain
+        for (var i = 0; i < upper.length; i++) {
+            maskUpperSeries.append(upper[i].x, upper[i].y / gain)
+        }
+        for (var j = 0; j < lower.length; j++) {
+            maskLowerSeries.append(lower[j].x, lower[j].y / gain)
         }
     }
 
-    function exportToCSV() {
-        console.log("Export to CSV functionality - would save current data to file")
-        // TODO: Implement actual CSV export
+    // Zooms the time axis to `span` samples around a position
+    function centerOn(position, span) {
+        var newSpan = Math.min(Math.max(span, 8), recordLength)
+        var newMin = Math.min(Math.max(position - newSpan / 2, 0), recordLength - newSpan)
+        xAxis.min = newMin
+        xAxis.max = newMin + newSpan
     }
 }
@@ -0,0 +1,192 @@
+#include "acquisition.h"
+#include <limits>
+
+namespace {
+// Left shift that puts a code on the 8.8 scale, and the type the scaled
+// running sum is multiplied in
+template<typename Code> struct CodeScale;
+template<> struct CodeScale<quint8> { static constexpr int Shift = 8; using Product = quint32; };
+template<> struct CodeScale<quint16> { static constexpr int Shift = 0; using Product = quint64; };
+}
+
+FrameAccumulator::FrameAccumulator() :
+    m_mode(Normal),
+    m_length(0),
+    m_depth(1),
+    m_codeBytes(1),
+    m_frameCount(0),
+    m_historyHead(0)
+{
+}
+
+void FrameAccumulator::configure(Mode mode, int length, int depth, int codeBytes)
+{
+    m_mode = mode;
+    m_length = qMax(0, length);
+    m_depth = qBound(1, depth, MaxDepth);
+    m_codeBytes = codeBytes > 1 ? 2 : 1;
+
+    // Everything the modes need is allocated here, never per frame
+    const int ring = m_mode == RunningAverage ? m_depth * m_length : 0;
+    m_history.fill(0, m_codeBytes == 1 ? ring : 0);
+    m_wideHistory.fill(0, m_codeBytes == 2 ? ring : 0);
+    m_sum.fill(0, m_mode == HighResolution ? m_length + m_depth + 1 : m_length);
+    m_ema.fill(0, m_mode == ExponentialAverage ? m_length : 0);
+    m_max.fill(0, m_mode == Envelope ? m_length : 0);
+    m_min.fill(0, m_mode == Envelope ? m_length : 0);
+    m_result.fill(0, m_length);
+    m_minimum.fill(0, m_mode == Envelope ? m_length : 0);
+
+    reset();
+}
+
+void FrameAccumulator::reset()
+{
+    m_frameCount = 0;
+    m_historyHead = 0;
+    m_sum.fill(0);
+    m_max.fill(0);
+    m_min.fill(0xFFFF);
+}
+
+void FrameAccumulator::addFrame(const quint8 *codes)
+{
+    accumulate(codes);
+}
+
+void FrameAccumulator::addFrame(const quint16 *codes)
+{
+    accumulate(codes);
+}
+
+template<typename Code>
+void FrameAccumulator::accumulate(const Code *codes)
+{
+    switch (m_mode) {
+    case RunningAverage:
+        addRunningAverage(codes);
+        break;
+    case ExponentialAverage:
+        addExponentialAverage(codes);
+        break;
+    case Envelope:
+        addEnvelope(codes);
+        break;
+    case HighResolution:
+        addHighResolution(codes);
+        break;
+    case Normal:
+    default:
+        for (int i = 0; i < m_length; ++i) {
+            m_result[i] = static_cast<quint16>(codes[i] << CodeScale<Code>::Shift);
+        }
+        break;
+    }
+
+    if (m_frameCount < std::numeric_limits<int>::max()) ++m_frameCount;
+}
+
+template<typename Code>
+void FrameAccumulator::addRunningAverage(const Code *codes)
+{
+    Code *oldest = nullptr;
+    if constexpr (sizeof(Code) == 1) {
+        oldest = m_history.data() + m_historyHead * m_length;
+    } else {
+        oldest = m_wideHistory.data() + m_historyHead * m_length;
+    }
+    quint32 *sum = m_sum.data();
+    quint16 *out = m_result.data();
+
+    // Once the ring is full the oldest frame leaves the sum as the new one
+    // enters, so the cost per frame is independent of the depth
+    const bool full = m_frameCount >= m_depth;
+    for (int i = 0; i < m_length; ++i) {
+        sum[i] += codes[i] - (full ? oldest[i] : 0);
+        oldest[i] = codes[i];
+    }
+    m_historyHead = (m_historyHead + 1) % m_depth;
+
+    // sum * 2^Shift / n as a multiply by a 16-bit reciprocal; for 8-bit codes
+    // the product stays below 2^32 because sum <= 255 * n, 16-bit codes
+    // multiply in 64 bits
+    using Product = typename CodeScale<Code>::Product;
+    constexpr int shift = 16 - CodeScale<Code>::Shift;
+    const quint32 n = qMin(m_frameCount + 1, m_depth);
+    const quint32 reciprocal = ((1u << 16) + n / 2) / n;
+    for (int i = 0; i < m_length; ++i) {
+        out[i] = static_cast<quint16>(qMin<Product>((Product(sum[i]) * reciprocal) >> shift, 0xFFFF));
+    }
+}
+
+template<typename Code>
+void FrameAccumulator::addExponentialAverage(const Code *codes)
+{
+    constexpr int scale = CodeScale<Code>::Shift;
+    qint32 *ema = m_ema.data();
+    quint16 *out = m_result.data();
+
+    if (m_frameCount == 0) {
+        for (int i = 0; i < m_length; ++i) {
+            ema[i] = codes[i] << scale;
+        }
+    } else {
+        // Weight rounded down to a power of two so the update is a shift;
+        // the step is rounded to nearest, as a plain shift of a negative
+        // step would round toward -inf and drag the average low
+        int shift = 0;
+        while ((2 << shift) <= m_depth) ++shift;
+        const qint32 half = shift > 0 ? 1 << (shift - 1) : 0;
+        for (int i = 0; i < m_length; ++i) {
+            ema[i] += ((codes[i] << scale) - ema[i] + half) >> shift;
+        }
+    }
+
+    for (int i = 0; i < m_length; ++i) {
+        out[i] = static_cast<quint16>(ema[i]);
+    }
+}
+
+template<typename Code>
+void FrameAccumulator::addEnvelope(const Code *codes)
+{
+    constexpr int scale = CodeScale<Code>::Shift;
+    quint16 *maxCodes = m_max.data();
+    quint16 *minCodes = m_min.data();
+    quint16 *out = m_result.data();
+    quint16 *outMin = m_minimum.data();
+
+    for (int i = 0; i < m_length; ++i) {
+        const quint16 code = static_cast<quint16>(codes[i] << scale);
+        maxCodes[i] = qMax(maxCodes[i], code);
+        minCodes[i] = qMin(minCodes[i], code);
+        out[i] = maxCodes[i];
+        outMin[i] = minCodes[i];
+    }
+}
+
+template<typename Code>
+void FrameAccumulator::addHighResolution(const Code *codes)
+{
+    // Centred boxcar of m_depth samples from prefix sums over the frame
+    // with its edges held, one subtraction per output sample. The prefix
+    // sums may wrap with 16-bit codes; the differences stay exact because
+    // a window sums to less than 2^32.
+    using Product = typename CodeScale<Code>::Product;
+    constexpr int shift = 16 - CodeScale<Code>::Shift;
+    const int lead = m_depth / 2;
+    quint32 *prefix = m_sum.data();
+    quint16 *out = m_result.data();
+
+    prefix[0] = 0;
+    for (int i = 0; i < m_length + m_depth; ++i) {
+        const int src = qBound(0, i - lead, m_length - 1);
+        prefix[i + 1] = prefix[i] + codes[src];
+    }
+
+    const quint32 reciprocal = ((1u << 16) + m_depth / 2) / m_depth;
+    for (int i = 0; i < m_length; ++i) {
+        const quint32 sum = prefix[i + m_depth] - prefix[i];
+        out[i] = static_cast<quint16>(qMin<Product>((Product(sum) * reciprocal) >> shift, 0xFFFF));
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef ACQUISITION_H
+#define ACQUISITION_H
+
+#include <QVector>
+
+// Host-side acquisition modes that combine repeated triggered frames of one
+// channel. Samples are accumulated as integers and the result is published
+// as unsigned 8.8 fixed-point ADC codes, so averaged frames keep the bits that
+// a single 8-bit capture cannot resolve. Wide devices deliver left-justified
+// 16-bit codes, which are already on that scale. All storage is sized in
+// configure() and reused for every frame.
+class FrameAccumulator
+{
+public:
+    enum Mode {
+        Normal = 0,
+        RunningAverage = 1,      // Mean of the last `depth` frames
+        ExponentialAverage = 2,  // Each frame weighted 2^-floor(log2 depth)
+        Envelope = 3,            // Per-sample min/max since the last reset
+        HighResolution = 4       // Boxcar of `depth` neighbouring samples
+    };
+
+    static constexpr int FractionBits = 8;
+    static constexpr int MaxDepth = 256;
+
+    FrameAccumulator();
+
+    // codeBytes is 1 for 8-bit codes and 2 for left-justified 16-bit codes
+    void configure(Mode mode, int length, int depth, int codeBytes = 1);
+    void reset();
+
+    void addFrame(const quint8 *codes);
+    void addFrame(const quint16 *codes);
+
+    Mode mode() const { return m_mode; }
+    int length() const { return m_length; }
+    int depth() const { return m_depth; }
+    int codeBytes() const { return m_codeBytes; }
+    int frameCount() const { return m_frameCount; }
+
+    // 8.8 fixed-point codes of the combined frame; the envelope maximum in
+    // Envelope mode. minimum() is only meaningful in Envelope mode.
+    const quint16 *result() const { return m_result.constData(); }
+    const quint16 *minimum() const { return m_minimum.constData(); }
+
+private:
+    template<typename Code> void accumulate(const Code *codes);
+    template<typename Code> void addRunningAverage(const Code *codes);
+    template<typename Code> void addExponentialAverage(const Code *codes);
+    template<typename Code> void addEnvelope(const Code *codes);
+    template<typename Code> void addHighResolution(const Code *codes);
+
+    Mode m_mode;
+    int m_length;
+    int m_depth;
+    int m_codeBytes;
+    int m_frameCount;
+    int m_historyHead;
+
+    QVector<quint8> m_history;       // depth x length ring for the running average
+    QVector<quint16> m_wideHistory;  // The same for 16-bit codes
+    QVector<quint32> m_sum;          // Running sum, or boxcar prefix sums modulo 2^32
+    QVector<qint32> m_ema;           // 8.8 exponential average state
+    QVector<quint16> m_max;          // Envelope extremes, 8.8
+    QVector<quint16> m_min;
+    QVector<quint16> m_result;
+    QVector<quint16> m_minimum;
+};
+
+#endif // ACQUISITION_H
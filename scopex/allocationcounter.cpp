@@ -0,0 +1,143 @@
+#include "allocationcounter.h"
+
+#ifdef SCOPEX_COUNT_ALLOCATIONS
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+// The counters live in the executable, so the allocator wrappers reach
+// them without the TLS lookup itself allocating
+#define SCOPEX_COUNTER_TLS __attribute__((tls_model("initial-exec")))
+#else
+#define SCOPEX_COUNTER_TLS
+#endif
+
+namespace {
+thread_local quint64 allocations SCOPEX_COUNTER_TLS = 0;
+thread_local int excluded SCOPEX_COUNTER_TLS = 0;
+
+void countAllocation()
+{
+    if (excluded == 0) ++allocations;
+}
+}
+
+#if defined(__GLIBC__)
+// glibc lets the executable interpose the allocator and still reach the
+// real one through its __libc_ entry points; operator new and QArrayData
+// both end up here
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+
+void *malloc(size_t size)
+{
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size)
+{
+    countAllocation();
+    return __libc_realloc(pointer, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **pointer, size_t alignment, size_t size)
+{
+    countAllocation();
+    void *result = __libc_memalign(alignment, size);
+    if (!result) return 12;   // ENOMEM
+    *pointer = result;
+    return 0;
+}
+}
+#else
+void *operator new(std::size_t size)
+{
+    countAllocation();
+    if (void *pointer = std::malloc(size ? size : 1)) return pointer;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    countAllocation();
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete[](void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void *pointer, const std::nothrow_t &) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept { std::free(pointer); }
+#endif
+
+bool AllocationCounter::isEnabled()
+{
+    return true;
+}
+
+quint64 AllocationCounter::count()
+{
+    return allocations;
+}
+
+AllocationCounter::Exclude::Exclude()
+{
+    ++excluded;
+}
+
+AllocationCounter::Exclude::~Exclude()
+{
+    --excluded;
+}
+#else
+bool AllocationCounter::isEnabled()
+{
+    return false;
+}
+
+quint64 AllocationCounter::count()
+{
+    return 0;
+}
+
+AllocationCounter::Exclude::Exclude()
+{
+}
+
+AllocationCounter::Exclude::~Exclude()
+{
+}
+#endif
@@ -0,0 +1,30 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+// Per-thread count of heap allocations, for checking that the capture path
+// runs without allocating. Stream clients, exports, searches and rendering
+// run on other threads and do not show up in the capture thread's count.
+// Compiled in only when the build defines SCOPEX_COUNT_ALLOCATIONS;
+// otherwise isEnabled() is false and the count stays zero. On glibc the C
+// allocator is wrapped, which also catches Qt containers; elsewhere only
+// operator new is counted.
+namespace AllocationCounter {
+bool isEnabled();
+// Allocations made so far by the calling thread
+quint64 count();
+
+// While one is alive, the calling thread's allocations are not counted.
+// For outputs that hand data to QML, viewers or the event queue and
+// allocate by design.
+class Exclude
+{
+public:
+    Exclude();
+    ~Exclude();
+    Q_DISABLE_COPY(Exclude)
+};
+}
+
+#endif // ALLOCATIONCOUNTER_H
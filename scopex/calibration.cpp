@@ -0,0 +1,284 @@
+#include "calibration.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtMath>
+
+Calibration::Calibration()
+{
+    for (int c = 0; c < Channels; ++c) {
+        select(c, gainIndex(1.0), 0);
+    }
+}
+
+double Calibration::gainValue(int gainIndex)
+{
+    return 0.5 * (1 << qBound(0, gainIndex, GainSteps - 1));
+}
+
+int Calibration::gainIndex(double gain)
+{
+    for (int i = 0; i < GainSteps; ++i) {
+        if (qAbs(gainValue(i) - gain) < 1e-6) return i;
+    }
+    return 1; // Default to 1x
+}
+
+double Calibration::offsetVolts(int offsetSetting)
+{
+    return offsetSetting * 10.0 / 512.0;
+}
+
+const Calibration::Entry &Calibration::entry(int channel, int gainIndex) const
+{
+    return m_entries[qBound(0, channel, Channels - 1)][qBound(0, gainIndex, GainSteps - 1)];
+}
+
+void Calibration::setEntry(int channel, int gainIndex, const Entry &entry)
+{
+    if (channel < 0 || channel >= Channels || gainIndex < 0 || gainIndex >= GainSteps) return;
+    m_entries[channel][gainIndex] = entry;
+    if (m_selectedGain[channel] == gainIndex) {
+        select(channel, gainIndex, m_selectedOffset[channel]);
+    }
+}
+
+void Calibration::clear()
+{
+    for (int c = 0; c < Channels; ++c) {
+        for (int g = 0; g < GainSteps; ++g) {
+            m_entries[c][g] = Entry();
+        }
+        select(c, m_selectedGain[c], m_selectedOffset[c]);
+    }
+}
+
+bool Calibration::load(const QString &path, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (doc.isNull()) {
+        if (error) *error = parseError.errorString();
+        return false;
+    }
+
+    const QJsonArray channels = doc.object().value("channels").toArray();
+    if (channels.size() != Channels) {
+        if (error) *error = QStringLiteral("expected %1 channels").arg(Channels);
+        return false;
+    }
+
+    for (int c = 0; c < Channels; ++c) {
+        const QJsonArray gains = channels[c].toArray();
+        for (const QJsonValue &value : gains) {
+            const QJsonObject obj = value.toObject();
+            Entry entry;
+            entry.offset = obj.value("offset").toDouble(0.0);
+            entry.gain = obj.value("gain").toDouble(1.0);
+            const QJsonArray nonlinearity = obj.value("nonlinearity").toArray();
+            if (nonlinearity.size() == CodeCount) {
+                entry.nonlinearity.resize(CodeCount);
+                for (int k = 0; k < CodeCount; ++k) {
+                    entry.nonlinearity[k] = static_cast<float>(nonlinearity[k].toDouble());
+                }
+            }
+            m_entries[c][gainIndex(obj.value("range").toDouble(1.0))] = entry;
+        }
+        select(c, m_selectedGain[c], m_selectedOffset[c]);
+    }
+    return true;
+}
+
+bool Calibration::save(const QString &path, QString *error) const
+{
+    QJsonArray channels;
+    for (int c = 0; c < Channels; ++c) {
+        QJsonArray gains;
+        for (int g = 0; g < GainSteps; ++g) {
+            const Entry &entry = m_entries[c][g];
+            QJsonObject obj;
+            obj["range"] = gainValue(g);
+            obj["offset"] = entry.offset;
+            obj["gain"] = entry.gain;
+            if (!entry.nonlinearity.isEmpty()) {
+                QJsonArray nonlinearity;
+                for (float v : entry.nonlinearity) nonlinearity.append(v);
+                obj["nonlinearity"] = nonlinearity;
+            }
+            gains.append(obj);
+        }
+        channels.append(gains);
+    }
+
+    QJsonObject root;
+    root["version"] = 1;
+    root["channels"] = channels;
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson());
+    return true;
+}
+
+double Calibration::nominalVolts(int channel, double code) const
+{
+    const Entry &e = m_entries[channel][m_selectedGain[channel]];
+    if (!e.nonlinearity.isEmpty()) {
+        const int k = qBound(0, qRound(code), CodeCount - 1);
+        code += e.nonlinearity[k];
+    }
+    return (code * 20.0 / 255.0 - 10.0 - offsetVolts(m_selectedOffset[channel]))
+           / gainValue(m_selectedGain[channel]);
+}
+
+void Calibration::select(int channel, int gainIndex, int offsetSetting)
+{
+    if (channel < 0 || channel >= Channels) return;
+    m_selectedGain[channel] = qBound(0, gainIndex, GainSteps - 1);
+    m_selectedOffset[channel] = offsetSetting;
+
+    const Entry &e = m_entries[channel][m_selectedGain[channel]];
+    for (int k = 0; k < CodeCount; ++k) {
+        m_lut[channel][k] = static_cast<float>((nominalVolts(channel, k) - e.offset) * e.gain);
+    }
+    m_lut[channel][CodeCount] = m_lut[channel][CodeCount - 1];
+
+    // The same transfer as a descriptor; the table is only needed when
+    // the nonlinearity bends it
+    ChannelScale &scale = m_scale[channel];
+    const double gain = gainValue(m_selectedGain[channel]);
+    scale.scale = static_cast<float>(20.0 / 255.0 / 256.0 / gain * e.gain);
+    scale.offset = static_cast<float>(((-10.0 - offsetVolts(offsetSetting)) / gain - e.offset) * e.gain);
+    if (e.nonlinearity.isEmpty()) {
+        scale.table.clear();
+    } else {
+        scale.table = QVector<float>(m_lut[channel], m_lut[channel] + CodeCount + 1);
+    }
+}
+
+float ChannelScale::volts(quint16 code) const
+{
+    float result;
+    convert(&code, 1, &result);
+    return result;
+}
+
+void ChannelScale::convert(const quint16 *codes, int count, float *volts) const
+{
+    if (table.isEmpty()) {
+        for (int i = 0; i < count; ++i) {
+            volts[i] = codes[i] * scale + offset;
+        }
+        return;
+    }
+
+    const float *lut = table.constData();
+    constexpr float fractionScale = 1.0f / 256.0f;
+    for (int i = 0; i < count; ++i) {
+        const int k = codes[i] >> 8;
+        const float frac = (codes[i] & 0xFF) * fractionScale;
+        volts[i] = lut[k] + (lut[k + 1] - lut[k]) * frac;
+    }
+}
+
+CalibrationMeasurement::CalibrationMeasurement() :
+    m_histogram(Calibration::CodeCount, 0),
+    m_samples(0)
+{
+}
+
+void CalibrationMeasurement::reset()
+{
+    m_histogram.fill(0);
+    m_samples = 0;
+}
+
+void CalibrationMeasurement::addFrame(const quint8 *codes, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        ++m_histogram[codes[i]];
+    }
+    m_samples += count;
+}
+
+bool CalibrationMeasurement::saturated() const
+{
+    const quint64 clipped = m_histogram[0] + m_histogram[Calibration::CodeCount - 1];
+    return m_samples > 0 && clipped * 100 > m_samples;
+}
+
+bool CalibrationMeasurement::levels(double *low, double *high) const
+{
+    int first = 0;
+    while (first < Calibration::CodeCount && m_histogram[first] == 0) ++first;
+    int last = Calibration::CodeCount - 1;
+    while (last > first && m_histogram[last] == 0) --last;
+    if (last - first < 4) return false;
+
+    // Each half of the range holds one level; average the codes around the
+    // most populated one so the few samples on the edges do not bias it
+    const int middle = (first + last) / 2;
+    auto clusterMean = [this](int from, int to, double *mean) {
+        int mode = from;
+        for (int k = from; k <= to; ++k) {
+            if (m_histogram[k] > m_histogram[mode]) mode = k;
+        }
+        double sum = 0.0;
+        quint64 hits = 0;
+        for (int k = qMax(from, mode - 4); k <= qMin(to, mode + 4); ++k) {
+            sum += static_cast<double>(k) * m_histogram[k];
+            hits += m_histogram[k];
+        }
+        if (hits == 0) return false;
+        *mean = sum / hits;
+        return true;
+    };
+    return clusterMean(first, middle, low) && clusterMean(middle + 1, last, high);
+}
+
+QVector<float> CalibrationMeasurement::nonlinearity() const
+{
+    QVector<float> correction(Calibration::CodeCount, 0.0f);
+
+    int first = 0;
+    while (first < Calibration::CodeCount && m_histogram[first] == 0) ++first;
+    int last = Calibration::CodeCount - 1;
+    while (last > first && m_histogram[last] == 0) --last;
+
+    // The end codes also collect everything beyond the ramp; skip them
+    ++first;
+    --last;
+    if (last - first < 8) return correction;
+
+    quint64 total = 0;
+    for (int k = first; k <= last; ++k) total += m_histogram[k];
+    if (total == 0) return correction;
+    const double average = static_cast<double>(total) / (last - first + 1);
+
+    // A linear ramp hits every code in proportion to its width, so the
+    // running sum of widths gives each code's real centre in ideal LSB
+    double edge = first - 0.5;
+    for (int k = first; k <= last; ++k) {
+        const double width = m_histogram[k] / average;
+        correction[k] = static_cast<float>(edge + 0.5 * width - k);
+        edge += width;
+    }
+
+    // Remove the endpoint line: offset and gain belong to the level fit
+    const double a = correction[first];
+    const double slope = (correction[last] - a) / (last - first);
+    for (int k = first; k <= last; ++k) {
+        correction[k] -= static_cast<float>(a + slope * (k - first));
+    }
+    return correction;
+}
@@ -0,0 +1,104 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <QVector>
+#include <QString>
+
+// Descriptor that turns 8.8 fixed-point codes into volts on its own, so
+// frames can be kept as codes and converted when they are read. A linear
+// range is a scale and offset; a range with a nonlinearity correction
+// carries its lookup table, which copies share.
+struct ChannelScale
+{
+    float scale = 20.0f / 255.0f / 256.0f;   // Volts per 8.8 code step
+    float offset = -10.0f;
+    QVector<float> table;                    // CodeCount + 1 volts, empty when linear
+
+    float volts(quint16 code) const;
+    void convert(const quint16 *codes, int count, float *volts) const;
+};
+
+// Per-channel, per-gain calibration of the analog front end.
+//
+// The nominal transfer maps an ADC code onto the +/-10 V converter range and
+// refers it to the input through the selected gain and offset setting:
+//
+//     nominal = ((code + nonlinearity[code]) * 20 / 255 - 10 - offsetVolts) / gain
+//     volts   = (nominal - entry.offset) * entry.gain
+//
+// where offsetVolts is the front-end offset setting (-512..512) scaled to
+// +/-10 V. Whenever the gain or offset of a channel changes, select() folds
+// all of this into a 256-entry lookup table, so converting a calibrated
+// sample costs one table read, exactly like an uncalibrated one.
+class Calibration
+{
+public:
+    static constexpr int Channels = 2;
+    static constexpr int GainSteps = 6;   // 0.5x .. 16x, command codes 0-5
+    static constexpr int CodeCount = 256;
+
+    struct Entry {
+        double offset = 0.0;           // Input-referred volts
+        double gain = 1.0;             // Correction factor
+        QVector<float> nonlinearity;   // Per-code correction in LSB, empty when linear
+    };
+
+    Calibration();
+
+    static double gainValue(int gainIndex);
+    static int gainIndex(double gain);
+    static double offsetVolts(int offsetSetting);
+
+    const Entry &entry(int channel, int gainIndex) const;
+    void setEntry(int channel, int gainIndex, const Entry &entry);
+    void clear();
+
+    bool load(const QString &path, QString *error = nullptr);
+    bool save(const QString &path, QString *error = nullptr) const;
+
+    // Rebuilds the channel's lookup table and scale for a gain and offset setting
+    void select(int channel, int gainIndex, int offsetSetting);
+    int selectedGain(int channel) const { return m_selectedGain[channel]; }
+    int selectedOffset(int channel) const { return m_selectedOffset[channel]; }
+
+    // Nominal input-referred volts for a code at the selected settings,
+    // with nonlinearity correction but without the offset/gain entry
+    double nominalVolts(int channel, double code) const;
+
+    float volts(int channel, quint8 code) const { return m_lut[channel][code]; }
+    const ChannelScale &scale(int channel) const { return m_scale[channel]; }
+
+private:
+    Entry m_entries[Channels][GainSteps];
+    int m_selectedGain[Channels];
+    int m_selectedOffset[Channels];
+    float m_lut[Channels][CodeCount + 1];  // Last entry repeated for interpolation
+    ChannelScale m_scale[Channels];
+};
+
+// Code statistics collected while the DDS drives a channel during
+// self-calibration: a square wave gives two reference levels, a triangle
+// gives the code-density histogram the nonlinearity is derived from.
+class CalibrationMeasurement
+{
+public:
+    CalibrationMeasurement();
+
+    void reset();
+    void addFrame(const quint8 *codes, int count);
+
+    quint64 samples() const { return m_samples; }
+    bool saturated() const;
+
+    // Mean code of the lower and upper cluster of a two-level signal
+    bool levels(double *low, double *high) const;
+
+    // Per-code correction in LSB from a linear-ramp code histogram
+    QVector<float> nonlinearity() const;
+
+private:
+    QVector<quint64> m_histogram;
+    quint64 m_samples;
+};
+
+#endif // CALIBRATION_H
@@ -0,0 +1,252 @@
+#include "capturecli.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+const int MaxFieldLength = 32;
+
+void appendNumber(QByteArray &out, double value)
+{
+    char field[MaxFieldLength];
+    out.append(field, std::to_chars(field, field + MaxFieldLength, value).ptr - field);
+}
+
+void appendNumber(QByteArray &out, float value)
+{
+    char field[MaxFieldLength];
+    out.append(field, std::to_chars(field, field + MaxFieldLength, value).ptr - field);
+}
+}
+
+bool CaptureCli::applyJson(const QJsonObject &json, Settings *settings, QString *error)
+{
+    static const QStringList known = {
+        "port", "frames", "duration", "rate", "length", "format", "gain1", "gain2", "offset1", "offset2",
+        "trigger-mode", "trigger-polarity", "trigger-level", "acquisition", "depth", "distortion",
+        "calibration", "captures", "binary", "measurements", "record", "journal", "stream", "shm"
+    };
+    for (auto it = json.begin(); it != json.end(); ++it) {
+        if (!known.contains(it.key())) {
+            if (error) *error = QStringLiteral("unknown setting \"%1\"").arg(it.key());
+            return false;
+        }
+    }
+
+    settings->port = json.value("port").toString(settings->port);
+    settings->frames = json.value("frames").toInt(settings->frames);
+    settings->duration = json.value("duration").toDouble(settings->duration);
+    settings->sampleRate = json.value("rate").toInt(settings->sampleRate);
+    settings->recordLength = json.value("length").toInt(settings->recordLength);
+    settings->sampleFormat = json.value("format").toInt(settings->sampleFormat);
+    settings->gain[0] = json.value("gain1").toDouble(settings->gain[0]);
+    settings->gain[1] = json.value("gain2").toDouble(settings->gain[1]);
+    settings->offset[0] = json.value("offset1").toInt(settings->offset[0]);
+    settings->offset[1] = json.value("offset2").toInt(settings->offset[1]);
+    settings->triggerMode = json.value("trigger-mode").toInt(settings->triggerMode);
+    settings->triggerPolarity = json.value("trigger-polarity").toInt(settings->triggerPolarity);
+    settings->triggerLevel = json.value("trigger-level").toInt(settings->triggerLevel);
+    settings->acquisitionMode = json.value("acquisition").toInt(settings->acquisitionMode);
+    settings->acquisitionDepth = json.value("depth").toInt(settings->acquisitionDepth);
+    settings->distortionChannel = json.value("distortion").toInt(settings->distortionChannel);
+    settings->calibration = json.value("calibration").toString(settings->calibration);
+    settings->captures = json.value("captures").toString(settings->captures);
+    settings->binaryCaptures = json.value("binary").toBool(settings->binaryCaptures);
+    settings->measurements = json.value("measurements").toString(settings->measurements);
+    settings->recording = json.value("record").toString(settings->recording);
+    settings->journal = json.value("journal").toString(settings->journal);
+    settings->streamPort = json.value("stream").toInt(settings->streamPort);
+    settings->sharedRing = json.value("shm").toString(settings->sharedRing);
+    return true;
+}
+
+CaptureCli::CaptureCli(const Settings &settings, QObject *parent) : QObject(parent),
+    m_settings(settings),
+    m_frames(0),
+    m_running(false)
+{
+    m_stopTimer.setSingleShot(true);
+    connect(&m_stopTimer, &QTimer::timeout, this, &CaptureCli::stop);
+}
+
+CaptureCli::~CaptureCli()
+{
+    stop();
+}
+
+bool CaptureCli::openOutput(QFile &file, const QString &path, QString *error)
+{
+    const bool ok = path == QLatin1String("-") ? file.open(stdout, QIODevice::WriteOnly)
+                                               : file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    if (!ok && error) *error = QStringLiteral("%1: %2").arg(path, file.errorString());
+    return ok;
+}
+
+bool CaptureCli::start(QString *error)
+{
+    if (!m_settings.captures.isEmpty()) {
+        if (m_settings.captures != QLatin1String("-")) m_captures.setFileName(m_settings.captures);
+        if (!openOutput(m_captures, m_settings.captures, error)) return false;
+        if (!m_settings.binaryCaptures) m_captures.write("frame,time,ch1,ch2\n");
+    }
+    if (!m_settings.measurements.isEmpty()) {
+        if (m_settings.measurements != QLatin1String("-")) m_measurements.setFileName(m_settings.measurements);
+        if (!openOutput(m_measurements, m_settings.measurements, error)) return false;
+    }
+
+    if (!m_settings.calibration.isEmpty() && !m_handler.loadCalibration(m_settings.calibration)) {
+        if (error) *error = m_handler.statusMessage();
+        return false;
+    }
+    if (!m_settings.port.isEmpty() && !m_handler.connectToPort(m_settings.port)) {
+        if (error) *error = m_handler.statusMessage();
+        return false;
+    }
+
+    m_handler.setSampleFormat(m_settings.sampleFormat);
+    m_handler.setRecordLength(m_settings.recordLength);
+    m_handler.setAcquisitionMode(m_settings.acquisitionMode);
+    m_handler.setAcquisitionDepth(m_settings.acquisitionDepth);
+    m_handler.setupScope(m_settings.triggerMode, m_settings.triggerPolarity, 0,
+                         m_settings.gain[0], m_settings.gain[1], m_settings.offset[0], m_settings.offset[1],
+                         m_settings.triggerLevel, m_settings.sampleRate);
+    if (m_settings.distortionChannel >= 0) {
+        m_handler.setDistortionChannel(m_settings.distortionChannel);
+        m_handler.setDistortionEnabled(true);
+    }
+
+    if (!m_settings.journal.isEmpty() && !m_handler.startJournal(m_settings.journal)) {
+        if (error) *error = m_handler.statusMessage();
+        return false;
+    }
+    if (!m_settings.recording.isEmpty() && !m_handler.startRecording(m_settings.recording)) {
+        if (error) *error = m_handler.statusMessage();
+        return false;
+    }
+    if (m_settings.streamPort > 0 && !m_handler.startStreaming(m_settings.streamPort, true)) {
+        if (error) *error = m_handler.statusMessage();
+        return false;
+    }
+    if (!m_settings.sharedRing.isEmpty() && !m_handler.startSharing(m_settings.sharedRing)) {
+        if (error) *error = m_handler.statusMessage();
+        return false;
+    }
+
+    // Frames are only converted to volts while something listens, so this
+    // connection is what turns the full conversion on
+    connect(&m_handler, &SerialHandler::frameReady, this, &CaptureCli::handleFrame);
+
+    m_running = true;
+    m_clock.start();
+    if (m_settings.duration > 0) m_stopTimer.start(qRound(m_settings.duration * 1000));
+
+    if (m_handler.connected()) {
+        m_handler.runCapture(true);
+    } else {
+        // The emulated device answers one capture at a time
+        QTimer::singleShot(0, this, [this]() { if (m_running) m_handler.runCapture(false); });
+    }
+    return true;
+}
+
+void CaptureCli::stop()
+{
+    if (!m_running) return;
+    m_running = false;
+    m_stopTimer.stop();
+
+    m_handler.stopCapture();
+    m_handler.stopRecording();
+    m_handler.stopJournal();
+    m_handler.stopStreaming();
+    m_handler.stopSharing();
+    m_handler.disconnectPort();
+    if (m_captures.isOpen()) m_captures.close();
+    if (m_measurements.isOpen()) m_measurements.close();
+    emit finished(0);
+}
+
+void CaptureCli::handleFrame(const VoltFrame &frame)
+{
+    if (!m_running) return;
+
+    if (m_captures.isOpen()) writeCaptures(frame);
+    if (m_measurements.isOpen()) writeMeasurements(frame);
+    ++m_frames;
+
+    if (m_settings.frames > 0 && m_frames >= quint64(m_settings.frames)) {
+        // Stop once the handler has finished with this frame
+        QTimer::singleShot(0, this, &CaptureCli::stop);
+    } else if (!m_handler.connected()) {
+        QTimer::singleShot(0, this, [this]() { if (m_running) m_handler.runCapture(false); });
+    }
+}
+
+void CaptureCli::writeCaptures(const VoltFrame &frame)
+{
+    const int channels = frame.channels();
+    const int length = frame.length();
+
+    if (m_settings.binaryCaptures) {
+        m_buffer.resize(qsizetype(length) * channels * sizeof(float));
+        float *out = reinterpret_cast<float *>(m_buffer.data());
+        for (int i = 0; i < length; ++i) {
+            for (int c = 0; c < channels; ++c) *out++ = frame.channel(c)[i];
+        }
+        m_captures.write(m_buffer);
+        return;
+    }
+
+    const double period = frame.info.sampleRate > 0 ? 1.0 / frame.info.sampleRate : 0.0;
+    const QByteArray index = QByteArray::number(m_frames);
+    m_buffer.clear();
+    for (int i = 0; i < length; ++i) {
+        m_buffer.append(index);
+        m_buffer.append(',');
+        appendNumber(m_buffer, i * period);
+        for (int c = 0; c < channels; ++c) {
+            m_buffer.append(',');
+            appendNumber(m_buffer, frame.channel(c)[i]);
+        }
+        m_buffer.append('\n');
+    }
+    m_captures.write(m_buffer);
+}
+
+void CaptureCli::writeMeasurements(const VoltFrame &frame)
+{
+    QJsonArray channels;
+    for (int c = 0; c < frame.channels(); ++c) {
+        const float *volts = frame.channel(c);
+        float low = volts[0];
+        float high = volts[0];
+        double sum = 0.0;
+        double squares = 0.0;
+        for (int i = 0; i < frame.length(); ++i) {
+            low = qMin(low, volts[i]);
+            high = qMax(high, volts[i]);
+            sum += volts[i];
+            squares += double(volts[i]) * volts[i];
+        }
+        const double n = qMax(1, frame.length());
+        QJsonObject channel;
+        channel["min"] = low;
+        channel["max"] = high;
+        channel["mean"] = sum / n;
+        channel["rms"] = std::sqrt(squares / n);
+        channels.append(channel);
+    }
+
+    QJsonObject line;
+    line["frame"] = double(m_frames);
+    line["time"] = m_clock.nsecsElapsed() * 1e-9;
+    line["sampleRate"] = frame.info.sampleRate;
+    line["channels"] = channels;
+    if (m_settings.distortionChannel >= 0) {
+        line["distortion"] = QJsonObject::fromVariantMap(m_handler.distortion());
+    }
+    m_measurements.write(QJsonDocument(line).toJson(QJsonDocument::Compact));
+    m_measurements.write("\n");
+}
@@ -0,0 +1,78 @@
+#ifndef CAPTURECLI_H
+#define CAPTURECLI_H
+
+#include <QObject>
+#include <QFile>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include "serialhandler.h"
+
+// Runs a SerialHandler without a GUI, for test fixtures: configures it,
+// captures a number of frames or for a while, and streams every frame and
+// its measurements as it arrives. Captures are CSV rows
+//   frame,time,ch1,ch2
+// with time in seconds from the frame start, or raw interleaved float32
+// volts; measurements are one JSON object per line.
+class CaptureCli : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Settings {
+        QString port;                  // Empty runs the emulated device
+        int frames = 0;                // Stop after this many; 0 runs until stopped
+        double duration = 0.0;         // Seconds; 0 runs until stopped
+        int sampleRate = 10;           // Timebase index, as in the GUI
+        int recordLength = 1000;
+        int sampleFormat = Bits8;
+        double gain[2] = { 1.0, 1.0 };
+        int offset[2] = { 0, 0 };
+        int triggerMode = 0;
+        int triggerPolarity = 0;
+        int triggerLevel = 128;
+        int acquisitionMode = FrameAccumulator::Normal;
+        int acquisitionDepth = 16;
+        int distortionChannel = -1;    // Adds distortion figures when set
+        QString calibration;
+        QString captures;              // File, or "-" for stdout
+        bool binaryCaptures = false;
+        QString measurements;          // File, or "-" for stdout
+        QString recording;
+        QString journal;
+        int streamPort = 0;            // Serves remote viewers on the LAN when set
+        QString sharedRing;            // Shared-memory ring name for local readers
+    };
+
+    // Keys are the long option names; anything absent keeps its value
+    static bool applyJson(const QJsonObject &json, Settings *settings, QString *error);
+
+    explicit CaptureCli(const Settings &settings, QObject *parent = nullptr);
+    ~CaptureCli();
+
+    bool start(QString *error);
+
+public slots:
+    void stop();
+
+signals:
+    void finished(int exitCode);
+
+private:
+    void handleFrame(const VoltFrame &frame);
+    void writeCaptures(const VoltFrame &frame);
+    void writeMeasurements(const VoltFrame &frame);
+    static bool openOutput(QFile &file, const QString &path, QString *error);
+
+    Settings m_settings;
+    SerialHandler m_handler;
+    QFile m_captures;
+    QFile m_measurements;
+    QByteArray m_buffer;
+    QTimer m_stopTimer;
+    QElapsedTimer m_clock;
+    quint64 m_frames;
+    bool m_running;
+};
+
+#endif // CAPTURECLI_H
@@ -0,0 +1,219 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QFile>
+#include <QSerialPortInfo>
+#include <QTextStream>
+#include "capturecli.h"
+
+#if defined(Q_OS_UNIX)
+#include <QSocketNotifier>
+#include <csignal>
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+// Headless capture: the acquisition and measurement code of the GUI on a
+// QCoreApplication, with no QML, Charts or GUI plugins to load.
+
+namespace {
+#if defined(Q_OS_UNIX)
+int signalPipe[2] = { -1, -1 };
+
+void handleSignal(int)
+{
+    const char byte = 1;
+    [[maybe_unused]] const ssize_t written = ::write(signalPipe[1], &byte, 1);
+}
+
+// Ctrl+C and SIGTERM stop the capture cleanly so files are complete. The
+// handler only writes to a pipe; the stop itself runs in the event loop.
+void installStopHandler(CaptureCli *cli)
+{
+    if (::pipe(signalPipe) != 0) return;
+    QSocketNotifier *notifier = new QSocketNotifier(signalPipe[0], QSocketNotifier::Read, cli);
+    QObject::connect(notifier, &QSocketNotifier::activated, cli, [cli]() {
+        char byte;
+        [[maybe_unused]] const ssize_t count = ::read(signalPipe[0], &byte, 1);
+        cli->stop();
+    });
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+}
+#elif defined(Q_OS_WIN)
+CaptureCli *consoleCli = nullptr;
+
+BOOL WINAPI handleConsoleEvent(DWORD)
+{
+    // Called on a thread of its own, so the stop is queued to the event loop
+    QMetaObject::invokeMethod(consoleCli, [] { consoleCli->stop(); }, Qt::QueuedConnection);
+    return TRUE;
+}
+
+// Ctrl+C, Ctrl+Break and closing the console stop the capture cleanly so
+// files are complete
+void installStopHandler(CaptureCli *cli)
+{
+    consoleCli = cli;
+    SetConsoleCtrlHandler(handleConsoleEvent, TRUE);
+}
+#else
+void installStopHandler(CaptureCli *)
+{
+}
+#endif
+
+bool readInt(const QCommandLineParser &parser, const QString &name, int *value, QString *error)
+{
+    if (!parser.isSet(name)) return true;
+    bool ok = false;
+    const int parsed = parser.value(name).toInt(&ok);
+    if (!ok) {
+        *error = QStringLiteral("--%1 expects an integer").arg(name);
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+bool readDouble(const QCommandLineParser &parser, const QString &name, double *value, QString *error)
+{
+    if (!parser.isSet(name)) return true;
+    bool ok = false;
+    const double parsed = parser.value(name).toDouble(&ok);
+    if (!ok) {
+        *error = QStringLiteral("--%1 expects a number").arg(name);
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+void readString(const QCommandLineParser &parser, const QString &name, QString *value)
+{
+    if (parser.isSet(name)) *value = parser.value(name);
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("scopex-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Captures from a ScopeX device, or the emulated one, without the GUI.");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "config", "JSON file of settings keyed by option name; options given here override it.", "file" },
+        { "list-ports", "Lists serial ports and exits." },
+        { "port", "Serial port; the emulated device is used when omitted.", "name" },
+        { "frames", "Stops after this many frames.", "count" },
+        { "duration", "Stops after this many seconds.", "seconds" },
+        { "rate", "Timebase index, as in the GUI.", "index" },
+        { "length", "Record length in samples.", "samples" },
+        { "format", "Sample format: 0 8-bit, 1 packed 12-bit, 2 10-bit, 3 16-bit.", "format" },
+        { "gain1", "Channel 1 gain.", "gain" },
+        { "gain2", "Channel 2 gain.", "gain" },
+        { "offset1", "Channel 1 offset code.", "code" },
+        { "offset2", "Channel 2 offset code.", "code" },
+        { "trigger-mode", "Trigger source: 0 auto, 1 CH1, 2 CH2, 3 external.", "mode" },
+        { "trigger-polarity", "Trigger polarity: 0 rising, 1 falling.", "polarity" },
+        { "trigger-level", "Trigger level code.", "code" },
+        { "acquisition", "Acquisition mode: 0 normal, 1 average, 2 exponential average, 3 envelope, 4 high resolution.", "mode" },
+        { "depth", "Frames combined by the acquisition mode.", "frames" },
+        { "distortion", "Adds distortion figures for this channel to the measurements.", "channel" },
+        { "calibration", "Calibration file to load.", "file" },
+        { "captures", "Writes every frame as CSV to this file, or - for stdout.", "file" },
+        { "binary", "Writes captures as interleaved float32 volts instead of CSV." },
+        { "measurements", "Writes per-frame measurements as JSON lines to this file, or - for stdout.", "file" },
+        { "record", "Records raw frames to this file.", "file" },
+        { "journal", "Journals the session to this file for replay.", "file" },
+        { "stream", "Serves frames, spectra and measurements to viewers on this TCP port.", "port" },
+        { "shm", "Publishes frames to the shared-memory ring /dev/shm/<name>.", "name" },
+    });
+    parser.process(app);
+
+    QTextStream err(stderr);
+
+    if (parser.isSet("list-ports")) {
+        QTextStream out(stdout);
+        for (const QSerialPortInfo &info : QSerialPortInfo::availablePorts()) {
+            out << info.portName() << '\t' << info.description() << '\n';
+        }
+        return 0;
+    }
+
+    CaptureCli::Settings settings;
+    QString error;
+
+    if (parser.isSet("config")) {
+        QFile file(parser.value("config"));
+        if (!file.open(QIODevice::ReadOnly)) {
+            err << file.fileName() << ": " << file.errorString() << '\n';
+            return 1;
+        }
+        QJsonParseError parseError;
+        const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+        if (!doc.isObject()) {
+            err << file.fileName() << ": " << parseError.errorString() << '\n';
+            return 1;
+        }
+        if (!CaptureCli::applyJson(doc.object(), &settings, &error)) {
+            err << file.fileName() << ": " << error << '\n';
+            return 1;
+        }
+    }
+
+    readString(parser, "port", &settings.port);
+    readString(parser, "calibration", &settings.calibration);
+    readString(parser, "captures", &settings.captures);
+    readString(parser, "measurements", &settings.measurements);
+    readString(parser, "record", &settings.recording);
+    readString(parser, "journal", &settings.journal);
+    readString(parser, "shm", &settings.sharedRing);
+    if (parser.isSet("binary")) settings.binaryCaptures = true;
+
+    const bool parsed = readInt(parser, "frames", &settings.frames, &error)
+        && readDouble(parser, "duration", &settings.duration, &error)
+        && readInt(parser, "rate", &settings.sampleRate, &error)
+        && readInt(parser, "length", &settings.recordLength, &error)
+        && readInt(parser, "format", &settings.sampleFormat, &error)
+        && readDouble(parser, "gain1", &settings.gain[0], &error)
+        && readDouble(parser, "gain2", &settings.gain[1], &error)
+        && readInt(parser, "offset1", &settings.offset[0], &error)
+        && readInt(parser, "offset2", &settings.offset[1], &error)
+        && readInt(parser, "trigger-mode", &settings.triggerMode, &error)
+        && readInt(parser, "trigger-polarity", &settings.triggerPolarity, &error)
+        && readInt(parser, "trigger-level", &settings.triggerLevel, &error)
+        && readInt(parser, "acquisition", &settings.acquisitionMode, &error)
+        && readInt(parser, "depth", &settings.acquisitionDepth, &error)
+        && readInt(parser, "distortion", &settings.distortionChannel, &error)
+        && readInt(parser, "stream", &settings.streamPort, &error);
+    if (!parsed) {
+        err << error << '\n';
+        return 1;
+    }
+
+    if (settings.captures.isEmpty() && settings.measurements.isEmpty() && settings.recording.isEmpty()
+        && settings.streamPort == 0 && settings.sharedRing.isEmpty()) {
+        // Nothing asked for, so show what is being captured
+        settings.measurements = QStringLiteral("-");
+    }
+    if (settings.captures == QLatin1String("-") && settings.measurements == QLatin1String("-")) {
+        err << "--captures and --measurements cannot both go to stdout\n";
+        return 1;
+    }
+
+    CaptureCli cli(settings);
+    QObject::connect(&cli, &CaptureCli::finished, &app, &QCoreApplication::exit);
+
+    installStopHandler(&cli);
+
+    if (!cli.start(&error)) {
+        err << error << '\n';
+        return 1;
+    }
+    return app.exec();
+}
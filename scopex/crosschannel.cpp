@@ -0,0 +1,198 @@
+#include "crosschannel.h"
+#include <QtMath>
+
+CrossChannelAnalyzer::CrossChannelAnalyzer() :
+    m_length(0),
+    m_averages(16),
+    m_frames(0)
+{
+}
+
+void CrossChannelAnalyzer::configure(int length)
+{
+    if (length == m_length) return;
+    m_length = length;
+
+    const int correlationSize = qMax(4, FFT::nextPowerOfTwo(2 * length));
+    m_correlationFft.setSize(correlationSize);
+    m_block.fill(0.0f, correlationSize);
+    m_spectrum1.resize(correlationSize / 2 + 1);
+    m_spectrum2.resize(correlationSize / 2 + 1);
+    m_lags.resize(correlationSize);
+    m_correlation.fill(0.0f, qMax(0, 2 * length - 1));
+
+    // The spectral transform shares the block and spectrum buffers, which
+    // are at least twice as long as it needs
+    const int spectralSize = qMax(4, FFT::nextPowerOfTwo(length));
+    const int bins = spectralSize / 2 + 1;
+    m_spectralFft.setSize(spectralSize);
+    Window::fill(Window::Hann, length, m_window);
+    m_power1.resize(bins);
+    m_power2.resize(bins);
+    m_cross.resize(bins);
+    m_coherence.resize(bins);
+    m_transferMagnitude.resize(bins);
+    m_transferPhase.resize(bins);
+    reset();
+}
+
+void CrossChannelAnalyzer::setAverages(int count)
+{
+    count = qBound(1, count, MaxAverages);
+    if (count == m_averages) return;
+    m_averages = count;
+    reset();
+}
+
+void CrossChannelAnalyzer::reset()
+{
+    m_frames = 0;
+    m_power1.fill(0.0);
+    m_power2.fill(0.0);
+    m_cross.fill(std::complex<double>());
+    m_coherence.fill(0.0f);
+    m_transferMagnitude.fill(0.0f);
+    m_transferPhase.fill(0.0f);
+    m_result = Result();
+}
+
+void CrossChannelAnalyzer::correlate(const float *ch1, const float *ch2, double mean1, double mean2)
+{
+    const int length = m_length;
+    double energy1 = 0.0;
+    double energy2 = 0.0;
+
+    for (int n = 0; n < length; ++n) {
+        m_block[n] = static_cast<float>(ch1[n] - mean1);
+        energy1 += double(m_block[n]) * m_block[n];
+    }
+    m_correlationFft.forward(m_block.constData(), m_spectrum1.data());
+    for (int n = 0; n < length; ++n) {
+        m_block[n] = static_cast<float>(ch2[n] - mean2);
+        energy2 += double(m_block[n]) * m_block[n];
+    }
+    m_correlationFft.forward(m_block.constData(), m_spectrum2.data());
+
+    // r[l] = sum ch1[n] * ch2[n + l], so a positive peak lag means CH2 lags
+    for (int k = 0; k < m_spectrum1.size(); ++k) {
+        m_spectrum1[k] = std::conj(m_spectrum1[k]) * m_spectrum2[k];
+    }
+    m_correlationFft.inverse(m_spectrum1.constData(), m_lags.data());
+
+    const int size = m_lags.size();
+    const double norm = energy1 > 0.0 && energy2 > 0.0 ? 1.0 / qSqrt(energy1 * energy2) : 0.0;
+    for (int lag = -(length - 1); lag < length; ++lag) {
+        m_correlation[lag + length - 1] = static_cast<float>(m_lags[(lag + size) % size] * norm);
+    }
+
+    // The biased estimate tapers towards the ends, which keeps a periodic
+    // signal's peak at the lag nearest zero
+    int peak = 0;
+    for (int i = 1; i < m_correlation.size(); ++i) {
+        if (qAbs(m_correlation[i]) > qAbs(m_correlation[peak])) peak = i;
+    }
+
+    // The taper also drags the peak towards zero lag, so it is refined on
+    // the unbiased estimate (divided by the overlap) within the same lobe
+    auto unbiased = [&](int i) {
+        return qAbs(m_correlation[i]) * double(length) / (length - qAbs(i - (length - 1)));
+    };
+    const int last = m_correlation.size() - 1;
+    while (peak > 0 && unbiased(peak - 1) > unbiased(peak)) --peak;
+    while (peak < last && unbiased(peak + 1) > unbiased(peak)) ++peak;
+
+    double offset = 0.0;
+    if (peak > 0 && peak < last) {
+        const double a = unbiased(peak - 1);
+        const double b = unbiased(peak);
+        const double c = unbiased(peak + 1);
+        const double denominator = a - 2.0 * b + c;
+        if (denominator != 0.0) offset = qBound(-0.5, 0.5 * (a - c) / denominator, 0.5);
+    }
+
+    m_result.delaySamples = peak - (length - 1) + offset;
+    m_result.correlation = m_correlation[peak];
+    m_result.valid = norm > 0.0;
+}
+
+void CrossChannelAnalyzer::accumulateSpectra(const float *ch1, const float *ch2, double mean1, double mean2,
+                                             double sampleRate)
+{
+    // Block entries past m_length are still zero from correlate()
+    const int length = m_length;
+    for (int n = 0; n < length; ++n) m_block[n] = static_cast<float>((ch1[n] - mean1) * m_window[n]);
+    m_spectralFft.forward(m_block.constData(), m_spectrum1.data());
+    for (int n = 0; n < length; ++n) m_block[n] = static_cast<float>((ch2[n] - mean2) * m_window[n]);
+    m_spectralFft.forward(m_block.constData(), m_spectrum2.data());
+
+    // Running mean until the depth is reached, exponential after that
+    m_frames = qMin(m_frames + 1, m_averages);
+    const double alpha = 1.0 / m_frames;
+    const int bins = m_power1.size();
+    for (int k = 0; k < bins; ++k) {
+        const std::complex<double> x(m_spectrum1[k]);
+        const std::complex<double> y(m_spectrum2[k]);
+        m_power1[k] += alpha * (std::norm(x) - m_power1[k]);
+        m_power2[k] += alpha * (std::norm(y) - m_power2[k]);
+        m_cross[k] += alpha * (std::conj(x) * y - m_cross[k]);
+    }
+
+    int dominant = -1;
+    const int firstBin = qCeil(2.0 * m_spectralFft.size() / length);  // Past the DC lobe
+    for (int k = 0; k < bins; ++k) {
+        const double cross = std::norm(m_cross[k]);
+        const double auto1 = m_power1[k];
+        const double auto2 = m_power2[k];
+        m_coherence[k] = auto1 > 0.0 && auto2 > 0.0 ? static_cast<float>(cross / (auto1 * auto2)) : 0.0f;
+        m_transferMagnitude[k] = auto1 > 0.0 && cross > 0.0
+                ? static_cast<float>(10.0 * std::log10(cross / (auto1 * auto1))) : -300.0f;
+        m_transferPhase[k] = static_cast<float>(qRadiansToDegrees(std::arg(m_cross[k])));
+        if (k >= firstBin && (dominant < 0 || cross > std::norm(m_cross[dominant]))) dominant = k;
+    }
+
+    if (dominant < 0) return;
+
+    // Frequency refined on the magnitude of the cross spectrum; the phase of
+    // the cross spectrum needs no correction since both channels leak alike
+    double bin = dominant;
+    if (dominant > 0 && dominant < bins - 1) {
+        const double a = std::abs(m_cross[dominant - 1]);
+        const double b = std::abs(m_cross[dominant]);
+        const double c = std::abs(m_cross[dominant + 1]);
+        if (a > 0.0 && c > 0.0) {
+            const double la = std::log(a), lb = std::log(b), lc = std::log(c);
+            const double denominator = la - 2.0 * lb + lc;
+            if (denominator < 0.0) bin += qBound(-0.5, 0.5 * (la - lc) / denominator, 0.5);
+        }
+    }
+
+    m_result.frequency = bin * sampleRate / m_spectralFft.size();
+    m_result.phase = m_transferPhase[dominant];
+    m_result.gain = m_transferMagnitude[dominant];
+    m_result.coherence = m_coherence[dominant];
+}
+
+const CrossChannelAnalyzer::Result &CrossChannelAnalyzer::addFrame(const float *ch1, const float *ch2,
+                                                                    int count, double sampleRate)
+{
+    if (count < 4 || sampleRate <= 0.0) {
+        m_result.valid = false;
+        return m_result;
+    }
+    configure(count);
+
+    double mean1 = 0.0;
+    double mean2 = 0.0;
+    for (int n = 0; n < count; ++n) {
+        mean1 += ch1[n];
+        mean2 += ch2[n];
+    }
+    mean1 /= count;
+    mean2 /= count;
+
+    correlate(ch1, ch2, mean1, mean2);
+    accumulateSpectra(ch1, ch2, mean1, mean2, sampleRate);
+
+    m_result.delay = m_result.delaySamples / sampleRate;
+    return m_result;
+}
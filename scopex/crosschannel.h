@@ -0,0 +1,82 @@
+#ifndef CROSSCHANNEL_H
+#define CROSSCHANNEL_H
+
+#include <QVector>
+#include <complex>
+#include "fft.h"
+
+// Relationship between two channels captured together. The cross-correlation
+// comes from zero-padded (linear, not circular) spectra and its peak is
+// refined to a fraction of a sample. Hann-windowed auto and cross spectra are
+// averaged over frames for the coherence, the H1 transfer function CH2 / CH1
+// and the phase at the dominant frequency. Plans and buffers are sized by
+// configure() and reused, so a frame of unchanged length does not allocate.
+class CrossChannelAnalyzer
+{
+public:
+    struct Result {
+        bool valid = false;
+        double delay = 0.0;         // CH2 behind CH1, seconds
+        double delaySamples = 0.0;
+        double correlation = 0.0;   // Normalized peak, -1 to 1
+        double frequency = 0.0;     // Dominant frequency, Hz
+        double phase = 0.0;         // CH2 relative to CH1 at that frequency, degrees
+        double gain = 0.0;          // |H| at that frequency, dB
+        double coherence = 0.0;     // At that frequency, 0 to 1
+    };
+
+    static constexpr int MaxAverages = 256;
+
+    CrossChannelAnalyzer();
+
+    void configure(int length);
+    void setAverages(int count);
+    void reset();
+
+    int length() const { return m_length; }
+    int averages() const { return m_averages; }
+    int frameCount() const { return m_frames; }
+
+    const Result &addFrame(const float *ch1, const float *ch2, int count, double sampleRate);
+    const Result &result() const { return m_result; }
+
+    // Lag l (from -(length - 1) to length - 1) is at index l + length - 1
+    const QVector<float> &correlation() const { return m_correlation; }
+
+    // Per bin of the spectral transform, bin k at k * sampleRate / spectrumSize()
+    int spectrumSize() const { return m_spectralFft.size(); }
+    const QVector<float> &coherence() const { return m_coherence; }
+    const QVector<float> &transferMagnitude() const { return m_transferMagnitude; }  // dB
+    const QVector<float> &transferPhase() const { return m_transferPhase; }          // Degrees
+
+private:
+    void correlate(const float *ch1, const float *ch2, double mean1, double mean2);
+    void accumulateSpectra(const float *ch1, const float *ch2, double mean1, double mean2,
+                           double sampleRate);
+
+    int m_length;
+    int m_averages;
+    int m_frames;
+
+    // Correlation: 2 * length padding keeps the wrap-around out of the lags
+    RealFFT m_correlationFft;
+    QVector<float> m_block;
+    QVector<std::complex<float>> m_spectrum1;
+    QVector<std::complex<float>> m_spectrum2;
+    QVector<float> m_lags;
+    QVector<float> m_correlation;
+
+    // Averaged spectra
+    RealFFT m_spectralFft;
+    QVector<float> m_window;
+    QVector<double> m_power1;
+    QVector<double> m_power2;
+    QVector<std::complex<double>> m_cross;
+    QVector<float> m_coherence;
+    QVector<float> m_transferMagnitude;
+    QVector<float> m_transferPhase;
+
+    Result m_result;
+};
+
+#endif // CROSSCHANNEL_H
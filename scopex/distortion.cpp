@@ -0,0 +1,195 @@
+#include "distortion.h"
+#include <QtMath>
+
+namespace {
+// Blackman-Harris main lobe half width, in bins of an unpadded transform
+const int MainLobeBins = 4;
+
+double toDb(double numerator, double denominator)
+{
+    return 10.0 * std::log10(qMax(numerator, 1e-30) / qMax(denominator, 1e-30));
+}
+}
+
+DistortionAnalyzer::DistortionAnalyzer() :
+    m_harmonics(9),
+    m_averages(1),
+    m_windowLength(0),
+    m_windowPowerSum(0.0),
+    m_historyHead(0),
+    m_historyCount(0)
+{
+}
+
+void DistortionAnalyzer::setHarmonics(int count)
+{
+    m_harmonics = qBound(1, count, 50);
+    reset();
+}
+
+void DistortionAnalyzer::setAverages(int count)
+{
+    count = qBound(1, count, MaxAverages);
+    if (count == m_averages) return;
+    m_averages = count;
+    reset();
+}
+
+void DistortionAnalyzer::reset()
+{
+    m_historyHead = 0;
+    m_historyCount = 0;
+    m_result = Result();
+}
+
+void DistortionAnalyzer::prepare(int count)
+{
+    if (count == m_windowLength) return;
+
+    // The window spans the real samples; the rest of the block is zero
+    // padding up to the next power of two
+    m_windowLength = count;
+    Window::fill(Window::BlackmanHarris, count, m_window);
+    m_windowPowerSum = 0.0;
+    for (float w : std::as_const(m_window)) m_windowPowerSum += double(w) * w;
+
+    const int size = qMax(4, FFT::nextPowerOfTwo(count));
+    m_fft.setSize(size);
+    m_block.fill(0.0f, size);
+    m_spectrum.resize(size / 2 + 1);
+    m_power.resize(size / 2 + 1);
+    m_used.resize(size / 2 + 1);
+    reset();
+}
+
+int DistortionAnalyzer::peakNear(double bin, int radius) const
+{
+    const int last = m_power.size() - 1;
+    const int centre = qRound(bin);
+    int best = -1;
+    for (int k = qMax(0, centre - radius); k <= qMin(last, centre + radius); ++k) {
+        if (m_used[k]) continue;
+        if (best < 0 || m_power[k] > m_power[best]) best = k;
+    }
+    return best;
+}
+
+double DistortionAnalyzer::lobePower(int bin, QVector<bool> &used) const
+{
+    // Padding widens the lobe in bins by size / count
+    const int width = qCeil(double(MainLobeBins) * m_fft.size() / m_windowLength);
+    const int last = m_power.size() - 1;
+    double power = 0.0;
+    for (int k = qMax(0, bin - width); k <= qMin(last, bin + width); ++k) {
+        if (used[k]) continue;
+        power += m_power[k];
+        used[k] = true;
+    }
+    return power;
+}
+
+const DistortionAnalyzer::Result &DistortionAnalyzer::analyze(const float *samples, int count,
+                                                              double sampleRate)
+{
+    if (count < 16 || sampleRate <= 0.0) {
+        m_result.valid = false;
+        return m_result;
+    }
+    prepare(count);
+
+    // Remove the mean first so the DC lobe does not mask a low fundamental
+    double mean = 0.0;
+    for (int n = 0; n < count; ++n) mean += samples[n];
+    mean /= count;
+    for (int n = 0; n < count; ++n) {
+        m_block[n] = static_cast<float>((samples[n] - mean) * m_window[n]);
+    }
+
+    m_fft.forward(m_block.constData(), m_spectrum.data());
+    const int bins = m_power.size();
+    for (int k = 0; k < bins; ++k) m_power[k] = std::norm(m_spectrum[k]);
+
+    const int size = m_fft.size();
+    const int width = qCeil(double(MainLobeBins) * size / count);
+    m_used.fill(false);
+    for (int k = 0; k <= qMin(width, bins - 1); ++k) m_used[k] = true;
+
+    // Fundamental: strongest bin above the DC lobe, refined by fitting a
+    // Gaussian through the peak and its neighbours (exact for a Gaussian
+    // lobe, and close for Blackman-Harris)
+    const int peak = peakNear(bins / 2.0, bins);
+    if (peak <= 0 || peak >= bins - 1 || m_power[peak] <= 0.0) {
+        m_result.valid = false;
+        return m_result;
+    }
+    double fundamentalBin = peak;
+    const double left = m_power[peak - 1];
+    const double right = m_power[peak + 1];
+    if (left > 0.0 && right > 0.0) {
+        const double a = std::log(left), b = std::log(m_power[peak]), c = std::log(right);
+        const double denominator = a - 2.0 * b + c;
+        if (denominator < 0.0) fundamentalBin += qBound(-0.5, 0.5 * (a - c) / denominator, 0.5);
+    }
+
+    Powers powers;
+    powers.fundamental = lobePower(peak, m_used);
+
+    // Harmonics fold back about Nyquist; each is searched for near where the
+    // refined fundamental predicts it and summed over its own lobe
+    int found = 0;
+    for (int h = 2; h <= m_harmonics + 1; ++h) {
+        double bin = std::fmod(h * fundamentalBin, double(size));
+        if (bin > size / 2) bin = size - bin;
+        const int k = peakNear(bin, qMax(1, width / 2));
+        if (k < 0) continue;
+        const double power = lobePower(k, m_used);
+        powers.harmonics += power;
+        powers.spur = qMax(powers.spur, power);
+        ++found;
+    }
+
+    // Noise is what remains, scaled up for the bins hidden under the lobes
+    double residual = 0.0;
+    int free = 0;
+    int spurBin = -1;
+    for (int k = 0; k < bins; ++k) {
+        if (m_used[k]) continue;
+        residual += m_power[k];
+        ++free;
+        if (spurBin < 0 || m_power[k] > m_power[spurBin]) spurBin = k;
+    }
+    const int measured = bins - qMin(width + 1, bins);
+    powers.noise = free > 0 ? residual * measured / free : 0.0;
+    if (spurBin >= 0) powers.spur = qMax(powers.spur, lobePower(spurBin, m_used));
+
+    // Average powers, not decibels, over the last m_averages frames
+    m_history[m_historyHead] = powers;
+    m_binHistory[m_historyHead] = fundamentalBin;
+    m_historyHead = (m_historyHead + 1) % m_averages;
+    m_historyCount = qMin(m_historyCount + 1, m_averages);
+
+    Powers total;
+    double binSum = 0.0;
+    for (int i = 0; i < m_historyCount; ++i) {
+        total.fundamental += m_history[i].fundamental;
+        total.harmonics += m_history[i].harmonics;
+        total.noise += m_history[i].noise;
+        total.spur += m_history[i].spur;
+        binSum += m_binHistory[i];
+    }
+
+    const double p1 = total.fundamental;
+    m_result.valid = p1 > 0.0;
+    m_result.frequency = binSum / m_historyCount * sampleRate / size;
+    // One-sided lobe power of a tone of peak A is size * A^2 / 4 * sum(w^2)
+    m_result.amplitude = qSqrt(4.0 * p1 / m_historyCount / (size * m_windowPowerSum));
+    m_result.thd = toDb(total.harmonics, p1);
+    m_result.thdPlusNoise = toDb(total.harmonics + total.noise, p1);
+    m_result.snr = toDb(p1, total.noise);
+    m_result.sinad = toDb(p1, total.harmonics + total.noise);
+    m_result.sfdr = toDb(p1, total.spur);
+    // Relative to the tone actually applied, not to the ADC full scale
+    m_result.enob = (m_result.sinad - 1.76) / 6.02;
+    m_result.harmonics = found;
+    return m_result;
+}
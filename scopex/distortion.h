@@ -0,0 +1,76 @@
+#ifndef DISTORTION_H
+#define DISTORTION_H
+
+#include <QVector>
+#include <complex>
+#include "fft.h"
+
+// Single-tone distortion and noise analysis. Each frame is Blackman-Harris
+// windowed and transformed with a reusable real FFT plan. The fundamental is
+// located with leakage-aware (Gaussian) bin interpolation, and every tone's
+// power is summed over its whole main lobe so leakage is not counted as
+// noise. Powers are averaged over the last `averages` frames before the
+// figures are derived.
+class DistortionAnalyzer
+{
+public:
+    struct Result {
+        bool valid = false;
+        double frequency = 0.0;     // Fundamental, Hz
+        double amplitude = 0.0;     // Fundamental peak, volts
+        double thd = 0.0;           // dB relative to the fundamental
+        double thdPlusNoise = 0.0;  // dB
+        double snr = 0.0;           // dB
+        double sinad = 0.0;         // dB
+        double sfdr = 0.0;          // dBc
+        double enob = 0.0;          // bits
+        int harmonics = 0;          // Harmonics found below Nyquist (after folding)
+    };
+
+    static constexpr int MaxAverages = 64;
+
+    DistortionAnalyzer();
+
+    void setHarmonics(int count);
+    void setAverages(int count);
+    void reset();
+
+    int averages() const { return m_averages; }
+    int harmonics() const { return m_harmonics; }
+
+    const Result &analyze(const float *samples, int count, double sampleRate);
+    const Result &result() const { return m_result; }
+
+private:
+    struct Powers {
+        double fundamental = 0.0;
+        double harmonics = 0.0;
+        double noise = 0.0;
+        double spur = 0.0;
+    };
+
+    void prepare(int count);
+    int peakNear(double bin, int radius) const;
+    double lobePower(int bin, QVector<bool> &used) const;  // Sums and marks a main lobe
+
+    int m_harmonics;
+    int m_averages;
+
+    RealFFT m_fft;
+    int m_windowLength;
+    double m_windowPowerSum;   // Sum of squared window coefficients
+    QVector<float> m_window;
+    QVector<float> m_block;
+    QVector<std::complex<float>> m_spectrum;
+    QVector<double> m_power;
+    QVector<bool> m_used;
+
+    Powers m_history[MaxAverages];
+    int m_historyHead;
+    int m_historyCount;
+    double m_binHistory[MaxAverages];  // Refined fundamental bin per frame
+
+    Result m_result;
+};
+
+#endif // DISTORTION_H
@@ -0,0 +1,153 @@
+#include "equivalenttime.h"
+#include <QtMath>
+
+namespace {
+// Bins saturate here and are then halved, so old frames slowly fade out
+// and the counts fit in 16 bits
+constexpr quint16 MaxHits = 1024;
+}
+
+EquivalentTimeSampler::EquivalentTimeSampler() :
+    m_channels(0),
+    m_length(0),
+    m_factor(MinFactor),
+    m_frameCount(0),
+    m_filledBins(0),
+    m_anchor(-1.0)
+{
+}
+
+void EquivalentTimeSampler::configure(int channels, int length, int factor)
+{
+    m_channels = qMax(0, channels);
+    m_length = qMax(0, length);
+    m_factor = qBound(MinFactor, factor, MaxFactor);
+
+    const int bins = m_length * m_factor;
+    m_sum.fill(0.0f, m_channels * bins);
+    m_count.fill(0, bins);
+    m_composite.fill(0.0f, m_channels * bins);
+
+    reset();
+}
+
+void EquivalentTimeSampler::reset()
+{
+    m_frameCount = 0;
+    m_filledBins = 0;
+    m_anchor = -1.0;
+    m_sum.fill(0.0f);
+    m_count.fill(0);
+    m_composite.fill(0.0f);
+}
+
+double EquivalentTimeSampler::findCrossing(const float *x) const
+{
+    float lo = x[0];
+    float hi = x[0];
+    for (int i = 1; i < m_length; ++i) {
+        lo = qMin(lo, x[i]);
+        hi = qMax(hi, x[i]);
+    }
+    if (hi - lo < 1e-3f) return -1.0;
+
+    // Rising crossings of the mid level, re-armed only after the signal has
+    // dropped clearly below it so noise near the level is not mistaken for
+    // an edge
+    const float level = 0.5f * (lo + hi);
+    const float hysteresis = 0.05f * (hi - lo);
+    double best = -1.0;
+    bool armed = false;
+    for (int i = 0; i + 1 < m_length; ++i) {
+        if (x[i] < level - hysteresis) armed = true;
+        if (armed && x[i] < level && x[i + 1] >= level) {
+            const double t = i + (level - x[i]) / static_cast<double>(x[i + 1] - x[i]);
+            if (m_anchor < 0.0) return t;
+            if (best < 0.0 || qAbs(t - m_anchor) < qAbs(best - m_anchor)) best = t;
+            armed = false;
+        }
+    }
+    return best;
+}
+
+bool EquivalentTimeSampler::addFrame(const float *const *frame)
+{
+    if (m_channels == 0 || m_length < 2) return false;
+
+    const double crossing = findCrossing(frame[0]);
+    if (crossing < 0.0) return false;
+    if (m_anchor < 0.0) m_anchor = crossing;
+
+    // Sample i lands at grid position (i + anchor - crossing) * factor; the
+    // integer part of i * factor is exact, so only the shift is rounded
+    const int bins = m_length * m_factor;
+    const int offset = qRound((m_anchor - crossing) * m_factor);
+    const int first = qMax(0, (-offset + m_factor - 1) / m_factor);
+    const int last = qMin(m_length, (bins - offset + m_factor - 1) / m_factor);
+
+    quint16 *count = m_count.data();
+    for (int i = first; i < last; ++i) {
+        const int bin = i * m_factor + offset;
+        if (count[bin] == 0) ++m_filledBins;
+        if (count[bin] == MaxHits) {
+            count[bin] /= 2;
+            for (int c = 0; c < m_channels; ++c) {
+                m_sum[c * bins + bin] *= 0.5f;
+            }
+        }
+        ++count[bin];
+    }
+
+    for (int c = 0; c < m_channels; ++c) {
+        const float *x = frame[c];
+        float *sum = m_sum.data() + c * bins;
+        float *composite = m_composite.data() + c * bins;
+        for (int i = first; i < last; ++i) {
+            const int bin = i * m_factor + offset;
+            sum[bin] += x[i];
+            composite[bin] = sum[bin] / count[bin];
+        }
+        // Gaps only exist until every bin has been hit at least once
+        if (m_filledBins < bins) fillGaps(c);
+    }
+
+    ++m_frameCount;
+    return true;
+}
+
+void EquivalentTimeSampler::fillGaps(int channel)
+{
+    const int bins = m_length * m_factor;
+    const quint16 *count = m_count.constData();
+    float *composite = m_composite.data() + channel * bins;
+
+    int previous = -1;
+    for (int bin = 0; bin <= bins; ++bin) {
+        if (bin < bins && count[bin] == 0) continue;
+
+        // Interpolate the run of empty bins between two filled ones, holding
+        // the nearest value at either end of the grid
+        if (bin - previous > 1) {
+            const float a = previous >= 0 ? composite[previous] : (bin < bins ? composite[bin] : 0.0f);
+            const float b = bin < bins ? composite[bin] : a;
+            const int span = bin - previous;
+            for (int k = previous + 1; k < bin; ++k) {
+                composite[k] = previous >= 0 && bin < bins
+                               ? a + (b - a) * (k - previous) / span
+                               : (previous >= 0 ? a : b);
+            }
+        }
+        previous = bin;
+    }
+}
+
+const float *EquivalentTimeSampler::composite(int channel) const
+{
+    return m_composite.constData() + channel * m_length * m_factor;
+}
+
+double EquivalentTimeSampler::coverage() const
+{
+    const int bins = m_length * m_factor;
+    return bins > 0 ? static_cast<double>(m_filledBins) / bins : 0.0;
+}
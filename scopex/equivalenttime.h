@@ -0,0 +1,56 @@
+#ifndef EQUIVALENTTIME_H
+#define EQUIVALENTTIME_H
+
+#include <QVector>
+
+// Equivalent-time reconstruction of repetitive signals. Every triggered frame
+// is aligned on the sub-sample position of its trigger crossing and its
+// samples are binned into a grid `factor` times finer than the sample period.
+// Because the sample clock is not locked to the signal, successive frames land
+// in different bins and the composite sharpens as frames arrive. Memory is
+// fixed by configure(): one grid per channel, no frame history.
+class EquivalentTimeSampler
+{
+public:
+    static constexpr int MinFactor = 10;
+    static constexpr int MaxFactor = 50;
+
+    EquivalentTimeSampler();
+
+    void configure(int channels, int length, int factor);
+    void reset();
+
+    // Adds one frame given as `channels` pointers to `length` volts each.
+    // Channel 0 provides the trigger crossing. Returns false when the frame
+    // has no usable rising crossing and was skipped.
+    bool addFrame(const float *const *frame);
+
+    int channels() const { return m_channels; }
+    int length() const { return m_length; }
+    int factor() const { return m_factor; }
+    int frameCount() const { return m_frameCount; }
+
+    // Composite of `length() * factor()` points spaced 1 / factor() samples
+    // apart. Bins that have not been hit yet are linearly filled.
+    const float *composite(int channel) const;
+
+    // Fraction of grid bins that hold at least one sample
+    double coverage() const;
+
+private:
+    double findCrossing(const float *x) const;
+    void fillGaps(int channel);
+
+    int m_channels;
+    int m_length;
+    int m_factor;
+    int m_frameCount;
+    int m_filledBins;
+    double m_anchor;  // Crossing position the grid is aligned to
+
+    QVector<float> m_sum;        // channels x bins
+    QVector<quint16> m_count;    // Hits per bin, shared by all channels
+    QVector<float> m_composite;  // channels x bins
+};
+
+#endif // EQUIVALENTTIME_H
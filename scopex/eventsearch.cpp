@@ -0,0 +1,249 @@
+#include "eventsearch.h"
+#include <QFile>
+#include <QtConcurrent>
+#include <cstring>
+#include <numeric>
+
+namespace {
+const char SummaryMagic[8] = { 'S', 'C', 'P', 'X', 'S', 'U', 'M', '1' };
+
+struct SummaryHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 channels;
+    quint32 framesPerBlock;
+    quint32 recordLength;
+    quint64 frames;
+};
+
+// Blocks per parallel work item, about a quarter million samples
+const int ChunkBlocks = 64;
+
+// Samples per run tested for transitions before walking it
+const int RunLength = 64;
+
+struct ChunkEdges {
+    QVector<qint64> rising;
+    QVector<qint64> falling;
+};
+
+// Appends the transitions through `threshold` in one frame segment; `above`
+// carries the state of the previous sample in and the last sample out
+void scanSegment(const quint8 *codes, int count, qint64 base, quint8 threshold,
+                 bool &above, ChunkEdges &edges)
+{
+    bool state = above;
+    for (int start = 0; start < count; start += RunLength) {
+        const quint8 *p = codes + start;
+        const int n = qMin(RunLength, count - start);
+
+        // Counting changes between neighbours is a plain byte compare loop,
+        // which the compiler turns into wide vector compares
+        int changes = (p[0] > threshold) != state;
+        for (int i = 1; i < n; ++i) {
+            changes += (p[i] > threshold) != (p[i - 1] > threshold);
+        }
+        if (changes == 0) continue;
+
+        for (int i = 0; i < n; ++i) {
+            const bool sample = p[i] > threshold;
+            if (sample == state) continue;
+            (sample ? edges.rising : edges.falling).append(base + start + i);
+            state = sample;
+        }
+    }
+    above = state;
+}
+}
+
+BlockSummary::BlockSummary() :
+    m_channels(0),
+    m_framesPerBlock(0),
+    m_frames(0)
+{
+}
+
+QString BlockSummary::pathFor(const QString &recordingPath)
+{
+    return recordingPath + ".summary";
+}
+
+void BlockSummary::clear()
+{
+    m_channels = 0;
+    m_framesPerBlock = 0;
+    m_frames = 0;
+    m_minMax.clear();
+}
+
+bool BlockSummary::load(const RecordingReader &reader)
+{
+    clear();
+
+    QFile file(pathFor(reader.path()));
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    SummaryHeader header;
+    if (file.read(reinterpret_cast<char *>(&header), sizeof(header)) != sizeof(header)
+        || std::memcmp(header.magic, SummaryMagic, sizeof(SummaryMagic)) != 0
+        || header.version != 1 || int(header.channels) != reader.channels()
+        || int(header.recordLength) != reader.recordLength()
+        || header.frames != reader.frameCount() || header.framesPerBlock == 0) {
+        return false;
+    }
+
+    const qint64 blocks = (header.frames + header.framesPerBlock - 1) / header.framesPerBlock;
+    const qint64 bytes = blocks * header.channels * 2;
+    m_minMax.resize(bytes);
+    if (file.read(reinterpret_cast<char *>(m_minMax.data()), bytes) != bytes) {
+        m_minMax.clear();
+        return false;
+    }
+
+    m_channels = header.channels;
+    m_framesPerBlock = header.framesPerBlock;
+    m_frames = header.frames;
+    return true;
+}
+
+void BlockSummary::build(const RecordingReader &reader)
+{
+    clear();
+    if (!reader.isOpen()) return;
+
+    m_channels = reader.channels();
+    m_framesPerBlock = qMax(1, TargetBlockSamples / reader.recordLength());
+    m_frames = reader.frameCount();
+    const qint64 blocks = (m_frames + m_framesPerBlock - 1) / m_framesPerBlock;
+    m_minMax.resize(blocks * m_channels * 2);
+
+    QVector<qint64> indices(blocks);
+    std::iota(indices.begin(), indices.end(), 0);
+    const int length = reader.recordLength();
+    quint8 *minMax = m_minMax.data();
+    const int channels = m_channels;
+    const int framesPerBlock = m_framesPerBlock;
+    const quint64 frames = m_frames;
+
+    QtConcurrent::blockingMap(indices, [&](qint64 block) {
+        const quint64 first = quint64(block) * framesPerBlock;
+        const quint64 last = qMin(frames, first + framesPerBlock);
+        for (int c = 0; c < channels; ++c) {
+            quint8 low = 255;
+            quint8 high = 0;
+            for (quint64 f = first; f < last; ++f) {
+                const quint8 *codes = reader.frame(f, c);
+                for (int i = 0; i < length; ++i) {
+                    low = qMin(low, codes[i]);
+                    high = qMax(high, codes[i]);
+                }
+            }
+            minMax[(block * channels + c) * 2] = low;
+            minMax[(block * channels + c) * 2 + 1] = high;
+        }
+    });
+}
+
+bool BlockSummary::save(const RecordingReader &reader) const
+{
+    if (!isValid()) return false;
+
+    QFile file(pathFor(reader.path()));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    SummaryHeader header;
+    std::memcpy(header.magic, SummaryMagic, sizeof(SummaryMagic));
+    header.version = 1;
+    header.channels = m_channels;
+    header.framesPerBlock = m_framesPerBlock;
+    header.recordLength = reader.recordLength();
+    header.frames = m_frames;
+    return file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header)
+           && file.write(reinterpret_cast<const char *>(m_minMax.constData()), m_minMax.size()) == m_minMax.size();
+}
+
+QVector<EventSearch::Event> EventSearch::run(const RecordingReader &reader, const BlockSummary *summary,
+                                             const Query &query)
+{
+    QVector<Event> events;
+    if (!reader.isOpen() || query.channel < 0 || query.channel >= reader.channels()) return events;
+
+    // Level to code: a sample is above when its code exceeds `threshold`.
+    // The conversion table rises with the code.
+    const float *table = reader.voltsTable(query.channel);
+    int threshold = -1;
+    while (threshold < 255 && table[threshold + 1] <= query.level) ++threshold;
+    if (threshold < 0 || threshold >= 255) return events;   // Level outside the range
+    const quint8 code = static_cast<quint8>(threshold);
+
+    const int length = reader.recordLength();
+    const quint64 frames = reader.frameCount();
+    const bool skipping = summary && summary->isValid();
+    const int framesPerBlock = skipping ? summary->framesPerBlock()
+                                        : qMax(1, BlockSummary::TargetBlockSamples / length);
+    const qint64 blocks = (frames + framesPerBlock - 1) / framesPerBlock;
+    const qint64 chunks = (blocks + ChunkBlocks - 1) / ChunkBlocks;
+
+    QVector<qint64> indices(chunks);
+    std::iota(indices.begin(), indices.end(), 0);
+    const int channel = query.channel;
+
+    const QList<ChunkEdges> chunkEdges = QtConcurrent::blockingMapped(indices, [&](qint64 chunk) {
+        ChunkEdges edges;
+        const qint64 firstBlock = chunk * ChunkBlocks;
+        const qint64 lastBlock = qMin(blocks, firstBlock + ChunkBlocks);
+
+        for (qint64 block = firstBlock; block < lastBlock; ++block) {
+            const quint64 firstFrame = quint64(block) * framesPerBlock;
+            const quint64 lastFrame = qMin(frames, firstFrame + framesPerBlock);
+
+            if (skipping) {
+                const bool allBelow = summary->maximum(block, channel) <= code;
+                const bool allAbove = summary->minimum(block, channel) > code;
+                if (allBelow || allAbove) continue;
+            }
+
+            // Each frame starts from its own first sample, as the frame
+            // before it ended at some earlier trigger
+            for (quint64 f = firstFrame; f < lastFrame; ++f) {
+                const quint8 *codes = reader.frame(f, channel);
+                bool above = codes[0] > code;
+                scanSegment(codes, length, qint64(f) * length, code, above, edges);
+            }
+        }
+        return edges;
+    });
+
+    // Chunks come back in order, so the edge lists stay sorted
+    QVector<qint64> rising;
+    QVector<qint64> falling;
+    for (const ChunkEdges &edges : chunkEdges) {
+        rising += edges.rising;
+        falling += edges.falling;
+    }
+
+    if (query.type == RisingEdge || query.type == FallingEdge) {
+        const QVector<qint64> &edges = query.type == RisingEdge ? rising : falling;
+        events.reserve(edges.size());
+        for (qint64 position : edges) events.append(Event{ position, 0 });
+        return events;
+    }
+
+    // A pulse runs from a leading edge to the next trailing edge in the
+    // same frame
+    const QVector<qint64> &leading = query.negative ? falling : rising;
+    const QVector<qint64> &trailing = query.negative ? rising : falling;
+    const double limit = query.width * reader.sampleRate();
+    int t = 0;
+    for (qint64 position : leading) {
+        while (t < trailing.size() && trailing[t] <= position) ++t;
+        if (t == trailing.size()) break;
+        if (trailing[t] / length != position / length) continue;
+        const qint64 width = trailing[t] - position;
+        if (query.type == NarrowPulse ? width < limit : width > limit) {
+            events.append(Event{ position, width });
+        }
+    }
+    return events;
+}
@@ -0,0 +1,81 @@
+#ifndef EVENTSEARCH_H
+#define EVENTSEARCH_H
+
+#include <QVector>
+#include <QString>
+#include "recording.h"
+
+// Minimum and maximum code of each channel over fixed blocks of frames,
+// stored next to the recording as "<recording>.summary". A block that stays
+// entirely on one side of a search level holds no crossings and is skipped
+// without touching its samples.
+class BlockSummary
+{
+public:
+    static constexpr int TargetBlockSamples = 4096;
+
+    BlockSummary();
+
+    static QString pathFor(const QString &recordingPath);
+
+    // Loads the summary file if it matches the recording
+    bool load(const RecordingReader &reader);
+    // Computes the summary in parallel over the recording
+    void build(const RecordingReader &reader);
+    bool save(const RecordingReader &reader) const;
+    void clear();
+
+    bool isValid() const { return m_framesPerBlock > 0; }
+    int framesPerBlock() const { return m_framesPerBlock; }
+    qint64 blockCount() const { return m_minMax.size() / (2 * m_channels); }
+    quint8 minimum(qint64 block, int channel) const { return m_minMax[(block * m_channels + channel) * 2]; }
+    quint8 maximum(qint64 block, int channel) const { return m_minMax[(block * m_channels + channel) * 2 + 1]; }
+
+private:
+    int m_channels;
+    int m_framesPerBlock;
+    quint64 m_frames;
+    QVector<quint8> m_minMax;   // Per block, per channel: minimum, maximum
+};
+
+// Event search over a recording. The stream of one channel (frames
+// concatenated) is cut into chunks scanned in parallel; the level test runs
+// on raw codes in short vectorizable runs, and only runs containing a
+// transition are walked sample by sample. Edges from all chunks are then
+// paired into pulses in order. Consecutive frames are separate triggers, not
+// one continuous signal, so no edge or pulse spans a frame boundary.
+class EventSearch
+{
+public:
+    enum Type {
+        RisingEdge = 0,
+        FallingEdge = 1,
+        NarrowPulse = 2,   // Pulse shorter than the width
+        WidePulse = 3      // Pulse longer than the width
+    };
+
+    struct Query {
+        Type type = RisingEdge;
+        int channel = 0;
+        double level = 0.0;      // Volts
+        double width = 0.0;      // Seconds, pulses only
+        bool negative = false;   // Pulses below the level instead of above
+
+        bool operator==(const Query &other) const
+        {
+            return type == other.type && channel == other.channel && level == other.level
+                   && width == other.width && negative == other.negative;
+        }
+    };
+
+    struct Event {
+        qint64 position;   // First sample past the (leading) crossing
+        qint64 width;      // Samples, 0 for edges
+    };
+
+    // Thread-safe; `summary` may be null or invalid, which disables skipping
+    static QVector<Event> run(const RecordingReader &reader, const BlockSummary *summary,
+                              const Query &query);
+};
+
+#endif // EVENTSEARCH_H
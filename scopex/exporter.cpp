@@ -0,0 +1,243 @@
+#include "exporter.h"
+#include <QFile>
+#include <QThread>
+#include <QtConcurrent>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace {
+// Longest field: sign, 9 significant digits of a float or 17 of a double
+// plus exponent, and the separator
+const int MaxFieldLength = 32;
+
+char *appendNumber(char *out, double value)
+{
+    return std::to_chars(out, out + MaxFieldLength, value).ptr;
+}
+
+char *appendNumber(char *out, float value)
+{
+    return std::to_chars(out, out + MaxFieldLength, value).ptr;
+}
+
+template<typename T>
+void putLittleEndian(char *out, T value)
+{
+    for (size_t i = 0; i < sizeof(T); ++i) out[i] = static_cast<char>((quint64(value) >> (8 * i)) & 0xFF);
+}
+
+QByteArray wavHeader(const ExportSource &source, quint32 dataBytes)
+{
+    const quint16 channels = static_cast<quint16>(source.channels());
+    const quint32 rate = static_cast<quint32>(std::lround(source.sampleRate()));
+    const quint16 blockAlign = channels * 2;
+
+    QByteArray header(44, '\0');
+    char *h = header.data();
+    std::memcpy(h, "RIFF", 4);
+    putLittleEndian<quint32>(h + 4, 36 + dataBytes);
+    std::memcpy(h + 8, "WAVEfmt ", 8);
+    putLittleEndian<quint32>(h + 16, 16);
+    putLittleEndian<quint16>(h + 20, 1);   // PCM
+    putLittleEndian<quint16>(h + 22, channels);
+    putLittleEndian<quint32>(h + 24, rate);
+    putLittleEndian<quint32>(h + 28, rate * blockAlign);
+    putLittleEndian<quint16>(h + 32, blockAlign);
+    putLittleEndian<quint16>(h + 34, 16);
+    std::memcpy(h + 36, "data", 4);
+    putLittleEndian<quint32>(h + 40, dataBytes);
+    return header;
+}
+
+// Converts one chunk of every channel into the bytes of the chosen format
+QByteArray convertChunk(const ExportSource &source, Exporter::Format format, qint64 chunk)
+{
+    const int channels = source.channels();
+    const qint64 first = chunk * Exporter::ChunkSamples;
+    const int count = static_cast<int>(qMin<qint64>(Exporter::ChunkSamples, source.samples() - first));
+
+    QVector<float> volts(qsizetype(channels) * count);
+    for (int c = 0; c < channels; ++c) source.read(c, first, count, volts.data() + qsizetype(c) * count);
+
+    QByteArray bytes;
+    if (format == Exporter::Csv) {
+        bytes.resize(qsizetype(count) * (channels + 1) * MaxFieldLength);
+        char *out = bytes.data();
+        const double rate = source.sampleRate();
+        for (int i = 0; i < count; ++i) {
+            out = appendNumber(out, (first + i) / rate);
+            for (int c = 0; c < channels; ++c) {
+                *out++ = ',';
+                out = appendNumber(out, volts[qsizetype(c) * count + i]);
+            }
+            *out++ = '\n';
+        }
+        bytes.truncate(out - bytes.data());
+    } else if (format == Exporter::Binary) {
+        bytes.resize(qsizetype(count) * channels * sizeof(float));
+        char *out = bytes.data();
+        for (int i = 0; i < count; ++i) {
+            for (int c = 0; c < channels; ++c) {
+                quint32 word;
+                std::memcpy(&word, &volts[qsizetype(c) * count + i], sizeof(word));
+                putLittleEndian<quint32>(out, word);
+                out += sizeof(word);
+            }
+        }
+    } else {
+        bytes.resize(qsizetype(count) * channels * 2);
+        char *out = bytes.data();
+        for (int i = 0; i < count; ++i) {
+            for (int c = 0; c < channels; ++c) {
+                const float scaled = volts[qsizetype(c) * count + i] * (32767.0f / 10.0f);
+                const qint16 value = static_cast<qint16>(std::lround(qBound(-32768.0f, scaled, 32767.0f)));
+                putLittleEndian<quint16>(out, static_cast<quint16>(value));
+                out += 2;
+            }
+        }
+    }
+    return bytes;
+}
+}
+
+ExportSource::ExportSource() :
+    m_reader(nullptr),
+    m_channels(0),
+    m_samples(0),
+    m_sampleRate(1.0)
+{
+}
+
+ExportSource ExportSource::fromFrame(const VoltFrame &frame)
+{
+    ExportSource source;
+    source.m_frame = frame;
+    source.m_channels = frame.channels();
+    source.m_samples = frame.length();
+    source.m_sampleRate = frame.info.sampleRate;
+    return source;
+}
+
+ExportSource ExportSource::fromFrame(const SharedFrame &frame)
+{
+    // Holds the published frame rather than copying it
+    ExportSource source;
+    source.m_codes = frame;
+    source.m_channels = frame->channels();
+    source.m_samples = frame->length();
+    source.m_sampleRate = frame->info.sampleRate;
+    return source;
+}
+
+ExportSource ExportSource::fromRecording(const RecordingReader &reader)
+{
+    ExportSource source;
+    source.m_reader = &reader;
+    source.m_channels = reader.channels();
+    source.m_samples = reader.sampleCount();
+    source.m_sampleRate = reader.sampleRate();
+    return source;
+}
+
+void ExportSource::read(int channel, qint64 first, int count, float *out) const
+{
+    if (!m_codes.isNull()) {
+        m_codes->volts(channel, static_cast<int>(first), count, out);
+        return;
+    }
+    if (!m_reader) {
+        std::copy(m_frame.channel(channel) + first, m_frame.channel(channel) + first + count, out);
+        return;
+    }
+
+    // Runs of codes within each frame through the recording's table
+    const float *table = m_reader->voltsTable(channel);
+    const int length = m_reader->recordLength();
+    while (count > 0) {
+        const quint8 *codes = m_reader->frame(first / length, channel);
+        const int offset = static_cast<int>(first % length);
+        const int n = qMin(count, length - offset);
+        for (int i = 0; i < n; ++i) out[i] = table[codes[offset + i]];
+        out += n;
+        first += n;
+        count -= n;
+    }
+}
+
+bool Exporter::write(const QString &path, Format format, const ExportSource &source,
+                     const Progress &progress, QString *error)
+{
+    if (source.channels() == 0 || source.samples() == 0) {
+        if (error) *error = QStringLiteral("nothing to export");
+        return false;
+    }
+
+    QByteArray header;
+    if (format == Csv) {
+        header = "time";
+        for (int c = 0; c < source.channels(); ++c) header += ",ch" + QByteArray::number(c + 1);
+        header += '\n';
+    } else if (format == Wav) {
+        const quint64 dataBytes = quint64(source.samples()) * source.channels() * 2;
+        if (dataBytes > 0xFFFFFFFFull - 36) {
+            if (error) *error = QStringLiteral("too long for a WAV file, export as binary instead");
+            return false;
+        }
+        header = wavHeader(source, static_cast<quint32>(dataBytes));
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    file.write(header);
+
+    const qint64 chunks = (source.samples() + ChunkSamples - 1) / ChunkSamples;
+    const qint64 batch = qMax(2, QThread::idealThreadCount());
+    auto convert = [&source, format](qint64 chunk) { return convertChunk(source, format, chunk); };
+    auto startBatch = [&](qint64 firstChunk) {
+        QVector<qint64> indices;
+        for (qint64 c = firstChunk; c < qMin(chunks, firstChunk + batch); ++c) indices.append(c);
+        return QtConcurrent::mapped(indices, convert);
+    };
+
+    bool ok = true;
+    QFuture<QByteArray> next = startBatch(0);
+    for (qint64 firstChunk = 0; firstChunk < chunks && ok; firstChunk += batch) {
+        QFuture<QByteArray> current = next;
+        current.waitForFinished();
+        if (firstChunk + batch < chunks) next = startBatch(firstChunk + batch);
+
+        for (const QByteArray &bytes : current.results()) {
+            if (file.write(bytes) != bytes.size()) {
+                if (error) *error = file.errorString();
+                ok = false;
+                break;
+            }
+        }
+
+        const double done = double(qMin(chunks, firstChunk + batch)) / chunks;
+        if (ok && progress && !progress(done)) {
+            if (error) *error = QStringLiteral("cancelled");
+            ok = false;
+        }
+    }
+
+    // The batch in flight still reads the source
+    next.waitForFinished();
+    file.close();
+    if (!ok) QFile::remove(path);
+    return ok;
+}
+
+QString Exporter::suffix(Format format)
+{
+    switch (format) {
+    case Csv: return QStringLiteral("csv");
+    case Binary: return QStringLiteral("bin");
+    case Wav: return QStringLiteral("wav");
+    }
+    return QString();
+}
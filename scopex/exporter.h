@@ -0,0 +1,66 @@
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include <QVector>
+#include <QString>
+#include <functional>
+#include "recording.h"
+#include "scaledframe.h"
+
+// Samples in volts to export: a copy of a frame in volts, a shared frame
+// of codes, or a view of an open recording. Codes are converted as they are
+// read.
+// read() is safe to call from several threads at once.
+class ExportSource
+{
+public:
+    // Copies the frame; its metadata gives the sample rate
+    static ExportSource fromFrame(const VoltFrame &frame);
+    static ExportSource fromFrame(const SharedFrame &frame);
+    static ExportSource fromRecording(const RecordingReader &reader);
+
+    int channels() const { return m_channels; }
+    qint64 samples() const { return m_samples; }
+    double sampleRate() const { return m_sampleRate; }
+
+    void read(int channel, qint64 first, int count, float *out) const;
+
+private:
+    ExportSource();
+
+    const RecordingReader *m_reader;
+    VoltFrame m_frame;
+    SharedFrame m_codes;
+    int m_channels;
+    qint64 m_samples;
+    double m_sampleRate;
+};
+
+// Streams a source to disk in fixed chunks. Chunks are converted in
+// parallel batches, and the next batch is converted while the current one
+// is written, so memory stays bounded and large exports are limited by the
+// disk rather than by formatting.
+//   Csv     "time,ch1,ch2" text, numbers in shortest round-trip form
+//   Binary  interleaved little-endian float32 volts, no header
+//   Wav     16-bit PCM, +/-10 V full scale
+class Exporter
+{
+public:
+    enum Format {
+        Csv = 0,
+        Binary = 1,
+        Wav = 2
+    };
+
+    static constexpr int ChunkSamples = 65536;
+
+    // Called after each batch with the fraction done; returning false cancels
+    using Progress = std::function<bool(double)>;
+
+    static bool write(const QString &path, Format format, const ExportSource &source,
+                      const Progress &progress = Progress(), QString *error = nullptr);
+
+    static QString suffix(Format format);
+};
+
+#endif // EXPORTER_H
@@ -0,0 +1,294 @@
+#include "eyediagram.h"
+#include <QtMath>
+#include <cstring>
+
+EyeDiagram::EyeDiagram() :
+    m_columns(0),
+    m_rows(0),
+    m_unitIntervals(2),
+    m_bitRate(0.0),
+    m_scaled(false),
+    m_low(0.0f),
+    m_high(0.0f),
+    m_unitInterval(0.0),
+    m_phase(0.0),
+    m_maxHits(0),
+    m_crossings(0),
+    m_offsetSum(0.0),
+    m_offsetSquares(0.0),
+    m_offsetMin(0.0),
+    m_offsetMax(0.0)
+{
+    m_interpolator.setMode(Interpolator::SincInterpolation);
+    m_interpolator.setFactor(8);
+    setColor(QColor(255, 255, 0));
+    configure(256, 256);
+}
+
+void EyeDiagram::configure(int columns, int rows)
+{
+    columns = qBound(16, columns, 2048);
+    rows = qBound(16, rows, 2048);
+    if (columns == m_columns && rows == m_rows) return;
+
+    m_columns = columns;
+    m_rows = rows;
+    m_hits.resize(columns * rows);
+    m_image = QImage(columns, rows, QImage::Format_RGBA8888);
+    clear();
+}
+
+void EyeDiagram::setUnitIntervals(int count)
+{
+    count = qBound(1, count, 2);
+    if (count == m_unitIntervals) return;
+    m_unitIntervals = count;
+    clear();
+}
+
+void EyeDiagram::setBitRate(double bitRate)
+{
+    m_bitRate = qMax(0.0, bitRate);
+    clear();
+}
+
+void EyeDiagram::setUpsampling(int factor)
+{
+    m_interpolator.setFactor(factor);
+}
+
+void EyeDiagram::setColor(const QColor &color)
+{
+    m_color = color;
+    for (int i = 0; i < 256; ++i) {
+        const double level = i == 0 ? 0.0 : 0.15 + 0.85 * i / 255.0;
+        const uchar rgba[4] = {
+            static_cast<uchar>(color.red() * level),
+            static_cast<uchar>(color.green() * level),
+            static_cast<uchar>(color.blue() * level),
+            255
+        };
+        std::memcpy(&m_palette[i], rgba, sizeof(rgba));
+    }
+    render();
+}
+
+void EyeDiagram::clear()
+{
+    m_scaled = false;
+    m_unitInterval = 0.0;
+    m_phase = 0.0;
+    m_hits.fill(0);
+    m_maxHits = 0;
+    m_crossings = 0;
+    m_offsetSum = 0.0;
+    m_offsetSquares = 0.0;
+    m_offsetMin = 0.0;
+    m_offsetMax = 0.0;
+    m_result = Result();
+    m_image.fill(QColor(0, 0, 0));
+}
+
+bool EyeDiagram::recoverClock(const float *samples, int count, double threshold, double hysteresis)
+{
+    // Threshold crossings at sub-sample resolution. A crossing only counts
+    // once the signal clears the hysteresis band on the far side, which
+    // keeps noise on slow edges from adding extra transitions.
+    m_crossingTimes.clear();
+    bool high = samples[0] > threshold;
+    double candidate = -1.0;
+    for (int i = 1; i < count; ++i) {
+        const float a = samples[i - 1];
+        const float b = samples[i];
+        if ((a > threshold) != (b > threshold)) {
+            candidate = i - 1 + (threshold - a) / (b - a);
+        }
+        const bool flip = high ? b < threshold - hysteresis : b > threshold + hysteresis;
+        if (flip) {
+            high = !high;
+            if (candidate >= 0.0) m_crossingTimes.append(static_cast<float>(candidate));
+            candidate = -1.0;
+        }
+    }
+
+    const int crossings = m_crossingTimes.size();
+    if (crossings < 3) return false;
+
+    if (m_bitRate <= 0.0) {
+        // Shortest gap as the first guess, then every gap divided by its
+        // whole number of unit intervals, smoothed across frames
+        double guess = m_unitInterval;
+        if (guess <= 0.0) {
+            guess = count;
+            for (int i = 1; i < crossings; ++i) {
+                guess = qMin(guess, double(m_crossingTimes[i] - m_crossingTimes[i - 1]));
+            }
+        }
+        double span = 0.0;
+        double intervals = 0.0;
+        for (int i = 1; i < crossings; ++i) {
+            const double gap = m_crossingTimes[i] - m_crossingTimes[i - 1];
+            span += gap;
+            intervals += qMax(1.0, double(qRound(gap / guess)));
+        }
+        const double estimate = span / intervals;
+        m_unitInterval = m_unitInterval > 0.0 ? m_unitInterval + 0.2 * (estimate - m_unitInterval) : estimate;
+    }
+    if (m_unitInterval < 2.0) return false;
+
+    // Clock phase as the circular mean of the crossing times
+    double sine = 0.0;
+    double cosine = 0.0;
+    const double omega = 2.0 * M_PI / m_unitInterval;
+    for (float t : std::as_const(m_crossingTimes)) {
+        sine += qSin(omega * t);
+        cosine += qCos(omega * t);
+    }
+    m_phase = std::atan2(sine, cosine) / omega;
+
+    for (float t : std::as_const(m_crossingTimes)) {
+        double offset = (t - m_phase) / m_unitInterval;
+        offset -= qRound(offset);
+        if (m_crossings == 0) {
+            m_offsetMin = m_offsetMax = offset;
+        } else {
+            m_offsetMin = qMin(m_offsetMin, offset);
+            m_offsetMax = qMax(m_offsetMax, offset);
+        }
+        m_offsetSum += offset;
+        m_offsetSquares += offset * offset;
+        ++m_crossings;
+    }
+    return true;
+}
+
+void EyeDiagram::fold(int count)
+{
+    // Crossings land at 0 and 1 of a 1 UI window, or at 1/4 and 3/4 of a
+    // 2 UI window, so an eye is always centred
+    const float step = static_cast<float>(m_interpolator.outputStep());
+    const float scale = static_cast<float>(1.0 / (m_unitIntervals * m_unitInterval));
+    const float start = static_cast<float>(-m_phase * scale + (m_unitIntervals == 2 ? 0.25 : 0.0));
+    const float columns = static_cast<float>(m_columns);
+    const float rowScale = (m_rows - 1) / (m_high - m_low);
+    const float high = m_high;
+    const int lastColumn = m_columns - 1;
+    const int lastRow = m_rows - 1;
+
+    // Straight-line arithmetic over plain arrays, which the compiler
+    // vectorizes; only the scatter into the histogram below is serial
+    int *cells = m_cells.data();
+    const float *points = m_points.constData();
+    for (int i = 0; i < count; ++i) {
+        float position = i * step * scale + start;
+        position -= std::floor(position);
+        const int column = qMin(lastColumn, static_cast<int>(position * columns));
+        const int row = static_cast<int>((high - points[i]) * rowScale + 0.5f);
+        cells[i] = row >= 0 && row <= lastRow ? row * m_columns + column : -1;
+    }
+
+    quint32 *hits = m_hits.data();
+    quint32 maxHits = m_maxHits;
+    for (int i = 0; i < count; ++i) {
+        if (cells[i] < 0) continue;
+        maxHits = qMax(maxHits, ++hits[cells[i]]);
+    }
+
+    // Halve everything before a counter can overflow; the shape is kept
+    if (maxHits >= (1u << 30)) {
+        for (quint32 &h : m_hits) h >>= 1;
+        maxHits >>= 1;
+    }
+    m_maxHits = maxHits;
+}
+
+void EyeDiagram::updateResult(double sampleRate)
+{
+    // Levels from the middle fifth of a unit interval around the eye centre
+    const int centre = m_columns / 2;
+    const int halfWidth = qMax(1, qRound(0.1 * m_columns / m_unitIntervals));
+    const double voltsPerRow = double(m_high - m_low) / (m_rows - 1);
+    const int thresholdRow = qRound((m_high - m_result.threshold) / voltsPerRow);
+
+    double n[2] = { 0.0, 0.0 };
+    double sum[2] = { 0.0, 0.0 };
+    double squares[2] = { 0.0, 0.0 };
+    for (int row = 0; row < m_rows; ++row) {
+        const double volts = m_high - row * voltsPerRow;
+        const int level = row < thresholdRow ? 1 : 0;
+        const quint32 *hits = m_hits.constData() + row * m_columns;
+        for (int column = centre - halfWidth; column <= centre + halfWidth; ++column) {
+            const double h = hits[column];
+            n[level] += h;
+            sum[level] += h * volts;
+            squares[level] += h * volts * volts;
+        }
+    }
+    if (n[0] == 0.0 || n[1] == 0.0 || m_crossings < 2) return;
+
+    const double mean0 = sum[0] / n[0];
+    const double mean1 = sum[1] / n[1];
+    const double sigma0 = qSqrt(qMax(0.0, squares[0] / n[0] - mean0 * mean0));
+    const double sigma1 = qSqrt(qMax(0.0, squares[1] / n[1] - mean1 * mean1));
+
+    const double ui = m_unitInterval / sampleRate;
+    const double meanOffset = m_offsetSum / m_crossings;
+    const double offsetSigma = qSqrt(qMax(0.0, m_offsetSquares / m_crossings - meanOffset * meanOffset));
+
+    m_result.valid = true;
+    m_result.unitInterval = ui;
+    m_result.bitRate = 1.0 / ui;
+    m_result.eyeAmplitude = mean1 - mean0;
+    m_result.eyeHeight = qMax(0.0, (mean1 - 3.0 * sigma1) - (mean0 + 3.0 * sigma0));
+    m_result.jitterRms = offsetSigma * ui;
+    m_result.jitterPeakToPeak = (m_offsetMax - m_offsetMin) * ui;
+    m_result.eyeWidth = qMax(0.0, ui - m_result.jitterPeakToPeak);
+    m_result.crossings = m_crossings;
+}
+
+void EyeDiagram::render()
+{
+    if (m_image.isNull()) return;
+
+    // Log scale, so rare excursions stay visible next to the dense traces
+    const float scale = m_maxHits > 0 ? 255.0f / std::log1p(float(m_maxHits)) : 0.0f;
+    const int cells = m_hits.size();
+    const quint32 *hits = m_hits.constData();
+    quint32 *pixel = reinterpret_cast<quint32 *>(m_image.bits());
+    for (int i = 0; i < cells; ++i) {
+        pixel[i] = m_palette[hits[i] ? qBound(1, static_cast<int>(std::log1p(float(hits[i])) * scale), 255) : 0];
+    }
+}
+
+void EyeDiagram::addFrame(const float *samples, int count, double sampleRate)
+{
+    if (count < 8 || sampleRate <= 0.0) return;
+
+    float low = samples[0];
+    float high = samples[0];
+    for (int i = 1; i < count; ++i) {
+        low = qMin(low, samples[i]);
+        high = qMax(high, samples[i]);
+    }
+    const float swing = high - low;
+    if (swing <= 1e-6f) return;
+
+    if (!m_scaled) {
+        m_low = low - 0.1f * swing;
+        m_high = high + 0.1f * swing;
+        m_scaled = true;
+    }
+
+    if (m_bitRate > 0.0) m_unitInterval = sampleRate / m_bitRate;
+    m_result.threshold = 0.5 * (low + high);
+    if (!recoverClock(samples, count, m_result.threshold, 0.1 * swing)) return;
+
+    const int points = m_interpolator.outputLength(count);
+    m_points.resize(points);
+    m_cells.resize(points);
+    const int n = m_interpolator.process(samples, count, 0, count, m_points.data());
+    fold(n);
+
+    updateResult(sampleRate);
+    render();
+}
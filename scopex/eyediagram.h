@@ -0,0 +1,94 @@
+#ifndef EYEDIAGRAM_H
+#define EYEDIAGRAM_H
+
+#include <QImage>
+#include <QColor>
+#include <QVector>
+#include "interpolator.h"
+
+// Eye diagram of a serial signal. Threshold crossings of the raw samples,
+// placed between samples by linear interpolation, give the bit clock phase
+// (and, without a given bit rate, the unit interval). The frame is then
+// upsampled and every point folded modulo one or two unit intervals into a
+// fixed 2D hit histogram. Only running sums are kept between frames, so the
+// state stays the same size however long the capture runs.
+class EyeDiagram
+{
+public:
+    struct Result {
+        bool valid = false;
+        double unitInterval = 0.0;     // Seconds
+        double bitRate = 0.0;          // Hz
+        double threshold = 0.0;        // Volts
+        double eyeAmplitude = 0.0;     // Mean one level minus mean zero level
+        double eyeHeight = 0.0;        // Inner 3 sigma opening, volts
+        double eyeWidth = 0.0;         // UI minus peak-to-peak jitter, seconds
+        double jitterRms = 0.0;        // Seconds
+        double jitterPeakToPeak = 0.0; // Seconds
+        quint64 crossings = 0;
+    };
+
+    EyeDiagram();
+
+    void configure(int columns, int rows);
+    void setUnitIntervals(int count);     // Width of the display, 1 or 2 UI
+    void setBitRate(double bitRate);      // 0 estimates it from transitions
+    void setUpsampling(int factor);
+    void setColor(const QColor &color);
+    void clear();
+
+    int columns() const { return m_columns; }
+    int rows() const { return m_rows; }
+    int unitIntervals() const { return m_unitIntervals; }
+    double bitRate() const { return m_bitRate; }
+
+    void addFrame(const float *samples, int count, double sampleRate);
+
+    // Metrics from everything accumulated since clear()
+    const Result &result() const { return m_result; }
+
+    // Histogram colour mapped on a log scale; valid after addFrame()
+    const QImage &image() const { return m_image; }
+
+private:
+    bool recoverClock(const float *samples, int count, double threshold, double hysteresis);
+    void fold(int count);
+    void updateResult(double sampleRate);
+    void render();
+
+    int m_columns;
+    int m_rows;
+    int m_unitIntervals;
+    double m_bitRate;
+
+    // Vertical scale, fitted to the first frame after clear()
+    bool m_scaled;
+    float m_low;
+    float m_high;
+
+    // Clock in input samples: unit interval and the phase of a crossing
+    double m_unitInterval;
+    double m_phase;
+
+    Interpolator m_interpolator;
+    QVector<float> m_points;
+    QVector<float> m_crossingTimes;
+    QVector<int> m_cells;        // Histogram index per point, -1 when off screen
+
+    QVector<quint32> m_hits;     // rows x columns, row 0 at the top
+    quint32 m_maxHits;
+
+    // Crossing offsets from the recovered clock, in UI
+    quint64 m_crossings;
+    double m_offsetSum;
+    double m_offsetSquares;
+    double m_offsetMin;
+    double m_offsetMax;
+
+    QColor m_color;
+    quint32 m_palette[256];
+    QImage m_image;
+    Result m_result;
+};
+
+#endif // EYEDIAGRAM_H
@@ -0,0 +1,123 @@
+#include "eyediagramview.h"
+#include "serialhandler.h"
+#include "imagetexture.h"
+#include <QSGSimpleTextureNode>
+
+EyeDiagramView::EyeDiagramView(QQuickItem *parent) : QQuickItem(parent),
+    m_channel(0),
+    m_color(255, 255, 0),
+    m_dirty(false)
+{
+    setFlag(ItemHasContents, true);
+}
+
+SerialHandler *EyeDiagramView::source() const
+{
+    return m_source;
+}
+
+void EyeDiagramView::setSource(SerialHandler *source)
+{
+    if (source == m_source) return;
+
+    disconnect(m_connection);
+    m_source = source;
+    if (m_source) {
+        m_connection = connect(m_source, &SerialHandler::frameReady, this, &EyeDiagramView::handleFrame);
+    }
+    emit sourceChanged();
+}
+
+void EyeDiagramView::setChannel(int channel)
+{
+    if (channel == m_channel) return;
+    m_channel = channel;
+    clear();
+    emit settingsChanged();
+}
+
+void EyeDiagramView::setBitRate(double bitRate)
+{
+    if (qFuzzyCompare(bitRate, this->bitRate())) return;
+    m_eye.setBitRate(bitRate);
+    redraw();
+    emit settingsChanged();
+    emit measurementsChanged();
+}
+
+void EyeDiagramView::setUnitIntervals(int count)
+{
+    if (count == unitIntervals()) return;
+    m_eye.setUnitIntervals(count);
+    redraw();
+    emit settingsChanged();
+    emit measurementsChanged();
+}
+
+void EyeDiagramView::setColor(const QColor &color)
+{
+    if (color == m_color) return;
+    m_color = color;
+    m_eye.setColor(color);
+    redraw();
+    emit settingsChanged();
+}
+
+QVariantMap EyeDiagramView::measurements() const
+{
+    const EyeDiagram::Result &result = m_eye.result();
+    QVariantMap map;
+    map["valid"] = result.valid;
+    map["bitRate"] = result.bitRate;
+    map["unitInterval"] = result.unitInterval;
+    map["threshold"] = result.threshold;
+    map["eyeAmplitude"] = result.eyeAmplitude;
+    map["eyeHeight"] = result.eyeHeight;
+    map["eyeWidth"] = result.eyeWidth;
+    map["jitterRms"] = result.jitterRms;
+    map["jitterPeakToPeak"] = result.jitterPeakToPeak;
+    map["crossings"] = result.crossings;
+    return map;
+}
+
+void EyeDiagramView::clear()
+{
+    m_eye.clear();
+    redraw();
+    emit measurementsChanged();
+}
+
+void EyeDiagramView::redraw()
+{
+    m_dirty = true;
+    update();
+}
+
+void EyeDiagramView::handleFrame(const VoltFrame &frame)
+{
+    if (!isVisible() || m_channel >= frame.channels()) return;
+
+    m_eye.addFrame(frame.channel(m_channel), frame.length(), frame.info.sampleRate);
+    redraw();
+    emit measurementsChanged();
+}
+
+QSGNode *EyeDiagramView::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
+{
+    QSGSimpleTextureNode *node = static_cast<QSGSimpleTextureNode *>(oldNode);
+    const QImage &image = m_eye.image();
+
+    if (!node) {
+        node = new QSGSimpleTextureNode;
+        node->setTexture(new ImageTexture(image));
+        node->setOwnsTexture(true);
+        node->setFiltering(QSGTexture::Linear);
+    } else if (m_dirty) {
+        static_cast<ImageTexture *>(node->texture())->updateRows(image, 0, image.height());
+        node->markDirty(QSGNode::DirtyMaterial);
+    }
+
+    m_dirty = false;
+    node->setRect(boundingRect());
+    return node;
+}
@@ -0,0 +1,66 @@
+#ifndef EYEDIAGRAMVIEW_H
+#define EYEDIAGRAMVIEW_H
+
+#include <QQuickItem>
+#include <QPointer>
+#include <QColor>
+#include <QVariantMap>
+#include "eyediagram.h"
+#include "scopeframe.h"
+
+class SerialHandler;
+Q_MOC_INCLUDE("serialhandler.h")
+
+// Eye diagram of one channel, accumulated over the frames of a continuous
+// capture and shown as a single texture. The metrics follow every frame.
+class EyeDiagramView : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(SerialHandler *source READ source WRITE setSource NOTIFY sourceChanged)
+    Q_PROPERTY(int channel READ channel WRITE setChannel NOTIFY settingsChanged)
+    Q_PROPERTY(double bitRate READ bitRate WRITE setBitRate NOTIFY settingsChanged)
+    Q_PROPERTY(int unitIntervals READ unitIntervals WRITE setUnitIntervals NOTIFY settingsChanged)
+    Q_PROPERTY(QColor color READ color WRITE setColor NOTIFY settingsChanged)
+    Q_PROPERTY(QVariantMap measurements READ measurements NOTIFY measurementsChanged)
+
+public:
+    explicit EyeDiagramView(QQuickItem *parent = nullptr);
+
+    SerialHandler *source() const;
+    void setSource(SerialHandler *source);
+
+    int channel() const { return m_channel; }
+    void setChannel(int channel);
+    double bitRate() const { return m_eye.bitRate(); }
+    void setBitRate(double bitRate);
+    int unitIntervals() const { return m_eye.unitIntervals(); }
+    void setUnitIntervals(int count);
+    QColor color() const { return m_color; }
+    void setColor(const QColor &color);
+    QVariantMap measurements() const;
+
+public slots:
+    void clear();
+
+signals:
+    void sourceChanged();
+    void settingsChanged();
+    void measurementsChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+
+private:
+    void handleFrame(const VoltFrame &frame);
+    void redraw();
+
+    QPointer<SerialHandler> m_source;
+    QMetaObject::Connection m_connection;
+
+    EyeDiagram m_eye;
+    int m_channel;
+    QColor m_color;
+    bool m_dirty;
+};
+
+#endif // EYEDIAGRAMVIEW_H
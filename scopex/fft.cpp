@@ -0,0 +1,156 @@
+#include "fft.h"
+#include <QtMath>
+
+FFT::FFT(int size) :
+    m_size(0)
+{
+    setSize(size);
+}
+
+int FFT::nextPowerOfTwo(int n)
+{
+    int p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+void FFT::setSize(int size)
+{
+    if (size == m_size) return;
+    Q_ASSERT(size == 0 || isPowerOfTwo(size));
+
+    m_size = size;
+    m_twiddles.resize(size / 2);
+    for (int k = 0; k < size / 2; ++k) {
+        const double angle = -2.0 * M_PI * k / size;
+        m_twiddles[k] = std::complex<float>(static_cast<float>(qCos(angle)),
+                                            static_cast<float>(qSin(angle)));
+    }
+
+    int bits = 0;
+    while ((1 << bits) < size) ++bits;
+    m_bitReverse.resize(size);
+    for (int i = 0; i < size; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) {
+            if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+        }
+        m_bitReverse[i] = r;
+    }
+}
+
+void FFT::transform(std::complex<float> *data, bool inverse) const
+{
+    const int n = m_size;
+    if (n < 2) return;
+
+    for (int i = 0; i < n; ++i) {
+        const int j = m_bitReverse[i];
+        if (j > i) std::swap(data[i], data[j]);
+    }
+
+    const std::complex<float> *twiddles = m_twiddles.constData();
+    for (int half = 1; half < n; half <<= 1) {
+        const int stride = n / (2 * half);
+        for (int start = 0; start < n; start += 2 * half) {
+            std::complex<float> *a = data + start;
+            std::complex<float> *b = a + half;
+            for (int k = 0; k < half; ++k) {
+                const std::complex<float> w = inverse ? std::conj(twiddles[k * stride])
+                                                      : twiddles[k * stride];
+                const std::complex<float> t = b[k] * w;
+                b[k] = a[k] - t;
+                a[k] += t;
+            }
+        }
+    }
+}
+
+RealFFT::RealFFT(int size) :
+    m_size(0)
+{
+    setSize(size);
+}
+
+void RealFFT::setSize(int size)
+{
+    if (size == m_size) return;
+    Q_ASSERT(size == 0 || (FFT::isPowerOfTwo(size) && size >= 4));
+
+    m_size = size;
+    m_half.setSize(size / 2);
+    m_work.resize(size / 2);
+    m_twiddles.resize(size / 2 + 1);
+    for (int k = 0; k <= size / 2; ++k) {
+        const double angle = -2.0 * M_PI * k / size;
+        m_twiddles[k] = std::complex<float>(static_cast<float>(qCos(angle)),
+                                            static_cast<float>(qSin(angle)));
+    }
+}
+
+void RealFFT::forward(const float *input, std::complex<float> *output)
+{
+    const int half = m_size / 2;
+    std::complex<float> *z = m_work.data();
+
+    // Even samples in the real part, odd samples in the imaginary part
+    for (int n = 0; n < half; ++n) {
+        z[n] = std::complex<float>(input[2 * n], input[2 * n + 1]);
+    }
+    m_half.transform(z);
+
+    // Split the packed spectrum back into the even and odd halves
+    const std::complex<float> minusHalfI(0.0f, -0.5f);
+    for (int k = 0; k <= half; ++k) {
+        const std::complex<float> zk = z[k % half];
+        const std::complex<float> zc = std::conj(z[(half - k) % half]);
+        const std::complex<float> even = 0.5f * (zk + zc);
+        const std::complex<float> odd = minusHalfI * (zk - zc);
+        output[k] = even + m_twiddles[k] * odd;
+    }
+}
+
+void RealFFT::inverse(const std::complex<float> *input, float *output)
+{
+    const int half = m_size / 2;
+    std::complex<float> *z = m_work.data();
+
+    const std::complex<float> i(0.0f, 1.0f);
+    for (int k = 0; k < half; ++k) {
+        const std::complex<float> xc = std::conj(input[half - k]);
+        const std::complex<float> even = 0.5f * (input[k] + xc);
+        const std::complex<float> odd = 0.5f * (input[k] - xc) * std::conj(m_twiddles[k]);
+        z[k] = even + i * odd;
+    }
+    m_half.transform(z, true);
+
+    const float scale = 1.0f / half;
+    for (int n = 0; n < half; ++n) {
+        output[2 * n] = z[n].real() * scale;
+        output[2 * n + 1] = z[n].imag() * scale;
+    }
+}
+
+double Window::fill(Type type, int size, QVector<float> &window)
+{
+    window.resize(size);
+    double sum = 0.0;
+    for (int n = 0; n < size; ++n) {
+        const double x = 2.0 * M_PI * n / size;
+        double w = 1.0;
+        switch (type) {
+        case Hann:
+            w = 0.5 - 0.5 * qCos(x);
+            break;
+        case BlackmanHarris:
+            w = 0.35875 - 0.48829 * qCos(x) + 0.14128 * qCos(2 * x) - 0.01168 * qCos(3 * x);
+            break;
+        case Rectangular:
+        default:
+            break;
+        }
+        window[n] = static_cast<float>(w);
+        sum += w;
+    }
+    return sum;
+}
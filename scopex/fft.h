@@ -0,0 +1,65 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <QVector>
+#include <complex>
+
+// Radix-2 FFT plans. Twiddles and the bit-reversal permutation are computed
+// once per size, so a plan can be reused for every frame without allocating.
+class FFT
+{
+public:
+    explicit FFT(int size = 0);
+
+    void setSize(int size);
+    int size() const { return m_size; }
+
+    static bool isPowerOfTwo(int n) { return n > 0 && (n & (n - 1)) == 0; }
+    static int nextPowerOfTwo(int n);
+
+    // In-place complex transform; the inverse is unscaled
+    void transform(std::complex<float> *data, bool inverse = false) const;
+
+private:
+    int m_size;
+    QVector<std::complex<float>> m_twiddles;  // exp(-2 pi i k / size), k < size / 2
+    QVector<int> m_bitReverse;
+};
+
+// Real-input FFT of `size` samples computed as a complex FFT of half the size.
+// Produces size / 2 + 1 bins, DC through Nyquist.
+class RealFFT
+{
+public:
+    explicit RealFFT(int size = 0);
+
+    void setSize(int size);
+    int size() const { return m_size; }
+    int bins() const { return m_size / 2 + 1; }
+
+    void forward(const float *input, std::complex<float> *output);
+
+    // Inverse of forward(); `input` holds bins() values and is left intact.
+    // The result is scaled so that inverse(forward(x)) == x.
+    void inverse(const std::complex<float> *input, float *output);
+
+private:
+    int m_size;
+    FFT m_half;
+    QVector<std::complex<float>> m_twiddles;  // exp(-2 pi i k / size), k <= size / 2
+    QVector<std::complex<float>> m_work;
+};
+
+namespace Window {
+enum Type {
+    Rectangular,
+    Hann,
+    BlackmanHarris  // 4-term, -92 dB sidelobes
+};
+
+// Fills `window` with `size` coefficients and returns their sum, the
+// coherent gain needed to turn bin magnitudes back into amplitudes
+double fill(Type type, int size, QVector<float> &window);
+}
+
+#endif // FFT_H
@@ -0,0 +1,35 @@
+#include "frameassembler.h"
+#include <cstring>
+
+FrameAssembler::FrameAssembler() :
+    m_channels(0),
+    m_channelBytes(0),
+    m_filled(0),
+    m_lastFeed(0)
+{
+}
+
+void FrameAssembler::configure(int channels, int channelBytes)
+{
+    m_channels = qMax(1, channels);
+    m_channelBytes = qMax(1, channelBytes);
+    m_frame.resize(qsizetype(m_channels) * m_channelBytes);
+    reset();
+}
+
+void FrameAssembler::reset()
+{
+    m_filled = 0;
+}
+
+int FrameAssembler::feed(const char *data, int size, qint64 timestamp)
+{
+    if (isComplete()) reset();
+    if (m_filled > 0 && timestamp - m_lastFeed > qint64(StaleTimeoutMs) * 1000000) reset();
+    m_lastFeed = timestamp;
+
+    const int used = qMin(size, int(m_frame.size()) - m_filled);
+    std::memcpy(m_frame.data() + m_filled, data, used);
+    m_filled += used;
+    return used;
+}
@@ -0,0 +1,43 @@
+#ifndef FRAMEASSEMBLER_H
+#define FRAMEASSEMBLER_H
+
+#include <QVector>
+
+// Collects serial reads into whole capture frames. A frame is `channels`
+// planar runs of `channelBytes` packed sample bytes (see SampleFormat);
+// reads may split or join frames at any byte. The buffer is sized in
+// configure() and reused, so deep records cost no allocation per frame.
+// There is no framing header, so a partial frame left waiting longer than
+// the stale timeout is dropped and the next read starts a new frame. Time
+// is whatever the caller stamps each read with, so a replayed journal ages
+// frames by its record times, not by how fast it is replayed.
+class FrameAssembler
+{
+public:
+    static constexpr int StaleTimeoutMs = 500;
+
+    FrameAssembler();
+
+    void configure(int channels, int channelBytes);
+    void reset();
+
+    // Copies up to the rest of the frame from `data`, which arrived at
+    // `timestamp` nanoseconds on the caller's clock; returns the bytes used
+    int feed(const char *data, int size, qint64 timestamp);
+
+    // No partial frame waiting for more bytes
+    bool isIdle() const { return m_filled == 0 || isComplete(); }
+    bool isComplete() const { return m_filled == m_frame.size(); }
+    int channels() const { return m_channels; }
+    int channelBytes() const { return m_channelBytes; }
+    const uchar *channel(int index) const { return m_frame.constData() + qsizetype(index) * m_channelBytes; }
+
+private:
+    int m_channels;
+    int m_channelBytes;
+    int m_filled;
+    QVector<uchar> m_frame;
+    qint64 m_lastFeed;
+};
+
+#endif // FRAMEASSEMBLER_H
@@ -0,0 +1,189 @@
+#ifndef FRAMEPOOL_H
+#define FRAMEPOOL_H
+
+#include <QMutex>
+#include <QVector>
+#include <atomic>
+
+// Recycled frames shared between consumers without copying. acquire()
+// hands out a Writer with exclusive, mutable access; publish() turns it into
+// a Handle, after which the frame is immutable. Handles are cheap to copy
+// and may be dropped on any thread; the frame goes back to the pool when
+// the last one is released. A slot keeps its storage while it is recycled,
+// so once every slot has seen the current frame size, steady-state capture
+// allocates nothing. The pool grows only when all its slots are in use.
+// Slots still held when the pool is destroyed are freed with their last
+// handle.
+template<typename Frame>
+class FramePool
+{
+    struct Core;
+    struct Slot {
+        Frame frame;
+        std::atomic<int> refs{0};
+        Core *core = nullptr;
+    };
+
+    struct Core {
+        QMutex mutex;
+        QVector<Slot *> free;   // Reserved to the pool size, so recycling never allocates
+        int size = 0;
+        int outstanding = 0;    // Slots out as writers or handles
+        bool orphaned = false;
+
+        void recycle(Slot *slot)
+        {
+            QMutexLocker locker(&mutex);
+            --outstanding;
+            if (!orphaned) {
+                free.append(slot);
+                return;
+            }
+            delete slot;
+            if (outstanding == 0) {
+                locker.unlock();
+                delete this;
+            }
+        }
+    };
+
+public:
+    class Handle
+    {
+    public:
+        Handle() = default;
+        Handle(const Handle &other) : m_slot(other.m_slot) { retain(); }
+        Handle(Handle &&other) noexcept : m_slot(other.m_slot) { other.m_slot = nullptr; }
+        ~Handle() { release(); }
+
+        Handle &operator=(const Handle &other)
+        {
+            if (m_slot != other.m_slot) {
+                release();
+                m_slot = other.m_slot;
+                retain();
+            }
+            return *this;
+        }
+
+        Handle &operator=(Handle &&other) noexcept
+        {
+            if (this != &other) {
+                release();
+                m_slot = other.m_slot;
+                other.m_slot = nullptr;
+            }
+            return *this;
+        }
+
+        bool isNull() const { return m_slot == nullptr; }
+        const Frame &operator*() const { return m_slot->frame; }
+        const Frame *operator->() const { return &m_slot->frame; }
+        int useCount() const { return m_slot ? m_slot->refs.load(std::memory_order_relaxed) : 0; }
+        void reset() { release(); }
+
+    private:
+        friend class FramePool;
+        explicit Handle(Slot *slot) : m_slot(slot) {}
+
+        void retain()
+        {
+            if (m_slot) m_slot->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void release()
+        {
+            if (m_slot && m_slot->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                m_slot->core->recycle(m_slot);
+            }
+            m_slot = nullptr;
+        }
+
+        Slot *m_slot = nullptr;
+    };
+
+    class Writer
+    {
+    public:
+        Writer(Writer &&other) noexcept : m_slot(other.m_slot) { other.m_slot = nullptr; }
+        Writer(const Writer &) = delete;
+        Writer &operator=(const Writer &) = delete;
+        ~Writer() { if (m_slot) m_slot->core->recycle(m_slot); }
+
+        Frame &operator*() { return m_slot->frame; }
+        Frame *operator->() { return &m_slot->frame; }
+
+    private:
+        friend class FramePool;
+        explicit Writer(Slot *slot) : m_slot(slot) {}
+        Slot *m_slot;
+    };
+
+    explicit FramePool(int reserve = 4) : m_core(new Core)
+    {
+        m_core->free.reserve(reserve);
+        for (int i = 0; i < reserve; ++i) {
+            Slot *slot = new Slot;
+            slot->core = m_core;
+            m_core->free.append(slot);
+        }
+        m_core->size = reserve;
+    }
+
+    ~FramePool()
+    {
+        QMutexLocker locker(&m_core->mutex);
+        m_core->orphaned = true;
+        qDeleteAll(m_core->free);
+        m_core->free.clear();
+        if (m_core->outstanding == 0) {
+            locker.unlock();
+            delete m_core;
+        }
+    }
+
+    FramePool(const FramePool &) = delete;
+    FramePool &operator=(const FramePool &) = delete;
+
+    Writer acquire()
+    {
+        QMutexLocker locker(&m_core->mutex);
+        Slot *slot = nullptr;
+        if (m_core->free.isEmpty()) {
+            slot = new Slot;
+            slot->core = m_core;
+            ++m_core->size;
+            m_core->free.reserve(m_core->size);
+        } else {
+            slot = m_core->free.takeLast();
+        }
+        ++m_core->outstanding;
+        slot->refs.store(1, std::memory_order_relaxed);
+        return Writer(slot);
+    }
+
+    // The frame becomes read-only; the writer is left empty
+    Handle publish(Writer &&writer)
+    {
+        Slot *slot = writer.m_slot;
+        writer.m_slot = nullptr;
+        return Handle(slot);
+    }
+
+    int size() const
+    {
+        QMutexLocker locker(&m_core->mutex);
+        return m_core->size;
+    }
+
+    int available() const
+    {
+        QMutexLocker locker(&m_core->mutex);
+        return int(m_core->free.size());
+    }
+
+private:
+    Core *m_core;
+};
+
+#endif // FRAMEPOOL_H
@@ -0,0 +1,95 @@
+#include "imagetexture.h"
+#include <rhi/qrhi.h>
+#include <cstring>
+
+ImageTexture::ImageTexture(const QImage &image) :
+    m_staging(image.copy()),
+    m_texture(nullptr),
+    m_fullUpload(true)
+{
+}
+
+ImageTexture::~ImageTexture()
+{
+    if (m_texture) m_texture->deleteLater();
+}
+
+void ImageTexture::updateRows(const QImage &image, int head, int count)
+{
+    const int rows = m_staging.height();
+    count = qMin(count, rows);
+    if (count <= 0) return;
+
+    // The new rows end just before head and may wrap past row 0
+    const int first = (head - count + rows) % rows;
+    const int tail = qMin(count, rows - first);
+    const qsizetype bytes = m_staging.bytesPerLine();
+    for (int i = 0; i < count; ++i) {
+        const int row = (first + i) % rows;
+        std::memcpy(m_staging.scanLine(row), image.constScanLine(row), bytes);
+    }
+
+    m_dirtyRows.append(qMakePair(first, tail));
+    if (tail < count) m_dirtyRows.append(qMakePair(0, count - tail));
+}
+
+qint64 ImageTexture::comparisonKey() const
+{
+    return qint64(quintptr(this));
+}
+
+QRhiTexture *ImageTexture::rhiTexture() const
+{
+    return m_texture;
+}
+
+QSize ImageTexture::textureSize() const
+{
+    return m_staging.size();
+}
+
+bool ImageTexture::hasAlphaChannel() const
+{
+    return false;
+}
+
+bool ImageTexture::hasMipmaps() const
+{
+    return false;
+}
+
+bool ImageTexture::updateTexture()
+{
+    return m_fullUpload || !m_dirtyRows.isEmpty();
+}
+
+void ImageTexture::commitTextureOperations(QRhi *rhi, QRhiResourceUpdateBatch *resourceUpdates)
+{
+    if (!m_texture) {
+        m_texture = rhi->newTexture(QRhiTexture::RGBA8, m_staging.size());
+        if (!m_texture->create()) {
+            delete m_texture;
+            m_texture = nullptr;
+            return;
+        }
+        m_fullUpload = true;
+    }
+
+    if (m_fullUpload) {
+        resourceUpdates->uploadTexture(m_texture, m_staging);
+        m_fullUpload = false;
+        m_dirtyRows.clear();
+        return;
+    }
+
+    // Only the rows written since the previous frame travel to the GPU
+    for (const QPair<int, int> &range : std::as_const(m_dirtyRows)) {
+        QRhiTextureSubresourceUploadDescription description(m_staging);
+        description.setSourceTopLeft(QPoint(0, range.first));
+        description.setSourceSize(QSize(m_staging.width(), range.second));
+        description.setDestinationTopLeft(QPoint(0, range.first));
+        resourceUpdates->uploadTexture(m_texture,
+                                       QRhiTextureUploadDescription(QRhiTextureUploadEntry(0, 0, description)));
+    }
+    m_dirtyRows.clear();
+}
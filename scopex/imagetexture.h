@@ -0,0 +1,42 @@
+#ifndef IMAGETEXTURE_H
+#define IMAGETEXTURE_H
+
+#include <QSGTexture>
+#include <QImage>
+#include <QVector>
+#include <QPair>
+
+class QRhiTexture;
+
+// Scene graph texture backed by an image that is rewritten in place. Only
+// the rows written since the last frame are uploaded; the texture itself is
+// created once per size. The waterfall writes it as a ring; the XY and eye
+// views mark every row dirty.
+class ImageTexture : public QSGDynamicTexture
+{
+    Q_OBJECT
+
+public:
+    explicit ImageTexture(const QImage &image);
+    ~ImageTexture() override;
+
+    // Copies `count` rows ending just before `head` (wrapping) into the
+    // staging image and queues them for upload. Called during sync.
+    void updateRows(const QImage &image, int head, int count);
+
+    qint64 comparisonKey() const override;
+    QRhiTexture *rhiTexture() const override;
+    QSize textureSize() const override;
+    bool hasAlphaChannel() const override;
+    bool hasMipmaps() const override;
+    bool updateTexture() override;
+    void commitTextureOperations(QRhi *rhi, QRhiResourceUpdateBatch *resourceUpdates) override;
+
+private:
+    QImage m_staging;
+    QRhiTexture *m_texture;
+    bool m_fullUpload;
+    QVector<QPair<int, int>> m_dirtyRows;  // First row, row count
+};
+
+#endif // IMAGETEXTURE_H
@@ -0,0 +1,104 @@
+#include "interpolator.h"
+#include <QtMath>
+
+namespace {
+constexpr int HalfTaps = Interpolator::TapCount / 2;
+
+double windowedSinc(double x)
+{
+    if (qAbs(x) >= HalfTaps) return 0.0;
+    const double sinc = qFuzzyIsNull(x) ? 1.0 : qSin(M_PI * x) / (M_PI * x);
+    // Blackman window spanning the full kernel
+    const double w = 0.42 + 0.5 * qCos(M_PI * x / HalfTaps)
+                     + 0.08 * qCos(2 * M_PI * x / HalfTaps);
+    return sinc * w;
+}
+}
+
+Interpolator::Interpolator() :
+    m_mode(LinearInterpolation),
+    m_factor(8)
+{
+    buildKernel();
+}
+
+void Interpolator::setMode(Mode mode)
+{
+    m_mode = mode;
+}
+
+void Interpolator::setFactor(int factor)
+{
+    factor = qBound(MinFactor, factor, MaxFactor);
+    if (factor == m_factor) return;
+
+    m_factor = factor;
+    buildKernel();
+}
+
+void Interpolator::buildKernel()
+{
+    // Phase p evaluates the signal p / factor samples after the tap centre.
+    // Each branch is normalised to unity DC gain so flat inputs stay flat.
+    m_kernel.resize(m_factor * TapCount);
+    for (int p = 0; p < m_factor; ++p) {
+        const double frac = static_cast<double>(p) / m_factor;
+        double sum = 0.0;
+        for (int t = 0; t < TapCount; ++t) {
+            sum += windowedSinc(t - (HalfTaps - 1) - frac);
+        }
+        for (int t = 0; t < TapCount; ++t) {
+            m_kernel[p * TapCount + t] =
+                static_cast<float>(windowedSinc(t - (HalfTaps - 1) - frac) / sum);
+        }
+    }
+}
+
+int Interpolator::outputLength(int count) const
+{
+    if (m_mode == LinearInterpolation || count < 2) return count;
+    return (count - 1) * m_factor + 1;
+}
+
+double Interpolator::outputStep() const
+{
+    return m_mode == LinearInterpolation ? 1.0 : 1.0 / m_factor;
+}
+
+int Interpolator::process(const float *in, int count, int first, int last, float *out)
+{
+    first = qBound(0, first, count);
+    last = qBound(first, last, count);
+    const int n = last - first;
+
+    if (m_mode == LinearInterpolation || n < 2) {
+        std::copy(in + first, in + last, out);
+        return n;
+    }
+
+    // Copy the window with HalfTaps samples of context on each side so the
+    // convolution below never has to check bounds; record edges are held.
+    const int paddedCount = n + TapCount;
+    if (m_padded.size() < paddedCount) m_padded.resize(paddedCount);
+    float *padded = m_padded.data();
+    for (int i = 0; i < paddedCount; ++i) {
+        padded[i] = in[qBound(0, first + i - (HalfTaps - 1), count - 1)];
+    }
+
+    const float *kernel = m_kernel.constData();
+    float *dst = out;
+    for (int m = 0; m < n - 1; ++m) {
+        const float *src = padded + m;
+        for (int p = 0; p < m_factor; ++p) {
+            const float *coeff = kernel + p * TapCount;
+            float acc = 0.0f;
+            for (int t = 0; t < TapCount; ++t) {
+                acc += src[t] * coeff[t];
+            }
+            *dst++ = acc;
+        }
+    }
+    *dst++ = in[last - 1];
+
+    return static_cast<int>(dst - out);
+}
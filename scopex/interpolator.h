@@ -0,0 +1,51 @@
+#ifndef INTERPOLATOR_H
+#define INTERPOLATOR_H
+
+#include <QVector>
+
+// Display-side reconstruction of sparse records. In SincInterpolation mode the
+// visible part of a frame is upsampled with a precomputed polyphase
+// windowed-sinc kernel; LinearInterpolation passes the samples straight
+// through and leaves the straight segments to the chart.
+class Interpolator
+{
+public:
+    enum Mode {
+        LinearInterpolation = 0,
+        SincInterpolation = 1
+    };
+
+    static constexpr int MinFactor = 4;
+    static constexpr int MaxFactor = 16;
+    static constexpr int TapCount = 16;  // Taps per polyphase branch
+
+    Interpolator();
+
+    Mode mode() const { return m_mode; }
+    void setMode(Mode mode);
+
+    int factor() const { return m_factor; }
+    void setFactor(int factor);
+
+    // Number of output points produced for `count` visible input samples.
+    int outputLength(int count) const;
+
+    // Reconstructs samples [first, last) of `in` (length `count`) into `out`,
+    // which must hold outputLength(last - first) values. Output point j sits
+    // at sample position first + j / outputStep(). Samples outside the window
+    // are only read as filter context. Returns the number of points written.
+    int process(const float *in, int count, int first, int last, float *out);
+
+    // Spacing between output points in units of input samples.
+    double outputStep() const;
+
+private:
+    void buildKernel();
+
+    Mode m_mode;
+    int m_factor;
+    QVector<float> m_kernel;   // m_factor phases x TapCount coefficients
+    QVector<float> m_padded;   // Window plus filter context, reused per call
+};
+
+#endif // INTERPOLATOR_H
@@ -0,0 +1,150 @@
+#include "journal.h"
+#include <cstring>
+
+namespace {
+const char JournalMagic[8] = { 'S', 'C', 'P', 'X', 'J', 'R', 'N', '1' };
+
+void appendVarint(QByteArray &out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+bool readVarint(const uchar *data, qint64 size, qint64 &position, quint64 *value)
+{
+    quint64 result = 0;
+    for (int shift = 0; shift < 64 && position < size; shift += 7) {
+        const uchar byte = data[position++];
+        result |= quint64(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+}
+
+SerialJournal::SerialJournal() :
+    m_last(0),
+    m_records(0)
+{
+}
+
+SerialJournal::~SerialJournal()
+{
+    close();
+}
+
+bool SerialJournal::open(const QString &path, QString *error)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+        || m_file.write(JournalMagic, sizeof(JournalMagic)) != sizeof(JournalMagic)) {
+        if (error) *error = m_file.errorString();
+        m_file.close();
+        return false;
+    }
+
+    m_clock.start();
+    m_last = 0;
+    m_records = 0;
+    return true;
+}
+
+void SerialJournal::append(Direction direction, const QByteArray &data)
+{
+    if (!isOpen()) return;
+
+    const qint64 now = m_clock.nsecsElapsed();
+    m_buffer.clear();
+    appendVarint(m_buffer, (quint64(now - m_last) << 1) | direction);
+    appendVarint(m_buffer, data.size());
+    m_file.write(m_buffer);
+    m_file.write(data);
+    m_last = now;
+    ++m_records;
+}
+
+void SerialJournal::close()
+{
+    if (isOpen()) m_file.close();
+}
+
+JournalReader::JournalReader() :
+    m_data(nullptr),
+    m_size(0),
+    m_position(0),
+    m_timestamp(0)
+{
+}
+
+JournalReader::~JournalReader()
+{
+    close();
+}
+
+bool JournalReader::open(const QString &path, QString *error)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (error) *error = m_file.errorString();
+        return false;
+    }
+
+    m_size = m_file.size();
+    m_data = m_size >= qint64(sizeof(JournalMagic)) ? m_file.map(0, m_size) : nullptr;
+    if (!m_data || std::memcmp(m_data, JournalMagic, sizeof(JournalMagic)) != 0) {
+        if (error) *error = QStringLiteral("not a ScopeX serial journal");
+        close();
+        return false;
+    }
+
+    rewind();
+    return true;
+}
+
+void JournalReader::close()
+{
+    if (m_data) {
+        m_file.unmap(const_cast<uchar *>(m_data));
+        m_data = nullptr;
+    }
+    if (m_file.isOpen()) m_file.close();
+    m_size = 0;
+    m_position = 0;
+}
+
+void JournalReader::rewind()
+{
+    m_position = sizeof(JournalMagic);
+    m_timestamp = 0;
+}
+
+bool JournalReader::next(Record *record)
+{
+    if (!m_data) return false;
+
+    qint64 position = m_position;
+    quint64 stamp = 0;
+    quint64 length = 0;
+    if (!readVarint(m_data, m_size, position, &stamp) || !readVarint(m_data, m_size, position, &length)
+        || length > quint64(m_size - position)) {
+        return false;
+    }
+
+    m_timestamp += qint64(stamp >> 1);
+    record->timestamp = m_timestamp;
+    record->direction = static_cast<SerialJournal::Direction>(stamp & 1);
+    record->data = reinterpret_cast<const char *>(m_data + position);
+    record->size = static_cast<int>(length);
+    m_position = position + qint64(length);
+    return true;
+}
@@ -0,0 +1,78 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <QFile>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+
+// Append-only log of the raw serial traffic. After an 8 byte magic, each
+// record is
+//   varint  (nanoseconds since the previous record << 1) | direction
+//   varint  payload length
+//   bytes   payload
+// so a busy stream costs a few bytes per read on top of the data itself.
+// Timestamps come from the monotonic clock.
+class SerialJournal
+{
+public:
+    enum Direction {
+        Received = 0,   // Bytes delivered by readyRead
+        Sent = 1        // Commands written to the port
+    };
+
+    SerialJournal();
+    ~SerialJournal();
+
+    bool open(const QString &path, QString *error = nullptr);
+    void append(Direction direction, const QByteArray &data);
+    void close();
+
+    bool isOpen() const { return m_file.isOpen(); }
+    QString path() const { return m_file.fileName(); }
+    quint64 records() const { return m_records; }
+
+private:
+    QFile m_file;
+    QElapsedTimer m_clock;
+    qint64 m_last;
+    quint64 m_records;
+    QByteArray m_buffer;
+};
+
+// Sequential reader over a memory-mapped journal. Payloads point into the
+// map, so they stay valid until the journal is closed.
+class JournalReader
+{
+public:
+    struct Record {
+        qint64 timestamp;   // Nanoseconds since the first record
+        SerialJournal::Direction direction;
+        const char *data;
+        int size;
+    };
+
+    JournalReader();
+    ~JournalReader();
+
+    bool open(const QString &path, QString *error = nullptr);
+    void close();
+    void rewind();
+
+    bool isOpen() const { return m_data != nullptr; }
+    QString path() const { return m_file.fileName(); }
+    qint64 size() const { return m_size; }
+    qint64 position() const { return m_position; }
+
+    // False at the end of the journal or at a record cut short
+    bool next(Record *record);
+
+private:
+    QFile m_file;
+    const uchar *m_data;
+    qint64 m_size;
+    qint64 m_position;
+    qint64 m_timestamp;
+};
+
+#endif // JOURNAL_H
@@ -2,6 +2,11 @@
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
 #include "serialhandler.h"
+#include "waterfallview.h"
+#include "xyview.h"
+#include "eyediagramview.h"
+#include "tracesource.h"
+#include "rollview.h"
 
 int main(int argc, char *argv[])
 {
@@ -9,6 +14,11 @@ int main(int argc, char *argv[])
 
     // Register the C++ type with QML
     qmlRegisterType<SerialHandler>("ScopeX", 1, 0, "SerialHandler");
+    qmlRegisterType<WaterfallView>("ScopeX", 1, 0, "WaterfallView");
+    qmlRegisterType<XYView>("ScopeX", 1, 0, "XYView");
+    qmlRegisterType<EyeDiagramView>("ScopeX", 1, 0, "EyeDiagramView");
+    qmlRegisterType<TraceSource>("ScopeX", 1, 0, "TraceSource");
+    qmlRegisterType<RollView>("ScopeX", 1, 0, "RollView");
 
     QQmlApplicationEngine engine;
 
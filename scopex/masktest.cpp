@@ -0,0 +1,193 @@
+#include "masktest.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QtMath>
+#include <limits>
+
+MaskTest::MaskTest() :
+    m_tested(0),
+    m_failed(0),
+    m_lastViolations(0)
+{
+}
+
+void MaskTest::clear()
+{
+    m_upper.clear();
+    m_lower.clear();
+    resetCounters();
+}
+
+void MaskTest::resetCounters()
+{
+    m_tested = 0;
+    m_failed = 0;
+    m_lastViolations = 0;
+}
+
+void MaskTest::unbounded(int count)
+{
+    m_upper.fill(std::numeric_limits<float>::infinity(), count);
+    m_lower.fill(-std::numeric_limits<float>::infinity(), count);
+}
+
+void MaskTest::setReference(const float *reference, int count, float tolerance, int horizontal)
+{
+    unbounded(count);
+    horizontal = qMax(0, horizontal);
+
+    // Envelope of the reference over the horizontal window, then the margin
+    for (int i = 0; i < count; ++i) {
+        float high = reference[i];
+        float low = reference[i];
+        for (int j = qMax(0, i - horizontal); j <= qMin(count - 1, i + horizontal); ++j) {
+            high = qMax(high, reference[j]);
+            low = qMin(low, reference[j]);
+        }
+        m_upper[i] = high + tolerance;
+        m_lower[i] = low - tolerance;
+    }
+    resetCounters();
+}
+
+void MaskTest::setPolygons(const QVector<QVector<QPointF>> &polygons, int count, double split)
+{
+    unbounded(count);
+
+    for (const QVector<QPointF> &polygon : polygons) {
+        const int points = polygon.size();
+        if (points < 3) continue;
+
+        double left = polygon[0].x(), right = left;
+        double low = polygon[0].y(), high = low;
+        for (const QPointF &point : polygon) {
+            left = qMin(left, point.x());
+            right = qMax(right, point.x());
+            low = qMin(low, point.y());
+            high = qMax(high, point.y());
+        }
+        const bool above = (low + high) / 2 > split;
+        const int first = qMax(0, qCeil(left));
+        const int last = qMin(count - 1, qFloor(right));
+
+        // Vertical extent of the polygon at each column it covers, from
+        // where the column crosses its edges
+        for (int column = first; column <= last; ++column) {
+            double top = -std::numeric_limits<double>::infinity();
+            double bottom = std::numeric_limits<double>::infinity();
+            for (int e = 0; e < points; ++e) {
+                const QPointF a = polygon[e];
+                const QPointF b = polygon[(e + 1) % points];
+                if (column < qMin(a.x(), b.x()) || column > qMax(a.x(), b.x())) continue;
+                if (a.x() == b.x()) {
+                    top = qMax(top, qMax(a.y(), b.y()));
+                    bottom = qMin(bottom, qMin(a.y(), b.y()));
+                } else {
+                    const double y = a.y() + (b.y() - a.y()) * (column - a.x()) / (b.x() - a.x());
+                    top = qMax(top, y);
+                    bottom = qMin(bottom, y);
+                }
+            }
+            if (bottom > top) continue;
+
+            if (above) {
+                m_upper[column] = qMin(m_upper[column], static_cast<float>(bottom));
+            } else {
+                m_lower[column] = qMax(m_lower[column], static_cast<float>(top));
+            }
+        }
+    }
+    resetCounters();
+}
+
+bool MaskTest::load(const QString &path, int count, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (doc.isNull()) {
+        if (error) *error = parseError.errorString();
+        return false;
+    }
+
+    const QJsonObject root = doc.object();
+    if (root.contains("polygons")) {
+        QVector<QVector<QPointF>> polygons;
+        for (const QJsonValue &value : root.value("polygons").toArray()) {
+            QVector<QPointF> polygon;
+            for (const QJsonValue &point : value.toArray()) {
+                const QJsonArray xy = point.toArray();
+                polygon.append(QPointF(xy[0].toDouble(), xy[1].toDouble()));
+            }
+            polygons.append(polygon);
+        }
+        setPolygons(polygons, count, root.value("split").toDouble(0.0));
+        return true;
+    }
+
+    const QJsonArray upper = root.value("upper").toArray();
+    const QJsonArray lower = root.value("lower").toArray();
+    if (upper.isEmpty() || upper.size() != lower.size()) {
+        if (error) *error = QStringLiteral("expected polygons or matching upper and lower tables");
+        return false;
+    }
+
+    // Null entries in a saved table stand for an open column
+    unbounded(upper.size());
+    for (int i = 0; i < upper.size(); ++i) {
+        if (upper[i].isDouble()) m_upper[i] = static_cast<float>(upper[i].toDouble());
+        if (lower[i].isDouble()) m_lower[i] = static_cast<float>(lower[i].toDouble());
+    }
+    resetCounters();
+    return true;
+}
+
+bool MaskTest::save(const QString &path, QString *error) const
+{
+    QJsonArray upper;
+    QJsonArray lower;
+    for (int i = 0; i < m_upper.size(); ++i) {
+        upper.append(qIsFinite(m_upper[i]) ? QJsonValue(m_upper[i]) : QJsonValue());
+        lower.append(qIsFinite(m_lower[i]) ? QJsonValue(m_lower[i]) : QJsonValue());
+    }
+
+    QJsonObject root;
+    root["version"] = 1;
+    root["upper"] = upper;
+    root["lower"] = lower;
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson());
+    return true;
+}
+
+bool MaskTest::test(const float *volts, int count)
+{
+    if (isEmpty()) return true;
+
+    // Branch-free compare against the bound tables; samples past the end
+    // of the mask are not tested
+    const int n = qMin(count, m_upper.size());
+    const float *upper = m_upper.constData();
+    const float *lower = m_lower.constData();
+    int violations = 0;
+    for (int i = 0; i < n; ++i) {
+        violations += (volts[i] > upper[i]) | (volts[i] < lower[i]);
+    }
+
+    m_lastViolations = violations;
+    ++m_tested;
+    if (violations > 0) ++m_failed;
+    return violations == 0;
+}
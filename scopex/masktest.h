@@ -0,0 +1,57 @@
+#ifndef MASKTEST_H
+#define MASKTEST_H
+
+#include <QVector>
+#include <QPointF>
+#include <QString>
+
+// Go/no-go mask for one channel. Whatever the mask was built from, a
+// tolerance band around a reference or forbidden polygons, it is reduced to
+// an upper and a lower bound per sample, so testing a frame is one compare
+// pair per sample. Columns without a bound are set to +/- infinity.
+class MaskTest
+{
+public:
+    MaskTest();
+
+    void clear();
+    bool isEmpty() const { return m_upper.isEmpty(); }
+    int length() const { return m_upper.size(); }
+
+    // Band of +/- tolerance volts around the reference, widened by
+    // `horizontal` samples either side to allow for timing shifts
+    void setReference(const float *reference, int count, float tolerance, int horizontal);
+
+    // Polygons in (sample index, volts), as closed point lists so the mask
+    // needs nothing beyond QtCore. One lying above `split` volts at a
+    // column lowers the upper bound there, one below raises the lower bound.
+    void setPolygons(const QVector<QVector<QPointF>> &polygons, int count, double split = 0.0);
+
+    // JSON with either "upper"/"lower" tables or a "polygons" array
+    bool load(const QString &path, int count, QString *error = nullptr);
+    bool save(const QString &path, QString *error = nullptr) const;
+
+    const QVector<float> &upper() const { return m_upper; }
+    const QVector<float> &lower() const { return m_lower; }
+
+    // Tests one frame and updates the counters; true when it passes
+    bool test(const float *volts, int count);
+    void resetCounters();
+
+    quint64 tested() const { return m_tested; }
+    quint64 failed() const { return m_failed; }
+    double failureRate() const { return m_tested ? double(m_failed) / m_tested : 0.0; }
+    int lastViolations() const { return m_lastViolations; }  // Samples outside the mask
+
+private:
+    void unbounded(int count);
+
+    QVector<float> m_upper;
+    QVector<float> m_lower;
+
+    quint64 m_tested;
+    quint64 m_failed;
+    int m_lastViolations;
+};
+
+#endif // MASKTEST_H
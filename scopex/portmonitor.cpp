@@ -0,0 +1,56 @@
+#include "portmonitor.h"
+#include <QSerialPortInfo>
+#include <QDir>
+#include <QtConcurrent>
+
+PortMonitor::PortMonitor(QObject *parent) : QObject(parent),
+    m_pending(false)
+{
+    connect(&m_scan, &QFutureWatcher<QStringList>::finished, this, &PortMonitor::finishScan);
+
+    m_settle.setSingleShot(true);
+    connect(&m_settle, &QTimer::timeout, this, &PortMonitor::refresh);
+
+    if (QDir(QStringLiteral("/dev")).exists() && m_devices.addPath(QStringLiteral("/dev"))) {
+        // udev adds a node and then its symlinks; scan once it has settled
+        connect(&m_devices, &QFileSystemWatcher::directoryChanged, this, [this]() {
+            m_settle.start(SettleDelay);
+        });
+    } else {
+        m_settle.setSingleShot(false);
+        m_settle.start(PollInterval);
+    }
+
+    refresh();
+}
+
+PortMonitor::~PortMonitor()
+{
+    m_scan.waitForFinished();
+}
+
+void PortMonitor::refresh()
+{
+    if (m_scan.isRunning()) {
+        m_pending = true;
+        return;
+    }
+    m_pending = false;
+    m_scan.setFuture(QtConcurrent::run([]() {
+        QStringList ports;
+        const QList<QSerialPortInfo> infos = QSerialPortInfo::availablePorts();
+        for (const QSerialPortInfo &info : infos) ports.append(info.portName());
+        ports.sort();
+        return ports;
+    }));
+}
+
+void PortMonitor::finishScan()
+{
+    const QStringList ports = m_scan.result();
+    if (ports != m_ports) {
+        m_ports = ports;
+        emit portsChanged();
+    }
+    if (m_pending) refresh();
+}
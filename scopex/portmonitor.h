@@ -0,0 +1,47 @@
+#ifndef PORTMONITOR_H
+#define PORTMONITOR_H
+
+#include <QObject>
+#include <QStringList>
+#include <QFutureWatcher>
+#include <QFileSystemWatcher>
+#include <QTimer>
+
+// Cached list of serial ports. Enumeration scans sysfs (or the registry),
+// so it runs on a worker thread and ports() only returns the last result.
+// Where the platform has a /dev directory it is watched for device nodes
+// coming and going, which covers udev hotplug without linking libudev;
+// elsewhere the list is re-scanned every PollInterval. Bursts of changes
+// are coalesced, and portsChanged() is only emitted when the list differs.
+class PortMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int SettleDelay = 250;     // ms after a /dev change before scanning
+    static constexpr int PollInterval = 3000;   // ms, without a /dev to watch
+
+    explicit PortMonitor(QObject *parent = nullptr);
+    ~PortMonitor();
+
+    QStringList ports() const { return m_ports; }
+    bool scanning() const { return m_scan.isRunning(); }
+
+public slots:
+    // Re-scans in the background; a request during a scan queues one more
+    void refresh();
+
+signals:
+    void portsChanged();
+
+private:
+    void finishScan();
+
+    QStringList m_ports;
+    QFutureWatcher<QStringList> m_scan;
+    QFileSystemWatcher m_devices;
+    QTimer m_settle;
+    bool m_pending;
+};
+
+#endif // PORTMONITOR_H
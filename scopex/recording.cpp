@@ -0,0 +1,146 @@
+#include "recording.h"
+#include <cstddef>
+#include <cstring>
+
+namespace {
+const char RecordingMagic[8] = { 'S', 'C', 'P', 'X', 'R', 'E', 'C', '1' };
+}
+
+RecordingWriter::RecordingWriter()
+{
+    std::memset(&m_header, 0, sizeof(m_header));
+}
+
+RecordingWriter::~RecordingWriter()
+{
+    close();
+}
+
+bool RecordingWriter::open(const QString &path, int recordLength, double sampleRate,
+                           const Calibration &calibration, QString *error)
+{
+    close();
+
+    std::memset(&m_header, 0, sizeof(m_header));
+    std::memcpy(m_header.magic, RecordingMagic, sizeof(RecordingMagic));
+    m_header.version = 1;
+    m_header.headerSize = sizeof(RecordingHeader);
+    m_header.channels = Calibration::Channels;
+    m_header.recordLength = recordLength;
+    m_header.sampleBits = 8;
+    m_header.sampleRate = sampleRate;
+    for (int c = 0; c < Calibration::Channels; ++c) {
+        for (int code = 0; code < Calibration::CodeCount; ++code) {
+            m_header.volts[c][code] = calibration.volts(c, static_cast<quint8>(code));
+        }
+    }
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = m_file.errorString();
+        return false;
+    }
+    if (m_file.write(reinterpret_cast<const char *>(&m_header), sizeof(m_header)) != sizeof(m_header)) {
+        if (error) *error = m_file.errorString();
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+bool RecordingWriter::writeFrame(const CodeFrame &frame)
+{
+    if (!isOpen() || frame.channels() != int(m_header.channels)
+        || frame.length() != int(m_header.recordLength)) {
+        return false;
+    }
+
+    // Channel arrays are already planar, so each is one write
+    const qint64 length = m_header.recordLength;
+    for (int c = 0; c < frame.channels(); ++c) {
+        if (m_file.write(reinterpret_cast<const char *>(frame.channel(c)), length) != length) return false;
+    }
+    ++m_header.frameCount;
+    return true;
+}
+
+void RecordingWriter::close()
+{
+    if (!isOpen()) return;
+
+    // Only the frame count changes after the header is first written
+    m_file.seek(offsetof(RecordingHeader, frameCount));
+    m_file.write(reinterpret_cast<const char *>(&m_header.frameCount), sizeof(m_header.frameCount));
+    m_file.close();
+}
+
+bool RecordingWriter::matches(double sampleRate, const Calibration &calibration) const
+{
+    if (m_header.sampleRate != sampleRate) return false;
+    for (int c = 0; c < Calibration::Channels; ++c) {
+        for (int code = 0; code < Calibration::CodeCount; ++code) {
+            if (m_header.volts[c][code] != calibration.volts(c, static_cast<quint8>(code))) return false;
+        }
+    }
+    return true;
+}
+
+RecordingReader::RecordingReader() :
+    m_data(nullptr),
+    m_frameCount(0)
+{
+    std::memset(&m_header, 0, sizeof(m_header));
+}
+
+RecordingReader::~RecordingReader()
+{
+    close();
+}
+
+bool RecordingReader::open(const QString &path, QString *error)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (error) *error = m_file.errorString();
+        return false;
+    }
+
+    if (m_file.read(reinterpret_cast<char *>(&m_header), sizeof(m_header)) != sizeof(m_header)
+        || std::memcmp(m_header.magic, RecordingMagic, sizeof(RecordingMagic)) != 0
+        || m_header.version != 1 || m_header.sampleBits != 8
+        || m_header.channels != Calibration::Channels || m_header.recordLength == 0) {
+        if (error) *error = QStringLiteral("not a ScopeX recording");
+        m_file.close();
+        return false;
+    }
+
+    // The file size decides how many frames there are, so a recording cut
+    // short by a crash still opens up to its last complete frame
+    const qint64 frameBytes = qint64(m_header.channels) * m_header.recordLength;
+    m_frameCount = (m_file.size() - m_header.headerSize) / frameBytes;
+    if (m_frameCount == 0) {
+        if (error) *error = QStringLiteral("recording holds no frames");
+        m_file.close();
+        return false;
+    }
+
+    m_data = m_file.map(0, m_header.headerSize + m_frameCount * frameBytes);
+    if (!m_data) {
+        if (error) *error = m_file.errorString();
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+void RecordingReader::close()
+{
+    if (m_data) {
+        m_file.unmap(const_cast<uchar *>(m_data));
+        m_data = nullptr;
+    }
+    if (m_file.isOpen()) m_file.close();
+    m_frameCount = 0;
+}
@@ -0,0 +1,94 @@
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <QFile>
+#include <QString>
+#include "calibration.h"
+#include "scopeframe.h"
+
+// On-disk capture: a fixed header followed by frames of raw ADC codes, each
+// frame planar (all of CH1, then all of CH2). Codes are stored untouched and
+// the header carries the code-to-volts tables in effect when recording
+// started, so a recording converts the same way on any machine. Frames are
+// all recordLength samples, so any sample can be reached without an index.
+struct RecordingHeader
+{
+    char magic[8];          // "SCPXREC1"
+    quint32 version;
+    quint32 headerSize;     // Offset of the first frame
+    quint32 channels;
+    quint32 recordLength;   // Samples per channel per frame
+    quint32 sampleBits;
+    quint32 reserved;
+    double sampleRate;      // Hz
+    quint64 frameCount;     // Written on close; readers trust the file size
+    float volts[Calibration::Channels][Calibration::CodeCount];
+};
+
+class RecordingWriter
+{
+public:
+    RecordingWriter();
+    ~RecordingWriter();
+
+    bool open(const QString &path, int recordLength, double sampleRate,
+              const Calibration &calibration, QString *error = nullptr);
+    bool writeFrame(const CodeFrame &frame);
+    void close();
+    // Whether frames taken at this rate and calibration convert with the
+    // header written at open
+    bool matches(double sampleRate, const Calibration &calibration) const;
+
+    bool isOpen() const { return m_file.isOpen(); }
+    QString path() const { return m_file.fileName(); }
+    int recordLength() const { return m_header.recordLength; }
+    quint64 frameCount() const { return m_header.frameCount; }
+
+private:
+    QFile m_file;
+    RecordingHeader m_header;
+};
+
+// Read-only view of a recording through a memory map, so searches and
+// exports touch only the pages they need and threads can share it freely.
+class RecordingReader
+{
+public:
+    RecordingReader();
+    ~RecordingReader();
+
+    bool open(const QString &path, QString *error = nullptr);
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    QString path() const { return m_file.fileName(); }
+    int channels() const { return m_header.channels; }
+    int recordLength() const { return m_header.recordLength; }
+    double sampleRate() const { return m_header.sampleRate; }
+    quint64 frameCount() const { return m_frameCount; }
+    qint64 sampleCount() const { return qint64(m_frameCount) * m_header.recordLength; }
+
+    // Codes of one channel of one frame, recordLength() long
+    const quint8 *frame(quint64 index, int channel) const
+    {
+        return m_data + m_header.headerSize
+               + (index * m_header.channels + channel) * m_header.recordLength;
+    }
+
+    // Code of one channel at a position in the concatenated stream
+    quint8 sample(qint64 position, int channel) const
+    {
+        return frame(position / recordLength(), channel)[position % recordLength()];
+    }
+
+    const float *voltsTable(int channel) const { return m_header.volts[channel]; }
+    float volts(int channel, quint8 code) const { return m_header.volts[channel][code]; }
+
+private:
+    QFile m_file;
+    const uchar *m_data;
+    RecordingHeader m_header;
+    quint64 m_frameCount;
+};
+
+#endif // RECORDING_H
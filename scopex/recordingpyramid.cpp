@@ -0,0 +1,355 @@
+#include "recordingpyramid.h"
+#include <QtConcurrent>
+#include <cstring>
+#include <numeric>
+
+namespace {
+const char PyramidMagic[8] = { 'S', 'C', 'P', 'X', 'P', 'Y', 'R', '1' };
+
+struct PyramidHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 channels;
+    quint32 recordLength;
+    quint32 baseBlock;
+    quint32 fanout;
+    quint32 levels;
+    quint64 samples;        // Per channel
+};
+
+constexpr qint64 ChunkEntries = 1024;   // Level 0 entries per parallel build task
+
+qint64 entriesFor(qint64 samples, qint64 span)
+{
+    return (samples + span - 1) / span;
+}
+
+// Entry counts of every level, from BaseBlock samples up to a single entry
+QVector<qint64> levelCounts(qint64 samples)
+{
+    QVector<qint64> counts;
+    qint64 span = RecordingPyramid::BaseBlock;
+    do {
+        counts.append(entriesFor(samples, span));
+        span *= RecordingPyramid::Fanout;
+    } while (counts.last() > 1);
+    return counts;
+}
+
+PyramidEntry makeEntry(quint8 minimum, quint8 maximum, quint64 sum, qint64 count)
+{
+    const quint64 mean = count > 0 ? (sum * 256 + quint64(count) / 2) / quint64(count) : 0;
+    return PyramidEntry{ minimum, maximum, static_cast<quint16>(mean) };
+}
+
+// Entries [first, last) of a level whose entries cover `span` samples each;
+// only the final entry of a level can be short
+PyramidEntry mergeEntries(const PyramidEntry *entries, qint64 first, qint64 last, qint64 span, qint64 samples)
+{
+    quint8 minimum = 255;
+    quint8 maximum = 0;
+    quint64 sum = 0;
+    qint64 count = 0;
+    for (qint64 i = first; i < last; ++i) {
+        const qint64 n = qMin(span, samples - i * span);
+        minimum = qMin(minimum, entries[i].minimum);
+        maximum = qMax(maximum, entries[i].maximum);
+        sum += quint64(entries[i].mean) * quint64(n);
+        count += n;
+    }
+    // Means are already 8.8, so undo the scaling makeEntry() applies
+    const quint64 mean = count > 0 ? (sum + quint64(count) / 2) / quint64(count) : 0;
+    return PyramidEntry{ minimum, maximum, static_cast<quint16>(mean) };
+}
+
+// Samples [begin, end) of a channel's concatenated stream
+PyramidEntry summarizeSamples(const RecordingReader &reader, int channel, qint64 begin, qint64 end)
+{
+    const int length = reader.recordLength();
+    quint8 minimum = 255;
+    quint8 maximum = 0;
+    quint64 sum = 0;
+    for (qint64 position = begin; position < end; ) {
+        const quint8 *codes = reader.frame(position / length, channel);
+        const int offset = int(position % length);
+        const int run = int(qMin<qint64>(length - offset, end - position));
+        for (int i = offset; i < offset + run; ++i) {
+            minimum = qMin(minimum, codes[i]);
+            maximum = qMax(maximum, codes[i]);
+            sum += codes[i];
+        }
+        position += run;
+    }
+    return makeEntry(minimum, maximum, sum, end - begin);
+}
+
+// 8.8 mean code, interpolated between table entries
+float meanVolts(const float *table, quint16 mean)
+{
+    const int k = mean >> 8;
+    if (k >= Calibration::CodeCount - 1) return table[Calibration::CodeCount - 1];
+    return table[k] + (table[k + 1] - table[k]) * (mean & 0xFF) * (1.0f / 256.0f);
+}
+
+bool writePyramid(const QString &path, int channels, int recordLength, qint64 samples,
+                  const QVector<QVector<PyramidEntry>> &level0)
+{
+    const QVector<qint64> counts = levelCounts(samples);
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    PyramidHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, PyramidMagic, sizeof(PyramidMagic));
+    header.version = 1;
+    header.channels = channels;
+    header.recordLength = recordLength;
+    header.baseBlock = RecordingPyramid::BaseBlock;
+    header.fanout = RecordingPyramid::Fanout;
+    header.levels = counts.size();
+    header.samples = samples;
+    if (file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != sizeof(header)) return false;
+
+    // Levels in order, each holding every channel's entries in turn
+    QVector<QVector<PyramidEntry>> current = level0;
+    qint64 span = RecordingPyramid::BaseBlock;
+    for (int level = 0; level < counts.size(); ++level) {
+        for (const QVector<PyramidEntry> &entries : current) {
+            const qint64 bytes = qint64(entries.size()) * qint64(sizeof(PyramidEntry));
+            if (file.write(reinterpret_cast<const char *>(entries.constData()), bytes) != bytes) return false;
+        }
+        if (level + 1 == counts.size()) break;
+
+        QVector<QVector<PyramidEntry>> next(channels);
+        for (int c = 0; c < channels; ++c) {
+            next[c].resize(counts[level + 1]);
+            for (qint64 i = 0; i < counts[level + 1]; ++i) {
+                const qint64 first = i * RecordingPyramid::Fanout;
+                const qint64 last = qMin(counts[level], first + RecordingPyramid::Fanout);
+                next[c][i] = mergeEntries(current[c].constData(), first, last, span, samples);
+            }
+        }
+        current = std::move(next);
+        span *= RecordingPyramid::Fanout;
+    }
+    return true;
+}
+}
+
+PyramidBuilder::PyramidBuilder() :
+    m_channels(0),
+    m_recordLength(0),
+    m_samples(0)
+{
+}
+
+void PyramidBuilder::begin(int channels, int recordLength)
+{
+    clear();
+    m_channels = channels;
+    m_recordLength = recordLength;
+    m_level0.resize(channels);
+    m_partial.resize(channels);
+}
+
+void PyramidBuilder::clear()
+{
+    m_channels = 0;
+    m_recordLength = 0;
+    m_samples = 0;
+    m_level0.clear();
+    m_partial.clear();
+}
+
+void PyramidBuilder::addFrame(const CodeFrame &frame)
+{
+    if (!isActive() || frame.channels() != m_channels || frame.length() != m_recordLength) return;
+
+    for (int c = 0; c < m_channels; ++c) {
+        const quint8 *codes = frame.channel(c);
+        Accumulator &partial = m_partial[c];
+        for (int i = 0; i < m_recordLength; ) {
+            // Runs up to the next block boundary, so the inner loop stays branch-free
+            const int run = qMin(m_recordLength - i, RecordingPyramid::BaseBlock - partial.count);
+            quint8 minimum = partial.minimum;
+            quint8 maximum = partial.maximum;
+            quint32 sum = partial.sum;
+            for (int j = i; j < i + run; ++j) {
+                minimum = qMin(minimum, codes[j]);
+                maximum = qMax(maximum, codes[j]);
+                sum += codes[j];
+            }
+            partial.minimum = minimum;
+            partial.maximum = maximum;
+            partial.sum = sum;
+            partial.count += run;
+            i += run;
+
+            if (partial.count == RecordingPyramid::BaseBlock) {
+                m_level0[c].append(makeEntry(minimum, maximum, sum, partial.count));
+                partial = Accumulator();
+            }
+        }
+    }
+    m_samples += m_recordLength;
+}
+
+bool PyramidBuilder::save(const QString &recordingPath)
+{
+    if (!isActive() || m_samples == 0) {
+        clear();
+        return false;
+    }
+
+    for (int c = 0; c < m_channels; ++c) {
+        const Accumulator &partial = m_partial[c];
+        if (partial.count > 0) {
+            m_level0[c].append(makeEntry(partial.minimum, partial.maximum, partial.sum, partial.count));
+        }
+    }
+    const bool saved = writePyramid(RecordingPyramid::pathFor(recordingPath), m_channels, m_recordLength,
+                                    m_samples, m_level0);
+    clear();
+    return saved;
+}
+
+RecordingPyramid::RecordingPyramid() :
+    m_data(nullptr),
+    m_channels(0),
+    m_samples(0)
+{
+}
+
+RecordingPyramid::~RecordingPyramid()
+{
+    close();
+}
+
+QString RecordingPyramid::pathFor(const QString &recordingPath)
+{
+    return recordingPath + ".pyramid";
+}
+
+bool RecordingPyramid::open(const RecordingReader &reader)
+{
+    close();
+    if (!reader.isOpen() || reader.sampleCount() == 0) return false;
+
+    m_file.setFileName(pathFor(reader.path()));
+    if (!m_file.open(QIODevice::ReadOnly) || m_file.size() < qint64(sizeof(PyramidHeader))) {
+        m_file.close();
+        return false;
+    }
+
+    PyramidHeader header;
+    m_file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    const qint64 samples = reader.sampleCount();
+    const QVector<qint64> counts = levelCounts(samples);
+    qint64 expected = sizeof(PyramidHeader);
+    for (qint64 count : counts) expected += count * reader.channels() * qint64(sizeof(PyramidEntry));
+
+    if (std::memcmp(header.magic, PyramidMagic, sizeof(PyramidMagic)) != 0 || header.version != 1
+        || int(header.channels) != reader.channels() || int(header.recordLength) != reader.recordLength()
+        || header.baseBlock != quint32(BaseBlock) || header.fanout != quint32(Fanout)
+        || qint64(header.samples) != samples || int(header.levels) != counts.size()
+        || m_file.size() != expected) {
+        m_file.close();
+        return false;
+    }
+
+    m_data = m_file.map(0, m_file.size());
+    if (!m_data) {
+        m_file.close();
+        return false;
+    }
+
+    m_channels = reader.channels();
+    m_samples = samples;
+    const uchar *entries = m_data + sizeof(PyramidHeader);
+    qint64 span = BaseBlock;
+    for (qint64 count : counts) {
+        m_levels.append(Level{ reinterpret_cast<const PyramidEntry *>(entries), count, span });
+        entries += count * m_channels * qint64(sizeof(PyramidEntry));
+        span *= Fanout;
+    }
+    return true;
+}
+
+void RecordingPyramid::close()
+{
+    if (m_data) m_file.unmap(const_cast<uchar *>(m_data));
+    m_file.close();
+    m_data = nullptr;
+    m_channels = 0;
+    m_samples = 0;
+    m_levels.clear();
+}
+
+bool RecordingPyramid::build(const RecordingReader &reader)
+{
+    if (!reader.isOpen() || reader.sampleCount() == 0) return false;
+
+    const int channels = reader.channels();
+    const qint64 samples = reader.sampleCount();
+    const qint64 count = entriesFor(samples, BaseBlock);
+    const qint64 chunks = entriesFor(count, ChunkEntries);
+
+    QVector<QVector<PyramidEntry>> level0(channels);
+    for (QVector<PyramidEntry> &entries : level0) entries.resize(count);
+
+    QVector<qint64> indices(chunks * channels);
+    std::iota(indices.begin(), indices.end(), 0);
+    QtConcurrent::blockingMap(indices, [&](qint64 index) {
+        const int channel = int(index / chunks);
+        PyramidEntry *entries = level0[channel].data();
+        const qint64 first = (index % chunks) * ChunkEntries;
+        const qint64 last = qMin(count, first + ChunkEntries);
+        for (qint64 i = first; i < last; ++i) {
+            entries[i] = summarizeSamples(reader, channel, i * BaseBlock, qMin(samples, (i + 1) * BaseBlock));
+        }
+    });
+
+    return writePyramid(pathFor(reader.path()), channels, reader.recordLength(), samples, level0);
+}
+
+int RecordingPyramid::overview(const RecordingReader &reader, int channel, qint64 first, qint64 last,
+                               int columns, float *minimum, float *maximum, float *mean) const
+{
+    if (!isOpen() || channel < 0 || channel >= m_channels) return 0;
+    first = qBound<qint64>(0, first, m_samples);
+    last = qBound<qint64>(first, last, m_samples);
+    columns = int(qMin<qint64>(columns, last - first));
+    if (columns <= 0) return 0;
+
+    const double perColumn = double(last - first) / columns;
+    const float *table = reader.voltsTable(channel);
+
+    // Coarsest level that still has an entry for every column
+    int level = -1;
+    while (level + 1 < m_levels.size() && m_levels[level + 1].span <= perColumn) ++level;
+
+    for (int c = 0; c < columns; ++c) {
+        const qint64 begin = first + qint64(c * perColumn);
+        const qint64 end = qMax(begin + 1, c + 1 == columns ? last : first + qint64((c + 1) * perColumn));
+
+        PyramidEntry entry;
+        if (level < 0) {
+            entry = summarizeSamples(reader, channel, begin, end);
+        } else {
+            const Level &l = m_levels[level];
+            const qint64 firstEntry = begin / l.span;
+            const qint64 lastEntry = qMin(l.count, qMax(firstEntry + 1, (end + l.span - 1) / l.span));
+            entry = mergeEntries(l.entries + channel * l.count, firstEntry, lastEntry, l.span, m_samples);
+        }
+
+        // Tables may run downwards, so order the envelope after conversion
+        const float low = table[entry.minimum];
+        const float high = table[entry.maximum];
+        minimum[c] = qMin(low, high);
+        maximum[c] = qMax(low, high);
+        mean[c] = meanVolts(table, entry.mean);
+    }
+    return columns;
+}
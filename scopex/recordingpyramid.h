@@ -0,0 +1,96 @@
+#ifndef RECORDINGPYRAMID_H
+#define RECORDINGPYRAMID_H
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include "recording.h"
+#include "scopeframe.h"
+
+// Multi-resolution minimum, maximum and mean of each channel of a
+// recording, stored next to it as "<recording>.pyramid". Level 0 summarizes
+// every BaseBlock samples of the concatenated stream and each level above
+// merges Fanout entries of the one below, up to a single entry. Drawing any
+// span of the recording then reads one level with a few entries per
+// column, so the cost follows the width in pixels, not the samples shown.
+struct PyramidEntry
+{
+    quint8 minimum;
+    quint8 maximum;
+    quint16 mean;   // 8.8 fixed-point code
+};
+
+// Collects level 0 while a recording is written and writes the pyramid
+// when it is closed, so a finished recording opens with its pyramid ready
+class PyramidBuilder
+{
+public:
+    PyramidBuilder();
+
+    void begin(int channels, int recordLength);
+    void addFrame(const CodeFrame &frame);
+    bool save(const QString &recordingPath);
+    void clear();
+
+    bool isActive() const { return m_channels > 0; }
+
+private:
+    struct Accumulator {
+        quint8 minimum = 255;
+        quint8 maximum = 0;
+        quint32 sum = 0;
+        int count = 0;
+    };
+
+    int m_channels;
+    int m_recordLength;
+    qint64 m_samples;
+    QVector<QVector<PyramidEntry>> m_level0;   // Per channel
+    QVector<Accumulator> m_partial;            // Per channel, the unfinished block
+};
+
+// Read-only view of a pyramid file through a memory map, so reopening a
+// recording costs a header check however long it is
+class RecordingPyramid
+{
+public:
+    static constexpr int BaseBlock = 256;
+    static constexpr int Fanout = 4;
+
+    RecordingPyramid();
+    ~RecordingPyramid();
+
+    static QString pathFor(const QString &recordingPath);
+
+    // Maps the pyramid file if it matches the recording
+    bool open(const RecordingReader &reader);
+    void close();
+    // Computes level 0 in parallel over an existing recording and writes
+    // the file; thread-safe, the result is picked up by open()
+    static bool build(const RecordingReader &reader);
+
+    bool isOpen() const { return m_data != nullptr; }
+    int levels() const { return m_levels.size(); }
+
+    // Summary of samples [first, last) of a channel in up to `columns`
+    // equal columns, in volts. Below one block per column the samples are
+    // read from the recording instead. Returns the number of columns
+    // written, which is smaller when fewer samples than columns remain.
+    int overview(const RecordingReader &reader, int channel, qint64 first, qint64 last, int columns,
+                 float *minimum, float *maximum, float *mean) const;
+
+private:
+    struct Level {
+        const PyramidEntry *entries;   // Channel-major
+        qint64 count;                  // Entries per channel
+        qint64 span;                   // Samples per entry
+    };
+
+    QFile m_file;
+    const uchar *m_data;
+    int m_channels;
+    qint64 m_samples;
+    QVector<Level> m_levels;
+};
+
+#endif // RECORDINGPYRAMID_H
@@ -0,0 +1,51 @@
+#include "rollbuffer.h"
+#include <cstring>
+
+RollBuffer::RollBuffer() :
+    m_channels(0),
+    m_capacity(0),
+    m_written(0)
+{
+}
+
+void RollBuffer::configure(int channels, int capacity)
+{
+    m_channels = qMax(1, channels);
+    m_capacity = qMax(1, capacity);
+    m_data.fill(0.0f, qsizetype(m_channels) * m_capacity);
+    m_written = 0;
+}
+
+void RollBuffer::clear()
+{
+    m_written = 0;
+}
+
+void RollBuffer::append(const float *interleaved, int ticks)
+{
+    if (m_capacity == 0 || ticks <= 0) return;
+
+    // Only the newest `capacity` of a long burst survive
+    const int skip = qMax(0, ticks - m_capacity);
+    qint64 position = m_written + skip;
+    for (int t = skip; t < ticks; ++t, ++position) {
+        const qsizetype slot = position % m_capacity;
+        const float *tick = interleaved + qsizetype(t) * m_channels;
+        for (int c = 0; c < m_channels; ++c) m_data[qsizetype(c) * m_capacity + slot] = tick[c];
+    }
+    m_written += ticks;
+}
+
+void RollBuffer::copy(int channel, qint64 from, int count, float *out) const
+{
+    const float *ring = m_data.constData() + qsizetype(channel) * m_capacity;
+    while (count > 0) {
+        // At most two runs, split where the ring wraps
+        const int slot = int(from % m_capacity);
+        const int run = qMin(count, m_capacity - slot);
+        std::memcpy(out, ring + slot, size_t(run) * sizeof(float));
+        out += run;
+        from += run;
+        count -= run;
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef ROLLBUFFER_H
+#define ROLLBUFFER_H
+
+#include <QVector>
+
+// History of the last `capacity` samples of every channel in roll mode.
+// Samples arrive a few at a time as the device converts them and overwrite
+// the oldest; positions are counted from the start of the roll, so a
+// reader remembers how far it got and asks only for what is new.
+class RollBuffer
+{
+public:
+    RollBuffer();
+
+    // Clears the history
+    void configure(int channels, int capacity);
+    void clear();
+
+    // `ticks` samples of every channel, interleaved by channel
+    void append(const float *interleaved, int ticks);
+
+    int channels() const { return m_channels; }
+    int capacity() const { return m_capacity; }
+    qint64 written() const { return m_written; }
+    qint64 oldest() const { return qMax<qint64>(0, m_written - m_capacity); }
+
+    // Samples [from, from + count) of a channel, which must lie within
+    // [oldest(), written())
+    void copy(int channel, qint64 from, int count, float *out) const;
+
+private:
+    int m_channels;
+    int m_capacity;
+    qint64 m_written;
+    QVector<float> m_data;   // Per channel, `capacity` samples in a ring
+};
+
+#endif // ROLLBUFFER_H
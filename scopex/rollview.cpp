@@ -0,0 +1,260 @@
+#include "rollview.h"
+#include "serialhandler.h"
+#include <QSGNode>
+#include <QSGFlatColorMaterial>
+#include <cstring>
+
+RollView::RollView(QQuickItem *parent) : QQuickItem(parent),
+    m_range(10.0),
+    m_colorsChanged(false),
+    m_capacity(0),
+    m_stride(1),
+    m_consumed(0),
+    m_written(0),
+    m_rebuild(true)
+{
+    m_colors[0] = QColor(Qt::red);
+    m_colors[1] = QColor(Qt::blue);
+    setFlag(ItemHasContents, true);
+}
+
+SerialHandler *RollView::source() const
+{
+    return m_source;
+}
+
+void RollView::setSource(SerialHandler *source)
+{
+    if (source == m_source) return;
+
+    if (m_source) disconnect(m_source, nullptr, this, nullptr);
+    m_source = source;
+    if (m_source) {
+        connect(m_source, &SerialHandler::rollSamplesAdded, this, &RollView::consume);
+        connect(m_source, &SerialHandler::rollModeChanged, this, &RollView::restart);
+    }
+    restart();
+    emit sourceChanged();
+}
+
+void RollView::setRange(double volts)
+{
+    if (volts <= 0.0 || qFuzzyCompare(volts, m_range)) return;
+    m_range = volts;
+    update();
+    emit settingsChanged();
+}
+
+void RollView::setCh1Color(const QColor &color)
+{
+    if (color == m_colors[0]) return;
+    m_colors[0] = color;
+    m_colorsChanged = true;
+    update();
+    emit settingsChanged();
+}
+
+void RollView::setCh2Color(const QColor &color)
+{
+    if (color == m_colors[1]) return;
+    m_colors[1] = color;
+    m_colorsChanged = true;
+    update();
+    emit settingsChanged();
+}
+
+void RollView::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+
+    // Columns follow the pixel width, so a new width rebuilds the chunks
+    // from the history; a new height only changes the transforms
+    if (newGeometry.width() != oldGeometry.width()) {
+        restart();
+    } else {
+        update();
+    }
+}
+
+void RollView::restart()
+{
+    for (int c = 0; c < Channels; ++c) {
+        m_chunks[c].clear();
+        m_column[c] = Column();
+    }
+    m_retired.clear();
+    m_rebuild = true;
+    update();
+
+    const int pixels = qMax(1, int(width()));
+    m_capacity = m_source ? m_source->rollBuffer().capacity() : 0;
+    m_stride = qMax(1, (m_capacity + pixels - 1) / pixels);
+    m_consumed = m_source ? m_source->rollBuffer().oldest() : 0;
+    m_written = m_consumed;
+    if (m_capacity > 0) consume();
+}
+
+void RollView::consume()
+{
+    if (!m_source) return;
+    const RollBuffer &buffer = m_source->rollBuffer();
+
+    // A new history, or one that has run past what was drawn, starts over
+    if (buffer.capacity() != m_capacity || buffer.written() < m_consumed || m_consumed < buffer.oldest()) {
+        restart();
+        return;
+    }
+
+    const qint64 available = buffer.written() - m_consumed;
+    if (available <= 0) return;
+
+    m_samples.resize(available);
+    const int channels = qMin(int(Channels), buffer.channels());
+    for (int c = 0; c < channels; ++c) {
+        buffer.copy(c, m_consumed, int(available), m_samples.data());
+        Column &column = m_column[c];
+        for (qint64 i = 0; i < available; ++i) {
+            const float value = m_samples[i];
+            if (column.count == 0) {
+                column.start = m_consumed + i;
+                column.minimum = value;
+                column.maximum = value;
+            } else {
+                column.minimum = qMin(column.minimum, value);
+                column.maximum = qMax(column.maximum, value);
+            }
+            if (++column.count == m_stride) {
+                addColumn(c, column);
+                column.count = 0;
+            }
+        }
+    }
+    m_consumed = buffer.written();
+    m_written = m_consumed;
+
+    // Chunks wholly past the left edge are dropped; their nodes go at the
+    // next sync
+    const qint64 left = m_written - m_capacity;
+    for (int c = 0; c < Channels; ++c) {
+        QList<Chunk> &chunks = m_chunks[c];
+        while (chunks.size() > 1
+               && chunks.first().start + qint64(chunks.first().columns) * m_stride <= left) {
+            if (chunks.first().node) m_retired.append(chunks.first().node);
+            chunks.removeFirst();
+        }
+    }
+    update();
+}
+
+void RollView::addColumn(int channel, const Column &column)
+{
+    QList<Chunk> &chunks = m_chunks[channel];
+    if (chunks.isEmpty() || chunks.last().columns == ChunkColumns) {
+        Chunk chunk;
+        chunk.start = column.start;
+        chunk.vertices.reserve((ChunkColumns * 2 + 1) * 2);
+
+        // Starts on the previous chunk's last vertex, so the trace stays joined
+        if (!chunks.isEmpty()) {
+            const Chunk &previous = chunks.last();
+            const int n = previous.vertices.size();
+            chunk.vertices.append(float(previous.start - column.start) + previous.vertices[n - 2]);
+            chunk.vertices.append(previous.vertices[n - 1]);
+        }
+        chunks.append(chunk);
+    }
+
+    Chunk &chunk = chunks.last();
+    const float x = float(column.start - chunk.start);
+    chunk.vertices.append(x);
+    chunk.vertices.append(column.minimum);
+    if (m_stride > 1) {
+        chunk.vertices.append(x);
+        chunk.vertices.append(column.maximum);
+    }
+    ++chunk.columns;
+    chunk.dirty = true;
+}
+
+QSGNode *RollView::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
+{
+    QSGNode *root = oldNode;
+    if (root && m_rebuild) {
+        delete root;
+        root = nullptr;
+    }
+
+    if (!root) {
+        // Nodes the chunks remember belonged to the tree just deleted, or
+        // to one the window already released
+        root = new QSGNode;
+        for (int c = 0; c < Channels; ++c) {
+            root->appendChildNode(new QSGNode);
+            for (Chunk &chunk : m_chunks[c]) {
+                chunk.node = nullptr;
+                chunk.dirty = true;
+            }
+        }
+        m_retired.clear();
+    }
+    m_rebuild = false;
+
+    for (QSGTransformNode *node : std::as_const(m_retired)) {
+        node->parent()->removeChildNode(node);
+        delete node;
+    }
+    m_retired.clear();
+
+    if (m_capacity == 0) return root;
+
+    // Sample coordinates to pixels, the newest sample at the right edge
+    const double pixelsPerSample = width() / m_capacity;
+    const double voltsScale = -height() / (2.0 * m_range);
+    const qint64 left = m_written - m_capacity;
+
+    for (int c = 0; c < Channels; ++c) {
+        QSGNode *group = root->childAtIndex(c);
+        for (Chunk &chunk : m_chunks[c]) {
+            if (!chunk.node) {
+                QSGGeometry *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
+                geometry->setDrawingMode(QSGGeometry::DrawLineStrip);
+                QSGFlatColorMaterial *material = new QSGFlatColorMaterial;
+                material->setColor(m_colors[c]);
+
+                QSGGeometryNode *line = new QSGGeometryNode;
+                line->setGeometry(geometry);
+                line->setFlag(QSGNode::OwnsGeometry);
+                line->setMaterial(material);
+                line->setFlag(QSGNode::OwnsMaterial);
+
+                chunk.node = new QSGTransformNode;
+                chunk.node->appendChildNode(line);
+                group->appendChildNode(chunk.node);
+                chunk.dirty = true;
+            }
+
+            QSGGeometryNode *line = static_cast<QSGGeometryNode *>(chunk.node->firstChild());
+            if (chunk.dirty) {
+                // Only the chunk still being filled gets here once it is built
+                QSGGeometry *geometry = line->geometry();
+                const int count = chunk.vertices.size() / 2;
+                geometry->allocate(count);
+                std::memcpy(geometry->vertexDataAsPoint2D(), chunk.vertices.constData(),
+                            size_t(count) * sizeof(QSGGeometry::Point2D));
+                line->markDirty(QSGNode::DirtyGeometry);
+                chunk.dirty = false;
+            }
+            if (m_colorsChanged) {
+                static_cast<QSGFlatColorMaterial *>(line->material())->setColor(m_colors[c]);
+                line->markDirty(QSGNode::DirtyMaterial);
+            }
+
+            QMatrix4x4 matrix;
+            matrix.translate(float((chunk.start - left) * pixelsPerSample), float(height() / 2));
+            matrix.scale(float(pixelsPerSample), float(voltsScale));
+            chunk.node->setMatrix(matrix);
+        }
+    }
+    m_colorsChanged = false;
+    return root;
+}
@@ -0,0 +1,95 @@
+#ifndef ROLLVIEW_H
+#define ROLLVIEW_H
+
+#include <QQuickItem>
+#include <QPointer>
+#include <QColor>
+#include <QList>
+#include <QVector>
+
+class SerialHandler;
+class QSGNode;
+class QSGTransformNode;
+Q_MOC_INCLUDE("serialhandler.h")
+
+// Roll mode display: both channels scroll right to left across the
+// handler's roll history, newest sample at the right edge. Each trace is a
+// row of chunk nodes, each holding ChunkColumns columns of line strip in
+// its own sample coordinates. New samples only extend the last chunk, so
+// an update uploads that one chunk's vertices; scrolling just moves every
+// chunk's transform, and chunks that leave the left edge are dropped. When
+// a column spans several samples it holds their minimum and maximum.
+class RollView : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(SerialHandler *source READ source WRITE setSource NOTIFY sourceChanged)
+    Q_PROPERTY(double range READ range WRITE setRange NOTIFY settingsChanged)
+    Q_PROPERTY(QColor ch1Color READ ch1Color WRITE setCh1Color NOTIFY settingsChanged)
+    Q_PROPERTY(QColor ch2Color READ ch2Color WRITE setCh2Color NOTIFY settingsChanged)
+
+public:
+    static constexpr int ChunkColumns = 64;
+
+    explicit RollView(QQuickItem *parent = nullptr);
+
+    SerialHandler *source() const;
+    void setSource(SerialHandler *source);
+
+    // Volts at the top edge; the bottom edge is -range
+    double range() const { return m_range; }
+    void setRange(double volts);
+    QColor ch1Color() const { return m_colors[0]; }
+    void setCh1Color(const QColor &color);
+    QColor ch2Color() const { return m_colors[1]; }
+    void setCh2Color(const QColor &color);
+
+signals:
+    void sourceChanged();
+    void settingsChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+
+private:
+    static constexpr int Channels = 2;
+
+    struct Chunk {
+        qint64 start = 0;           // First sample of the first column
+        int columns = 0;
+        QVector<float> vertices;    // x (samples from start), y (volts) pairs
+        bool dirty = true;
+        QSGTransformNode *node = nullptr;
+    };
+
+    // Column being filled from incoming samples
+    struct Column {
+        qint64 start = 0;
+        int count = 0;
+        float minimum = 0.0f;
+        float maximum = 0.0f;
+    };
+
+    void restart();
+    void consume();
+    void addColumn(int channel, const Column &column);
+
+    QPointer<SerialHandler> m_source;
+    double m_range;
+    QColor m_colors[Channels];
+    bool m_colorsChanged;
+
+    int m_capacity;       // Samples across the view
+    int m_stride;         // Samples per column
+    qint64 m_consumed;    // Next roll sample to read
+    qint64 m_written;     // Roll samples seen; the newest is at the right edge
+    QList<Chunk> m_chunks[Channels];
+    Column m_column[Channels];
+    QVector<float> m_samples;
+
+    // Nodes of dropped chunks, deleted at the next sync
+    QList<QSGTransformNode *> m_retired;
+    bool m_rebuild;       // Scene graph must be recreated at the next sync
+};
+
+#endif // ROLLVIEW_H
@@ -0,0 +1,129 @@
+#ifndef SAMPLEFORMAT_H
+#define SAMPLEFORMAT_H
+
+#include <QtGlobal>
+#include <QtEndian>
+#include <cstring>
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+// How the device packs ADC samples on the wire. Each channel's run of
+// samples is packed on its own, so a frame is still planar per channel.
+enum SampleFormat {
+    Bits8 = 0,      // One byte per sample
+    Packed12 = 1,   // Two samples in three bytes, low nibble first
+    Little10 = 2,   // Right-justified in little-endian 16-bit words
+    Little16 = 3    // Little-endian 16-bit words
+};
+
+// Compile-time description and unpack kernel for one format. Wider formats
+// unpack to left-justified 16-bit codes, which is the same scale as the 8.8
+// fixed-point codes the accumulators produce, so everything after the
+// accumulator is shared. 8-bit codes stay bytes and keep the LUT path.
+template<SampleFormat F>
+struct SampleLayout;
+
+template<>
+struct SampleLayout<Bits8>
+{
+    using Code = quint8;
+    static constexpr int Bits = 8;
+    static constexpr qsizetype bytes(qsizetype samples) { return samples; }
+
+    static void unpack(const uchar *in, int count, quint8 *out) { std::memcpy(out, in, count); }
+};
+
+template<>
+struct SampleLayout<Packed12>
+{
+    using Code = quint16;
+    static constexpr int Bits = 12;
+    static constexpr qsizetype bytes(qsizetype samples) { return (samples * 3 + 1) / 2; }
+
+    static void unpack(const uchar *in, int count, quint16 *out)
+    {
+        int i = 0;
+#ifdef __SSSE3__
+        // Eight samples from twelve bytes per step: each byte pair that
+        // holds a sample is shuffled into a 16-bit lane, then even lanes
+        // drop their top nibble by shifting left and odd lanes mask off
+        // their bottom one. Loads are 16 bytes wide, so stop while a full
+        // load still fits inside the input.
+        const __m128i shuffle = _mm_setr_epi8(0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11);
+        const __m128i oddMask = _mm_set1_epi32(int(0xFFF00000));
+        const __m128i evenMask = _mm_set1_epi32(0x0000FFFF);
+        const qsizetype total = bytes(count);
+        for (; i + 8 <= count && qsizetype(i / 2 * 3) + 16 <= total; i += 8) {
+            const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i / 2 * 3));
+            const __m128i lanes = _mm_shuffle_epi8(raw, shuffle);
+            const __m128i even = _mm_and_si128(_mm_slli_epi16(lanes, 4), evenMask);
+            const __m128i odd = _mm_and_si128(lanes, oddMask);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_or_si128(even, odd));
+        }
+#endif
+        for (; i + 2 <= count; i += 2) {
+            const uchar *p = in + i / 2 * 3;
+            out[i] = static_cast<quint16>((p[0] | (p[1] & 0x0F) << 8) << 4);
+            out[i + 1] = static_cast<quint16>((p[1] | p[2] << 8) & 0xFFF0);
+        }
+        if (i < count) {
+            const uchar *p = in + i / 2 * 3;
+            out[i] = static_cast<quint16>((p[0] | (p[1] & 0x0F) << 8) << 4);
+        }
+    }
+};
+
+template<>
+struct SampleLayout<Little16>
+{
+    using Code = quint16;
+    static constexpr int Bits = 16;
+    static constexpr qsizetype bytes(qsizetype samples) { return samples * 2; }
+
+    static void unpack(const uchar *in, int count, quint16 *out)
+    {
+        qFromLittleEndian<quint16>(in, count, out);
+    }
+};
+
+template<>
+struct SampleLayout<Little10>
+{
+    using Code = quint16;
+    static constexpr int Bits = 10;
+    static constexpr qsizetype bytes(qsizetype samples) { return samples * 2; }
+
+    static void unpack(const uchar *in, int count, quint16 *out)
+    {
+        SampleLayout<Little16>::unpack(in, count, out);
+        for (int i = 0; i < count; ++i) {
+            out[i] = static_cast<quint16>(out[i] << (16 - Bits));
+        }
+    }
+};
+
+// Runtime lookups for code that only needs sizes, not the kernels
+inline qsizetype sampleBytes(SampleFormat format, qsizetype samples)
+{
+    switch (format) {
+    case Packed12: return SampleLayout<Packed12>::bytes(samples);
+    case Little10: return SampleLayout<Little10>::bytes(samples);
+    case Little16: return SampleLayout<Little16>::bytes(samples);
+    case Bits8:
+    default: return SampleLayout<Bits8>::bytes(samples);
+    }
+}
+
+inline int sampleBits(SampleFormat format)
+{
+    switch (format) {
+    case Packed12: return SampleLayout<Packed12>::Bits;
+    case Little10: return SampleLayout<Little10>::Bits;
+    case Little16: return SampleLayout<Little16>::Bits;
+    case Bits8:
+    default: return SampleLayout<Bits8>::Bits;
+    }
+}
+
+#endif // SAMPLEFORMAT_H
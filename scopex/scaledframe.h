@@ -0,0 +1,50 @@
+#ifndef SCALEDFRAME_H
+#define SCALEDFRAME_H
+
+#include <QVector>
+#include "scopeframe.h"
+#include "calibration.h"
+#include "framepool.h"
+
+// A frame kept as the 8.8 fixed-point codes the accumulators produce, with
+// each channel's ChannelScale and the time base in info. At two bytes a
+// sample it is an eighth of a QPointF, and volts are computed only for the
+// samples a consumer reads. Scales are captured with the codes, so a frame
+// converts the same after the front end has been switched.
+class ScaledFrame : public ScopeFrame<quint16>
+{
+public:
+    void configure(int channels, int length)
+    {
+        ScopeFrame<quint16>::configure(channels, length);
+        if (m_scales.size() < channels) m_scales.resize(channels);
+    }
+
+    ChannelScale &scale(int channel) { return m_scales[channel]; }
+    const ChannelScale &scale(int channel) const { return m_scales[channel]; }
+
+    // Volts of samples [first, first + count) of one channel
+    void volts(int channel, int first, int count, float *out) const
+    {
+        m_scales[channel].convert(this->channel(channel) + first, count, out);
+    }
+
+    float volts(int channel, int index) const { return m_scales[channel].volts(this->channel(channel)[index]); }
+
+    // The whole frame, for consumers that need every sample
+    void toVolts(VoltFrame &out) const
+    {
+        out.configure(channels(), length());
+        for (int c = 0; c < channels(); ++c) volts(c, 0, length(), out.channel(c));
+        out.info = info;
+    }
+
+private:
+    QVector<ChannelScale> m_scales;
+};
+
+// Published frames are shared read-only between consumers
+using ScaledFramePool = FramePool<ScaledFrame>;
+using SharedFrame = ScaledFramePool::Handle;
+
+#endif // SCALEDFRAME_H
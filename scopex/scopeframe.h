@@ -0,0 +1,106 @@
+#ifndef SCOPEFRAME_H
+#define SCOPEFRAME_H
+
+#include <QtGlobal>
+#include <algorithm>
+#include <new>
+#include <utility>
+
+// Metadata travelling with every frame
+struct FrameInfo
+{
+    qint64 timestamp = 0;      // Monotonic nanoseconds at acquisition
+    double sampleRate = 0.0;   // Of these arrays; the composite rate for equivalent time
+    quint32 revision = 0;      // Settings revision the frame was captured under
+};
+
+// N-channel frame in structure-of-arrays layout: one contiguous array per
+// channel, each starting on a 64 byte boundary so vector kernels can use
+// aligned loads on any channel. Storage only grows in configure(), so a
+// frame reused across captures allocates once per record length.
+template<typename T>
+class ScopeFrame
+{
+public:
+    static constexpr int Alignment = 64;
+
+    ScopeFrame() = default;
+    ScopeFrame(const ScopeFrame &other) { *this = other; }
+    ScopeFrame(ScopeFrame &&other) noexcept { swap(other); }
+    ~ScopeFrame() { release(); }
+
+    ScopeFrame &operator=(const ScopeFrame &other)
+    {
+        if (this == &other) return *this;
+        configure(other.m_channels, other.m_length);
+        for (int c = 0; c < m_channels; ++c) {
+            std::copy(other.channel(c), other.channel(c) + m_length, channel(c));
+        }
+        info = other.info;
+        return *this;
+    }
+
+    ScopeFrame &operator=(ScopeFrame &&other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    void swap(ScopeFrame &other) noexcept
+    {
+        std::swap(m_data, other.m_data);
+        std::swap(m_capacity, other.m_capacity);
+        std::swap(m_channels, other.m_channels);
+        std::swap(m_length, other.m_length);
+        std::swap(m_stride, other.m_stride);
+        std::swap(info, other.info);
+    }
+
+    // Contents are unspecified afterwards
+    void configure(int channels, int length)
+    {
+        constexpr qsizetype perLine = Alignment / sizeof(T) > 0 ? Alignment / sizeof(T) : 1;
+        m_channels = qMax(0, channels);
+        m_length = qMax(0, length);
+        m_stride = (m_length + perLine - 1) / perLine * perLine;
+
+        const qsizetype needed = m_stride * m_channels;
+        if (needed > m_capacity) {
+            release();
+            m_data = static_cast<T *>(::operator new(needed * sizeof(T), std::align_val_t(Alignment)));
+            m_capacity = needed;
+        }
+    }
+
+    // Empties the frame but keeps its storage
+    void clear() { m_length = 0; }
+
+    bool isEmpty() const { return m_length == 0 || m_channels == 0; }
+    int channels() const { return m_channels; }
+    int length() const { return m_length; }
+
+    T *channel(int index) { return m_data + index * m_stride; }
+    const T *channel(int index) const { return m_data + index * m_stride; }
+
+    FrameInfo info;
+
+private:
+    void release()
+    {
+        if (m_data) ::operator delete(m_data, std::align_val_t(Alignment));
+        m_data = nullptr;
+        m_capacity = 0;
+    }
+
+    T *m_data = nullptr;
+    qsizetype m_capacity = 0;
+    int m_channels = 0;
+    int m_length = 0;
+    qsizetype m_stride = 0;
+};
+
+using CodeFrame = ScopeFrame<quint8>;       // Raw 8-bit ADC codes
+using WideCodeFrame = ScopeFrame<quint16>;  // Left-justified 10 to 16-bit codes
+using VoltFrame = ScopeFrame<float>;        // Calibrated volts
+
+#endif // SCOPEFRAME_H
@@ -3,21 +3,109 @@
 #include <QtMath>
 #include <QTimer>
 #include <QThread>
+#include <QRandomGenerator>
+#include <QStandardPaths>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QtConcurrent>
+#include <QVarLengthArray>
+#include <QMetaMethod>
+#include <cstring>
 
 SerialHandler::SerialHandler(QObject *parent) : QObject(parent),
     m_serial(new QSerialPort(this)),
     m_connected(false),
-    m_statusMessage("Ready")
+    m_statusMessage("Ready"),
+    m_recordLength(0),
+    m_deviceRecordLength(0),
+    m_requestedRecordLength(0),
+    m_captureRunning(false),
+    m_captureContinuous(false),
+    m_captureDeferred(false),
+    m_sampleFormat(Bits8),
+    m_settingsRevision(0),
+    m_calibrationChannel(-1),
+    m_calibrationStep(0),
+    m_calibrationAmplitude(0.0),
+    m_calibrationSkipped(0),
+    m_calibrationRestoreGain(0),
+    m_calibrationRestoreOffset(0),
+    m_ddsRunning(false),
+    m_emulatedDdsPhase(0.0),
+    m_voltsCurrent(false),
+    m_equivalentTimeEnabled(false),
+    m_sampleSpacing(1.0),
+    m_sampleRateIndex(10),
+    m_sampleRate(1000.0),
+    m_dftEnabled(false),
+    m_distortionEnabled(false),
+    m_distortionChannel(0),
+    m_crossChannelEnabled(false),
+    m_maskEnabled(false),
+    m_maskChannel(0),
+    m_maskSaveFailures(false),
+    m_maskLastPassed(true),
+    m_maskSavedFailures(0),
+    m_recordingPart(0),
+    m_searchDone(false),
+    m_currentEvent(-1),
+    m_exportProgress(0.0),
+    m_exportCancel(false),
+    m_replaySpeed(1.0),
+    m_replayPending(false),
+    m_replayRecords(0),
+    m_replayBytes(0),
+    m_replayParseTime(0),
+    m_rollMode(false),
+    m_rollRunning(false),
+    m_rollSpan(10.0),
+    m_rollEmulated(0),
+    m_frameAllocations(-1),
+    m_framePoolSize(0),
+    m_visibleFirst(0),
+    m_visibleLast(-1)
 {
     initializeWaveformTables();
+    m_frameClock.start();
+    m_accumulators.resize(Calibration::Channels);
+    for (FrameAccumulator &accumulator : m_accumulators) {
+        accumulator.configure(FrameAccumulator::Normal, 0, 16);
+    }
+    setRecordLength(MinRecordLength);
+    if (QFile::exists(defaultCalibrationPath())) {
+        loadCalibration();
+    }
+    connect(&m_portMonitor, &PortMonitor::portsChanged, this, &SerialHandler::portsChanged);
     connect(m_serial, &QSerialPort::readyRead, this, &SerialHandler::handleReadyRead);
     connect(m_serial, QOverload<QSerialPort::SerialPortError>::of(&QSerialPort::errorOccurred),
             this, &SerialHandler::handleError);
+    connect(&m_searchWatcher, &QFutureWatcher<QVector<EventSearch::Event>>::finished,
+            this, &SerialHandler::finishSearch);
+    connect(&m_pyramidWatcher, &QFutureWatcher<bool>::finished, this, &SerialHandler::finishPyramid);
+    connect(&m_exportWatcher, &QFutureWatcher<QString>::finished, this, &SerialHandler::finishExport);
+    m_replayTimer.setSingleShot(true);
+    connect(&m_replayTimer, &QTimer::timeout, this, &SerialHandler::replayStep);
+    connect(&m_stream, &StreamServer::clientsChanged, this, &SerialHandler::streamChanged);
+    connect(&m_stream, &StreamServer::droppedChanged, this, &SerialHandler::streamChanged);
+    connect(&m_rollTimer, &QTimer::timeout, this, &SerialHandler::emulateRoll);
+    m_recordLengthTimer.setSingleShot(true);
+    m_recordLengthTimer.setInterval(RecordLengthReplyTimeout);
+    connect(&m_recordLengthTimer, &QTimer::timeout, this, [this]() {
+        if (m_requestedRecordLength > 0) confirmRecordLength(m_requestedRecordLength);
+    });
 }
 
 SerialHandler::~SerialHandler()
 {
     disconnectPort();
+    m_exportCancel = true;
+    m_exportWatcher.waitForFinished();
+    m_searchWatcher.waitForFinished();
+    m_pyramidWatcher.waitForFinished();
+    m_recorder.close();
+    m_pyramidBuilder.save(m_recorder.path());
 }
 
 void SerialHandler::initializeWaveformTables()
@@ -60,12 +148,7 @@ void SerialHandler::initializeWaveformTables()
 
 QStringList SerialHandler::availablePorts() const
 {
-    QStringList ports;
-    const QList<QSerialPortInfo> portInfos = QSerialPortInfo::availablePorts();
-    for (const QSerialPortInfo &info : portInfos) {
-        ports.append(info.portName());
-    }
-    return ports;
+    return m_portMonitor.ports();
 }
 
 bool SerialHandler::connected() const
@@ -78,9 +161,287 @@ QString SerialHandler::statusMessage() const
     return m_statusMessage;
 }
 
+int SerialHandler::interpolationMode() const
+{
+    return m_interpolator.mode();
+}
+
+int SerialHandler::interpolationFactor() const
+{
+    return m_interpolator.factor();
+}
+
+int SerialHandler::acquisitionMode() const
+{
+    return m_accumulators.constFirst().mode();
+}
+
+int SerialHandler::acquisitionDepth() const
+{
+    return m_accumulators.constFirst().depth();
+}
+
+int SerialHandler::acquiredFrames() const
+{
+    return m_accumulators.constFirst().frameCount();
+}
+
+bool SerialHandler::equivalentTime() const
+{
+    return m_equivalentTimeEnabled;
+}
+
+int SerialHandler::equivalentTimeFactor() const
+{
+    return m_equivalentTime.factor();
+}
+
+double SerialHandler::equivalentTimeCoverage() const
+{
+    return m_equivalentTime.coverage();
+}
+
+bool SerialHandler::calibrating() const
+{
+    return m_calibrationChannel >= 0;
+}
+
+double SerialHandler::calibrationProgress() const
+{
+    return calibrating() ? static_cast<double>(m_calibrationStep) / (2 * Calibration::GainSteps) : 0.0;
+}
+
+double SerialHandler::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+int SerialHandler::recordLength() const
+{
+    return m_recordLength;
+}
+
+int SerialHandler::sampleFormat() const
+{
+    return m_sampleFormat;
+}
+
+bool SerialHandler::dftEnabled() const
+{
+    return m_dftEnabled;
+}
+
+bool SerialHandler::distortionEnabled() const
+{
+    return m_distortionEnabled;
+}
+
+int SerialHandler::distortionChannel() const
+{
+    return m_distortionChannel;
+}
+
+int SerialHandler::distortionAverages() const
+{
+    return m_distortion.averages();
+}
+
+QVariantMap SerialHandler::distortion() const
+{
+    const DistortionAnalyzer::Result &result = m_distortion.result();
+    QVariantMap map;
+    map["valid"] = result.valid;
+    map["frequency"] = result.frequency;
+    map["amplitude"] = result.amplitude;
+    map["thd"] = result.thd;
+    map["thdPercent"] = 100.0 * qPow(10.0, result.thd / 20.0);
+    map["thdPlusNoise"] = result.thdPlusNoise;
+    map["snr"] = result.snr;
+    map["sinad"] = result.sinad;
+    map["sfdr"] = result.sfdr;
+    map["enob"] = result.enob;
+    map["harmonics"] = result.harmonics;
+    return map;
+}
+
+bool SerialHandler::crossChannelEnabled() const
+{
+    return m_crossChannelEnabled;
+}
+
+int SerialHandler::crossChannelAverages() const
+{
+    return m_crossChannel.averages();
+}
+
+QVariantMap SerialHandler::crossChannel() const
+{
+    const CrossChannelAnalyzer::Result &result = m_crossChannel.result();
+    QVariantMap map;
+    map["valid"] = result.valid;
+    map["delay"] = result.delay;
+    map["delaySamples"] = result.delaySamples;
+    map["correlation"] = result.correlation;
+    map["frequency"] = result.frequency;
+    map["phase"] = result.phase;
+    map["gain"] = result.gain;
+    map["coherence"] = result.coherence;
+    return map;
+}
+
+bool SerialHandler::maskEnabled() const
+{
+    return m_maskEnabled;
+}
+
+int SerialHandler::maskChannel() const
+{
+    return m_maskChannel;
+}
+
+bool SerialHandler::maskSaveFailures() const
+{
+    return m_maskSaveFailures;
+}
+
+bool SerialHandler::maskDefined() const
+{
+    return !m_mask.isEmpty();
+}
+
+quint64 SerialHandler::maskTested() const
+{
+    return m_mask.tested();
+}
+
+quint64 SerialHandler::maskFailed() const
+{
+    return m_mask.failed();
+}
+
+double SerialHandler::maskFailureRate() const
+{
+    return m_mask.failureRate();
+}
+
+bool SerialHandler::maskLastPassed() const
+{
+    return m_maskLastPassed;
+}
+
+bool SerialHandler::recording() const
+{
+    return m_recorder.isOpen();
+}
+
+quint64 SerialHandler::recordedFrames() const
+{
+    return m_recorder.frameCount();
+}
+
+QString SerialHandler::playbackPath() const
+{
+    return m_playback.isOpen() ? m_playback.path() : QString();
+}
+
+double SerialHandler::playbackDuration() const
+{
+    return m_playback.isOpen() && m_playback.sampleRate() > 0
+           ? m_playback.sampleCount() / m_playback.sampleRate() : 0.0;
+}
+
+bool SerialHandler::overviewReady() const
+{
+    return m_pyramid.isOpen();
+}
+
+bool SerialHandler::searchRunning() const
+{
+    return m_searchWatcher.isRunning();
+}
+
+int SerialHandler::eventCount() const
+{
+    return m_events.size();
+}
+
+int SerialHandler::currentEvent() const
+{
+    return m_currentEvent;
+}
+
+bool SerialHandler::exporting() const
+{
+    return m_exportWatcher.isRunning();
+}
+
+double SerialHandler::exportProgress() const
+{
+    return m_exportProgress;
+}
+
+bool SerialHandler::journaling() const
+{
+    return m_journal.isOpen();
+}
+
+bool SerialHandler::replaying() const
+{
+    return m_replay.isOpen();
+}
+
+QVariantMap SerialHandler::frameStats() const
+{
+    QVariantMap stats;
+    stats["allocations"] = m_frameAllocations;
+    stats["pooledFrames"] = m_framePoolSize;
+    return stats;
+}
+
+QVariantMap SerialHandler::replayStats() const
+{
+    const double seconds = m_replayParseTime * 1e-9;
+    QVariantMap stats;
+    stats["records"] = m_replayRecords;
+    stats["bytes"] = m_replayBytes;
+    stats["parseSeconds"] = seconds;
+    stats["bytesPerSecond"] = seconds > 0 ? m_replayBytes / seconds : 0.0;
+    stats["progress"] = m_replay.size() > 0 ? double(m_replay.position()) / m_replay.size() : 0.0;
+    return stats;
+}
+
+bool SerialHandler::streaming() const
+{
+    return m_stream.isListening();
+}
+
+QVariantMap SerialHandler::streamStats() const
+{
+    QVariantMap stats;
+    stats["port"] = m_stream.port();
+    stats["clients"] = m_stream.clientCount();
+    stats["dropped"] = m_stream.droppedMessages();
+    return stats;
+}
+
+bool SerialHandler::sharing() const
+{
+    return m_sharedRing.isOpen();
+}
+
+bool SerialHandler::rollMode() const
+{
+    return m_rollMode;
+}
+
+double SerialHandler::rollSpan() const
+{
+    return m_rollSpan;
+}
+
 void SerialHandler::refreshPorts()
 {
-    emit portsChanged();
+    m_portMonitor.refresh();
 }
 
 bool SerialHandler::connectToPort(const QString &portName)
@@ -96,8 +457,15 @@ bool SerialHandler::connectToPort(const QString &portName)
     m_serial->setStopBits(QSerialPort::OneStop);
     m_serial->setFlowControl(QSerialPort::NoFlowControl);
 
+    // An emulated roll stream does not carry over to the device
+    if (m_rollRunning) stopCapture();
+
     if (m_serial->open(QIODevice::ReadWrite)) {
         m_connected = true;
+        // Whatever the device held before is unknown until it confirms one
+        m_deviceRecordLength = 0;
+        m_requestedRecordLength = 0;
+        setRecordLength(m_recordLength);
         m_statusMessage = tr("Connected to %1").arg(portName);
         emit connectionChanged();
         emit statusChanged(m_statusMessage);
@@ -111,10 +479,16 @@ bool SerialHandler::connectToPort(const QString &portName)
 
 void SerialHandler::disconnectPort()
 {
+    if (m_rollRunning) stopCapture();
     if (m_serial->isOpen()) {
         m_serial->close();
     }
     m_connected = false;
+    m_requestedRecordLength = 0;
+    m_recordLengthReply.clear();
+    m_recordLengthTimer.stop();
+    m_captureRunning = false;
+    m_captureDeferred = false;
     m_statusMessage = tr("Disconnected");
     emit connectionChanged();
     emit statusChanged(m_statusMessage);
@@ -124,7 +498,9 @@ void SerialHandler::setupScope(int triggerMode, int triggerPolarity, int display
                                double ch1Gain, double ch2Gain, int ch1Offset, int ch2Offset,
                                int triggerLevel, int sampleRate)
 {
-    if (!m_connected) return;
+    // Frames captured with the old settings must not be combined with new ones
+    resetAcquisition();
+    ++m_settingsRevision;
 
     // Convert gains to command values (0-5)
     int ch1GainCmd = 1; // Default to 1x
@@ -143,6 +519,16 @@ void SerialHandler::setupScope(int triggerMode, int triggerPolarity, int display
     else if (ch2Gain == 8.0) ch2GainCmd = 4;
     else if (ch2Gain == 16.0) ch2GainCmd = 5;
 
+    // Conversion follows the selected range even without a device, so the
+    // emulated front end and the tables stay in step
+    m_calibration.select(0, ch1GainCmd, ch1Offset);
+    m_calibration.select(1, ch2GainCmd, ch2Offset);
+    setSampleRate(sampleRate);
+    setRecordLength(m_recordLength);
+    checkRecordingScale();
+
+    if (!m_connected) return;
+
     // Set trigger mode (T command)
     QByteArray trigCmd;
     trigCmd.append(0x54); // 'T'
@@ -165,27 +551,12 @@ void SerialHandler::setupScope(int triggerMode, int triggerPolarity, int display
     sendCommand(modeCmd);
 
     // Set gains (G command)
-    QByteArray gainCmd;
-    gainCmd.append(0x47); // 'G'
-    gainCmd.append(static_cast<char>(0x00)); // CH1
-    gainCmd.append(static_cast<char>(ch1GainCmd));
-    sendCommand(gainCmd);
-
-    gainCmd[1] = static_cast<char>(0x01); // CH2
-    gainCmd[2] = static_cast<char>(ch2GainCmd);
-    sendCommand(gainCmd);
+    sendGain(0, ch1GainCmd);
+    sendGain(1, ch2GainCmd);
 
     // Set offsets (O and o commands)
-    QByteArray offsetCmd;
-    offsetCmd.append(0x4F); // 'O' for CH1
-    offsetCmd.append(static_cast<char>((ch1Offset >> 8) & 0xFF));
-    offsetCmd.append(static_cast<char>(ch1Offset & 0xFF));
-    sendCommand(offsetCmd);
-
-    offsetCmd[0] = 0x6F; // 'o' for CH2
-    offsetCmd[1] = static_cast<char>((ch2Offset >> 8) & 0xFF);
-    offsetCmd[2] = static_cast<char>(ch2Offset & 0xFF);
-    sendCommand(offsetCmd);
+    sendOffset(0, ch1Offset);
+    sendOffset(1, ch2Offset);
 
     // Set trigger level (L command)
     QByteArray trigLevelCmd;
@@ -193,23 +564,171 @@ void SerialHandler::setupScope(int triggerMode, int triggerPolarity, int display
     trigLevelCmd.append(static_cast<char>((triggerLevel >> 8) & 0xFF));
     trigLevelCmd.append(static_cast<char>(triggerLevel & 0xFF));
     sendCommand(trigLevelCmd);
+}
+
+void SerialHandler::setSampleRate(int index)
+{
+    // Timebase settings in command order, from 2 MS/s down to 100 S/s
+    static const double rates[] = {
+        2e6, 1e6, 500e3, 200e3, 100e3, 50e3, 20e3, 10e3, 5e3, 2e3, 1e3, 500, 200, 100
+    };
+    const int count = int(sizeof(rates) / sizeof(rates[0]));
+    if (index < 0 || index >= count) return;
 
     // Set sample rate (S command)
     QByteArray sampleRateCmd;
     sampleRateCmd.append(0x53); // 'S'
-    sampleRateCmd.append(static_cast<char>(sampleRate));
+    sampleRateCmd.append(static_cast<char>(index));
     sampleRateCmd.append(static_cast<char>(0x00));
     sendCommand(sampleRateCmd);
+
+    if (index == m_sampleRateIndex) return;
+    m_sampleRateIndex = index;
+    m_sampleRate = rates[index];
+    ++m_settingsRevision;
+    m_distortion.reset();
+    m_crossChannel.reset();
+    checkRecordingScale();
+    emit sampleRateChanged();
+
+    if (m_rollMode) {
+        if (m_sampleRate > RollMaxSampleRate) {
+            setRollMode(false);
+        } else {
+            configureRoll();
+            emit rollModeChanged();
+        }
+    }
+}
+
+void SerialHandler::setRecordLength(int length)
+{
+    length = qBound(MinRecordLength, length, MaxRecordLength);
+
+    // Set record length (R command), sent as length - 1 so 64k fits. Only a
+    // length the device does not already hold is sent; it answers with the
+    // length it accepted (see confirmRecordLength)
+    if (m_connected && length != m_deviceRecordLength && length != m_requestedRecordLength) {
+        // Samples in flight could pass for the reply, so a running capture
+        // stops and resumes once the reply is in
+        const bool resume = m_captureRunning || m_captureDeferred || m_rollRunning;
+        const bool continuous = m_captureContinuous;
+        if (resume) stopCapture();
+
+        QByteArray lengthCmd;
+        lengthCmd.append(0x52); // 'R'
+        lengthCmd.append(static_cast<char>(((length - 1) >> 8) & 0xFF));
+        lengthCmd.append(static_cast<char>((length - 1) & 0xFF));
+        sendCommand(lengthCmd);
+        m_requestedRecordLength = length;
+        m_recordLengthReply.clear();
+        m_recordLengthTimer.start();
+        if (resume) runCapture(continuous);
+    }
+    applyRecordLength(length);
+}
+
+void SerialHandler::confirmRecordLength(int length)
+{
+    m_requestedRecordLength = 0;
+    m_recordLengthReply.clear();
+    m_recordLengthTimer.stop();
+    m_deviceRecordLength = length;
+
+    // The device may hold fewer samples than asked for; its length wins
+    if (length != m_recordLength) {
+        applyRecordLength(length);
+        m_statusMessage = tr("Device record length is %1 samples").arg(length);
+        emit statusChanged(m_statusMessage);
+    }
+
+    if (m_captureDeferred) {
+        m_captureDeferred = false;
+        runCapture(m_captureContinuous);
+    }
+}
+
+void SerialHandler::applyRecordLength(int length)
+{
+    if (length == m_recordLength) return;
+    m_recordLength = length;
+    ++m_settingsRevision;
+
+    // Everything sized per frame follows on the next capture; only what
+    // would mix frames of different lengths is reset here
+    m_frameAssembler.configure(Calibration::Channels, sampleBytes(m_sampleFormat, length));
+    m_codes.configure(Calibration::Channels, length);
+    if (m_sampleFormat != Bits8) m_wideCodes.configure(Calibration::Channels, length);
+    m_frame.reset();
+    m_minimum.reset();
+    m_volts.clear();
+    m_voltsCurrent = false;
+    resetAcquisition();
+    m_distortion.reset();
+    m_crossChannel.reset();
+    if (m_recorder.isOpen()) stopRecording();
+    if (!m_mask.isEmpty() && m_mask.length() != length) clearMask();
+    emit recordLengthChanged();
+}
+
+void SerialHandler::setSampleFormat(int format)
+{
+    // Describes the attached converter; the device sends in its native
+    // format, so nothing is negotiated
+    const SampleFormat sampleFormat = static_cast<SampleFormat>(qBound<int>(Bits8, format, Little16));
+    if (sampleFormat == m_sampleFormat) return;
+    m_sampleFormat = sampleFormat;
+    ++m_settingsRevision;
+
+    m_frameAssembler.configure(Calibration::Channels, sampleBytes(m_sampleFormat, m_recordLength));
+    if (m_sampleFormat != Bits8) m_wideCodes.configure(Calibration::Channels, m_recordLength);
+    m_rollPending.clear();
+    resetAcquisition();
+    m_distortion.reset();
+    m_crossChannel.reset();
+    emit sampleFormatChanged();
+}
+
+void SerialHandler::sendGain(int channel, int gainIndex)
+{
+    QByteArray gainCmd;
+    gainCmd.append(0x47); // 'G'
+    gainCmd.append(static_cast<char>(channel));
+    gainCmd.append(static_cast<char>(gainIndex));
+    sendCommand(gainCmd);
+}
+
+void SerialHandler::sendOffset(int channel, int offsetSetting)
+{
+    QByteArray offsetCmd;
+    offsetCmd.append(channel == 0 ? 0x4F : 0x6F); // 'O' for CH1, 'o' for CH2
+    offsetCmd.append(static_cast<char>((offsetSetting >> 8) & 0xFF));
+    offsetCmd.append(static_cast<char>(offsetSetting & 0xFF));
+    sendCommand(offsetCmd);
 }
 
 void SerialHandler::runCapture(bool continuous)
 {
+    if (m_connected && m_requestedRecordLength > 0) {
+        m_captureDeferred = true;
+        m_captureContinuous = continuous;
+        return;
+    }
+
+    // Rolling has no single or repeated frames, only the stream
+    if (m_rollMode) {
+        startRoll();
+        return;
+    }
+
     if (!m_connected) {
         // Generate some test data for demonstration
         generateTestData();
         return;
     }
 
+    m_captureRunning = true;
+    m_captureContinuous = continuous;
     QByteArray captureCmd;
     captureCmd.append(0x43); // 'C'
     captureCmd.append(static_cast<char>(continuous ? 0x01 : 0x00));
@@ -219,6 +738,13 @@ void SerialHandler::runCapture(bool continuous)
 
 void SerialHandler::stopCapture()
 {
+    // A stopped roll keeps its history on screen until the next Run
+    if (m_rollRunning) {
+        m_rollRunning = false;
+        m_rollTimer.stop();
+    }
+    m_captureRunning = false;
+    m_captureDeferred = false;
     if (!m_connected) return;
 
     QByteArray stopCmd;
@@ -319,6 +845,8 @@ quint16 SerialHandler::calculatePhaseStep(double frequency, quint32 clockFrequen
 
 void SerialHandler::runDDS()
 {
+    m_ddsRunning = true;
+
     if (!m_connected) {
         m_statusMessage = "DDS started (not connected)";
         emit statusChanged(m_statusMessage);
@@ -348,6 +876,8 @@ void SerialHandler::runDDS()
 
 void SerialHandler::stopDDS()
 {
+    m_ddsRunning = false;
+
     if (!m_connected) return;
 
     QByteArray stopCmd;
@@ -423,98 +953,1485 @@ void SerialHandler::stopSweep()
     emit statusChanged(m_statusMessage);
 }
 
-void SerialHandler::generateTestData()
+void SerialHandler::setInterpolationMode(int mode)
+{
+    if (mode == m_interpolator.mode()) return;
+    m_interpolator.setMode(mode == SincInterpolation ? Interpolator::SincInterpolation
+                                                     : Interpolator::LinearInterpolation);
+    emit interpolationChanged();
+    publishFrame();
+}
+
+void SerialHandler::setInterpolationFactor(int factor)
 {
-    // Generate some test oscilloscope data for demonstration
-    QVector<QPointF> ch1Data;
-    QVector<QPointF> ch2Data;
+    if (factor == m_interpolator.factor()) return;
+    m_interpolator.setFactor(factor);
+    emit interpolationChanged();
+    publishFrame();
+}
 
-    for (int i = 0; i < 200; i++) {
-        double x = i;
-        double y1 = 5.0 * qSin(2 * M_PI * i / 50.0); // 5V amplitude sine wave
-        double y2 = 3.0 * qSin(2 * M_PI * i / 25.0 + M_PI/4); // 3V amplitude, phase shifted
+void SerialHandler::setVisibleWindow(int first, int last)
+{
+    if (first == m_visibleFirst && last == m_visibleLast) return;
+    m_visibleFirst = first;
+    m_visibleLast = last;
+    publishFrame();
+}
 
-        ch1Data.append(QPointF(x, y1));
-        ch2Data.append(QPointF(x, y2));
+void SerialHandler::setAcquisitionMode(int mode)
+{
+    if (mode == acquisitionMode()) return;
+    const FrameAccumulator::Mode accMode =
+        static_cast<FrameAccumulator::Mode>(qBound<int>(FrameAccumulator::Normal, mode,
+                                                        FrameAccumulator::HighResolution));
+    for (FrameAccumulator &accumulator : m_accumulators) {
+        accumulator.configure(accMode, m_recordLength, accumulator.depth(), accumulator.codeBytes());
     }
+    emit acquisitionChanged();
+}
 
-    emit dataReceived(pointsToVariantList(ch1Data), pointsToVariantList(ch2Data));
+void SerialHandler::setAcquisitionDepth(int depth)
+{
+    if (depth == acquisitionDepth()) return;
+    for (FrameAccumulator &accumulator : m_accumulators) {
+        accumulator.configure(accumulator.mode(), m_recordLength, depth, accumulator.codeBytes());
+    }
+    emit acquisitionChanged();
 }
 
-void SerialHandler::handleReadyRead()
+void SerialHandler::resetAcquisition()
 {
-    QByteArray data = m_serial->readAll();
-    processIncomingData(data);
+    for (FrameAccumulator &accumulator : m_accumulators) accumulator.reset();
+    m_equivalentTime.reset();
+    emit acquisitionChanged();
+    emit equivalentTimeChanged();
 }
 
-void SerialHandler::handleError(QSerialPort::SerialPortError error)
+void SerialHandler::setDftEnabled(bool enabled)
 {
-    if (error == QSerialPort::NoError) return;
+    if (enabled == m_dftEnabled) return;
+    m_dftEnabled = enabled;
+    emit dftEnabledChanged();
+}
 
-    m_statusMessage = tr("Serial Error: %1").arg(m_serial->errorString());
-    emit statusChanged(m_statusMessage);
+void SerialHandler::setDistortionEnabled(bool enabled)
+{
+    if (enabled == m_distortionEnabled) return;
+    m_distortionEnabled = enabled;
+    m_distortion.reset();
+    emit distortionSettingsChanged();
+    emit distortionChanged();
+}
 
-    if (error == QSerialPort::ResourceError) {
-        disconnectPort();
-    }
+void SerialHandler::setDistortionChannel(int channel)
+{
+    if (channel == m_distortionChannel || channel < 0 || channel > 1) return;
+    m_distortionChannel = channel;
+    m_distortion.reset();
+    emit distortionSettingsChanged();
 }
 
-void SerialHandler::processIncomingData(const QByteArray &data)
+void SerialHandler::setDistortionAverages(int averages)
 {
-    if (data.isEmpty()) return;
+    if (averages == m_distortion.averages()) return;
+    m_distortion.setAverages(averages);
+    emit distortionSettingsChanged();
+}
 
-    // Parse incoming data based on expected format
-    if (data.size() >= 400) { // Assuming scope data
-        QVector<QPointF> ch1Data;
-        QVector<QPointF> ch2Data;
-
-        // Parse data into points
-        for (int i = 0; i < 200 && i < (data.size() / 2); i++) {
-            // CH1 data (first 200 bytes)
-            double x = i;
-            double y = static_cast<quint8>(data[i]) * 20.0 / 255.0 - 10.0;
-            ch1Data.append(QPointF(x, y));
-
-            // CH2 data (next 200 bytes)
-            if (i + 200 < data.size()) {
-                y = static_cast<quint8>(data[i+200]) * 20.0 / 255.0 - 10.0;
-                ch2Data.append(QPointF(x, y));
-            }
-        }
+void SerialHandler::setCrossChannelEnabled(bool enabled)
+{
+    if (enabled == m_crossChannelEnabled) return;
+    m_crossChannelEnabled = enabled;
+    m_crossChannel.reset();
+    emit crossChannelSettingsChanged();
+    emit crossChannelChanged();
+}
 
-        emit dataReceived(pointsToVariantList(ch1Data), pointsToVariantList(ch2Data));
-    } else if (data.size() == 1) { // Digital inputs response
-        quint8 inputs = static_cast<quint8>(data[0]);
-        emit digitalInputsChanged(inputs);
-    }
+void SerialHandler::setCrossChannelAverages(int averages)
+{
+    if (averages == m_crossChannel.averages()) return;
+    m_crossChannel.setAverages(averages);
+    emit crossChannelSettingsChanged();
+}
+
+void SerialHandler::setMaskEnabled(bool enabled)
+{
+    if (enabled == m_maskEnabled) return;
+    m_maskEnabled = enabled;
+    emit maskSettingsChanged();
 }
 
-void SerialHandler::calculateDFT(const QVector<QPointF> &timeData)
+void SerialHandler::setMaskChannel(int channel)
 {
-    if (timeData.isEmpty()) return;
+    if (channel == m_maskChannel || channel < 0 || channel > 1) return;
+    m_maskChannel = channel;
+    resetMaskCounters();
+    emit maskSettingsChanged();
+}
 
-    const int N = timeData.size();
-    QVector<QPointF> dftData;
+void SerialHandler::setMaskSaveFailures(bool save)
+{
+    if (save == m_maskSaveFailures) return;
+    m_maskSaveFailures = save;
+    emit maskSettingsChanged();
+}
 
-    // Only calculate first half of DFT (Nyquist frequency)
-    for (int k = 0; k < N/2; k++) {
-        double real = 0.0;
-        double imag = 0.0;
+void SerialHandler::setMaskFromReference(double tolerance, int horizontal)
+{
+    // The latest frame of the masked channel is the golden waveform
+    const VoltFrame &volts = currentVolts();
+    if (volts.isEmpty()) {
+        m_statusMessage = tr("Capture a reference frame before creating a mask");
+        emit statusChanged(m_statusMessage);
+        return;
+    }
 
-        for (int n = 0; n < N; n++) {
-            double angle = 2 * M_PI * k * n / N;
-            real += timeData[n].y() * qCos(angle);
-            imag -= timeData[n].y() * qSin(angle);
-        }
+    m_mask.setReference(volts.channel(m_maskChannel), volts.length(),
+                        static_cast<float>(tolerance), horizontal);
+    publishMask();
+}
 
-        double magnitude = qSqrt(real*real + imag*imag) * 2.0 / N;
-        double frequency = k * 1000.0 / N; // Assuming 1kHz sample rate
-        dftData.append(QPointF(frequency, magnitude));
+bool SerialHandler::loadMask(const QString &path)
+{
+    QString error;
+    if (!m_mask.load(path, m_recordLength, &error)) {
+        m_statusMessage = tr("Failed to load mask: %1").arg(error);
+        emit statusChanged(m_statusMessage);
+        return false;
+    }
+
+    m_statusMessage = tr("Mask loaded from %1").arg(path);
+    emit statusChanged(m_statusMessage);
+    publishMask();
+    return true;
+}
+
+bool SerialHandler::saveMask(const QString &path)
+{
+    QString error;
+    if (!m_mask.save(path, &error)) {
+        m_statusMessage = tr("Failed to save mask: %1").arg(error);
+        emit statusChanged(m_statusMessage);
+        return false;
+    }
+
+    m_statusMessage = tr("Mask saved to %1").arg(path);
+    emit statusChanged(m_statusMessage);
+    return true;
+}
+
+void SerialHandler::clearMask()
+{
+    m_mask.clear();
+    publishMask();
+}
+
+void SerialHandler::resetMaskCounters()
+{
+    m_mask.resetCounters();
+    m_maskLastPassed = true;
+    m_maskSavedFailures = 0;
+    emit maskResultsChanged();
+}
+
+void SerialHandler::publishMask()
+{
+    QVector<QPointF> upper;
+    QVector<QPointF> lower;
+    for (int i = 0; i < m_mask.length(); ++i) {
+        if (qIsFinite(m_mask.upper()[i])) upper.append(QPointF(i, m_mask.upper()[i]));
+        if (qIsFinite(m_mask.lower()[i])) lower.append(QPointF(i, m_mask.lower()[i]));
+    }
+    emit maskChanged(pointsToVariantList(upper), pointsToVariantList(lower));
+    resetMaskCounters();
+}
+
+void SerialHandler::testMask()
+{
+    const VoltFrame &volts = currentVolts();
+    m_maskLastPassed = m_mask.test(volts.channel(m_maskChannel), volts.length());
+    if (!m_maskLastPassed && m_maskSaveFailures && m_maskSavedFailures < MaxSavedMaskFailures) {
+        saveMaskFailure();
+    }
+    emit maskResultsChanged();
+}
+
+void SerialHandler::saveMaskFailure()
+{
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/mask-failures";
+    QDir().mkpath(dir);
+    QFile file(dir + "/failure-" + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss-zzz")
+               + QString("-%1.csv").arg(m_mask.failed()));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return;
+
+    const VoltFrame &volts = currentVolts();
+    QByteArray text("sample");
+    for (int c = 0; c < volts.channels(); ++c) text += ",ch" + QByteArray::number(c + 1);
+    text += ",upper,lower\n";
+    for (int i = 0; i < volts.length(); ++i) {
+        const bool masked = i < m_mask.length();
+        text += QByteArray::number(i) + ',';
+        for (int c = 0; c < volts.channels(); ++c) text += QByteArray::number(volts.channel(c)[i]) + ',';
+        text += (masked ? QByteArray::number(m_mask.upper()[i]) : QByteArray()) + ','
+                + (masked ? QByteArray::number(m_mask.lower()[i]) : QByteArray()) + '\n';
+    }
+    file.write(text);
+    ++m_maskSavedFailures;
+}
+
+bool SerialHandler::startRecording(const QString &path)
+{
+    QString file = path;
+    if (file.isEmpty()) {
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/recordings";
+        QDir().mkpath(dir);
+        file = dir + "/capture-" + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + ".sxr";
+    }
+
+    QString error;
+    if (!m_recorder.open(file, m_recordLength, m_sampleRate, m_calibration, &error)) {
+        m_statusMessage = tr("Failed to start recording: %1").arg(error);
+        emit statusChanged(m_statusMessage);
+        return false;
+    }
+
+    m_pyramidBuilder.begin(Calibration::Channels, m_recordLength);
+    m_recordingPath = file;
+    m_recordingPart = 1;
+    m_statusMessage = tr("Recording to %1").arg(file);
+    emit statusChanged(m_statusMessage);
+    emit recordingChanged();
+    return true;
+}
+
+void SerialHandler::stopRecording()
+{
+    if (!m_recorder.isOpen()) return;
+
+    const QString file = m_recorder.path();
+    const quint64 frames = m_recorder.frameCount();
+    m_recorder.close();
+    m_pyramidBuilder.save(file);
+    m_statusMessage = tr("Recorded %1 frames to %2").arg(frames).arg(file);
+    emit statusChanged(m_statusMessage);
+    emit recordingChanged();
+}
+
+void SerialHandler::checkRecordingScale()
+{
+    if (!m_recorder.isOpen() || m_recorder.matches(m_sampleRate, m_calibration)) return;
+
+    // Close the part so far and carry on in "<name>-<part>.<suffix>"
+    const QString previous = m_recorder.path();
+    m_recorder.close();
+    m_pyramidBuilder.save(previous);
+
+    const QFileInfo info(m_recordingPath);
+    const QString file = info.path() + "/" + info.completeBaseName() + "-" + QString::number(++m_recordingPart)
+                         + "." + info.suffix();
+    QString error;
+    if (!m_recorder.open(file, m_recordLength, m_sampleRate, m_calibration, &error)) {
+        m_statusMessage = tr("Recording stopped, the scale changed and %1 could not be opened: %2")
+                              .arg(file, error);
+        emit statusChanged(m_statusMessage);
+        emit recordingChanged();
+        return;
+    }
+
+    m_pyramidBuilder.begin(Calibration::Channels, m_recordLength);
+    m_statusMessage = tr("Scale changed; recording continues in %1").arg(file);
+    emit statusChanged(m_statusMessage);
+    emit recordingChanged();
+}
+
+bool SerialHandler::openRecording(const QString &path)
+{
+    closeRecording();
+
+    QString error;
+    if (!m_playback.open(path, &error)) {
+        m_statusMessage = tr("Failed to open recording: %1").arg(error);
+        emit statusChanged(m_statusMessage);
+        return false;
+    }
+
+    // A stale or missing summary is rebuilt by the first search
+    m_summary.load(m_playback);
+    if (!m_pyramid.open(m_playback)) {
+        m_pyramidWatcher.setFuture(QtConcurrent::run([this]() {
+            return RecordingPyramid::build(m_playback);
+        }));
+    }
+    m_statusMessage = tr("Opened %1: %2 frames of %3 samples")
+                          .arg(path).arg(m_playback.frameCount()).arg(m_playback.recordLength());
+    emit statusChanged(m_statusMessage);
+    emit playbackChanged();
+    emit overviewChanged();
+    return true;
+}
+
+void SerialHandler::closeRecording()
+{
+    if (!m_playback.isOpen()) return;
+
+    m_exportCancel = true;
+    m_exportWatcher.waitForFinished();
+    m_searchWatcher.waitForFinished();
+    m_pyramidWatcher.waitForFinished();
+    m_pyramid.close();
+    m_playback.close();
+    m_summary.clear();
+    m_events.clear();
+    m_searchDone = false;
+    m_currentEvent = -1;
+    emit playbackChanged();
+    emit overviewChanged();
+    emit searchChanged();
+}
+
+void SerialHandler::finishPyramid()
+{
+    if (m_pyramidWatcher.result() && m_playback.isOpen() && m_pyramid.open(m_playback)) {
+        emit overviewChanged();
+    }
+}
+
+void SerialHandler::searchRecording(int type, int channel, double level, double width, bool negative)
+{
+    if (!m_playback.isOpen() || m_searchWatcher.isRunning()) return;
+
+    EventSearch::Query query;
+    query.type = static_cast<EventSearch::Type>(qBound(0, type, int(EventSearch::WidePulse)));
+    query.channel = channel;
+    query.level = level;
+    query.width = width;
+    query.negative = negative;
+
+    // Stepping through the results of the same query needs no new search
+    if (m_searchDone && query == m_searchQuery) {
+        nextEvent();
+        return;
+    }
+    m_searchQuery = query;
+    m_searchDone = false;
+
+    m_searchWatcher.setFuture(QtConcurrent::run([this, query]() {
+        if (!m_summary.isValid()) {
+            m_summary.build(m_playback);
+            m_summary.save(m_playback);
+        }
+        return EventSearch::run(m_playback, &m_summary, query);
+    }));
+    m_statusMessage = tr("Searching %1").arg(m_playback.path());
+    emit statusChanged(m_statusMessage);
+    emit searchChanged();
+}
+
+void SerialHandler::finishSearch()
+{
+    m_events = m_searchWatcher.result();
+    m_searchDone = true;
+    m_currentEvent = -1;
+    m_statusMessage = tr("Found %1 events").arg(m_events.size());
+    emit statusChanged(m_statusMessage);
+    emit searchChanged();
+    if (!m_events.isEmpty()) showEvent(0);
+}
+
+void SerialHandler::showEvent(int index)
+{
+    if (!m_playback.isOpen() || index < 0 || index >= m_events.size()) return;
+
+    const EventSearch::Event &event = m_events[index];
+    const int length = m_playback.recordLength();
+    const quint64 frame = event.position / length;
+    m_volts.configure(m_playback.channels(), length);
+    for (int c = 0; c < m_playback.channels(); ++c) {
+        const quint8 *codes = m_playback.frame(frame, c);
+        const float *table = m_playback.voltsTable(c);
+        float *volts = m_volts.channel(c);
+        for (int i = 0; i < length; ++i) volts[i] = table[codes[i]];
+    }
+    m_volts.info.timestamp = m_frameClock.nsecsElapsed();
+    m_volts.info.sampleRate = m_playback.sampleRate();
+    m_voltsCurrent = true;
+    m_minimum.reset();
+    m_sampleSpacing = 1.0;
+
+    m_currentEvent = index;
+    emit searchChanged();
+    publishFrame();
+    emit eventShown(index, static_cast<int>(event.position % length), event.width);
+}
+
+void SerialHandler::nextEvent()
+{
+    if (m_events.isEmpty()) return;
+    showEvent((m_currentEvent + 1) % m_events.size());
+}
+
+void SerialHandler::previousEvent()
+{
+    if (m_events.isEmpty()) return;
+    showEvent(m_currentEvent > 0 ? m_currentEvent - 1 : m_events.size() - 1);
+}
+
+void SerialHandler::exportFrame(const QString &path, int format)
+{
+    if (m_voltsCurrent ? m_volts.isEmpty() : m_frame.isNull()) {
+        m_statusMessage = tr("Capture a frame before exporting");
+        emit statusChanged(m_statusMessage);
+        return;
+    }
+
+    // The frame as displayed, so an equivalent-time composite exports at
+    // its effective rate; a frame of codes is converted as it is written
+    startExport(path, format, m_voltsCurrent ? ExportSource::fromFrame(m_volts) : ExportSource::fromFrame(m_frame));
+}
+
+void SerialHandler::exportRecording(const QString &path, int format)
+{
+    if (!m_playback.isOpen()) {
+        m_statusMessage = tr("Open a recording before exporting it");
+        emit statusChanged(m_statusMessage);
+        return;
+    }
+    startExport(path, format, ExportSource::fromRecording(m_playback));
+}
+
+void SerialHandler::cancelExport()
+{
+    m_exportCancel = true;
+}
+
+void SerialHandler::startExport(const QString &path, int format, const ExportSource &source)
+{
+    if (m_exportWatcher.isRunning()) return;
+
+    const Exporter::Format exportFormat = static_cast<Exporter::Format>(qBound(0, format, int(Exporter::Wav)));
+    m_exportPath = path;
+    if (m_exportPath.isEmpty()) {
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/exports";
+        QDir().mkpath(dir);
+        m_exportPath = dir + "/export-" + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss")
+                       + "." + Exporter::suffix(exportFormat);
+    }
+
+    m_exportProgress = 0.0;
+    m_exportCancel = false;
+    const QString file = m_exportPath;
+    m_exportWatcher.setFuture(QtConcurrent::run([this, file, exportFormat, source]() {
+        QString error;
+        Exporter::write(file, exportFormat, source, [this](double done) {
+            QMetaObject::invokeMethod(this, [this, done]() {
+                m_exportProgress = done;
+                emit exportChanged();
+            }, Qt::QueuedConnection);
+            return !m_exportCancel;
+        }, &error);
+        return error;
+    }));
+    emit exportChanged();
+}
+
+void SerialHandler::finishExport()
+{
+    const QString error = m_exportWatcher.result();
+    m_statusMessage = error.isEmpty() ? tr("Exported to %1").arg(m_exportPath)
+                                      : tr("Export failed: %1").arg(error);
+    emit statusChanged(m_statusMessage);
+    emit exportChanged();
+}
+
+bool SerialHandler::startJournal(const QString &path)
+{
+    QString file = path;
+    if (file.isEmpty()) {
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/journals";
+        QDir().mkpath(dir);
+        file = dir + "/serial-" + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + ".sxj";
+    }
+
+    QString error;
+    if (!m_journal.open(file, &error)) {
+        m_statusMessage = tr("Failed to start journal: %1").arg(error);
+        emit statusChanged(m_statusMessage);
+        return false;
+    }
+
+    m_statusMessage = tr("Journaling serial traffic to %1").arg(file);
+    emit statusChanged(m_statusMessage);
+    emit journalChanged();
+    return true;
+}
+
+void SerialHandler::stopJournal()
+{
+    if (!m_journal.isOpen()) return;
+
+    m_statusMessage = tr("Journal %1 closed after %2 records").arg(m_journal.path()).arg(m_journal.records());
+    m_journal.close();
+    emit statusChanged(m_statusMessage);
+    emit journalChanged();
+}
+
+bool SerialHandler::startReplay(const QString &path, double speed)
+{
+    stopReplay();
+
+    QString error;
+    if (!m_replay.open(path, &error)) {
+        m_statusMessage = tr("Failed to open journal: %1").arg(error);
+        emit statusChanged(m_statusMessage);
+        return false;
+    }
+
+    m_replaySpeed = qMax(0.0, speed);
+    m_replayPending = false;
+    m_replayRecords = 0;
+    m_replayBytes = 0;
+    m_replayParseTime = 0;
+    m_replayClock.start();
+    // Record times restart from zero, so nothing live may be joined to them
+    m_frameAssembler.reset();
+    emit replayChanged();
+    replayStep();
+    return true;
+}
+
+void SerialHandler::stopReplay()
+{
+    if (!m_replay.isOpen()) return;
+
+    m_replayTimer.stop();
+    m_replay.close();
+    m_frameAssembler.reset();
+    emit replayChanged();
+}
+
+bool SerialHandler::startStreaming(int port, bool lan)
+{
+    QString error;
+    if (port < 0 || port > 65535
+        || !m_stream.listen(lan ? QHostAddress::Any : QHostAddress::LocalHost, quint16(port), &error)) {
+        m_statusMessage = tr("Failed to start streaming: %1").arg(error.isEmpty() ? tr("invalid port") : error);
+        emit statusChanged(m_statusMessage);
+        emit streamChanged();
+        return false;
+    }
+
+    m_statusMessage = tr("Streaming on port %1").arg(m_stream.port());
+    emit statusChanged(m_statusMessage);
+    emit streamChanged();
+    return true;
+}
+
+void SerialHandler::stopStreaming()
+{
+    if (!m_stream.isListening()) return;
+
+    m_stream.close();
+    m_statusMessage = tr("Streaming stopped");
+    emit statusChanged(m_statusMessage);
+    emit streamChanged();
+}
+
+bool SerialHandler::startSharing(const QString &name)
+{
+    QString error;
+    if (!m_sharedRing.open(name, SharedRingSlots, Calibration::Channels, MaxRecordLength, &error)) {
+        m_statusMessage = tr("Failed to share frames: %1").arg(error);
+        emit statusChanged(m_statusMessage);
+        emit sharingChanged();
+        return false;
+    }
+
+    m_statusMessage = tr("Sharing frames in %1").arg(m_sharedRing.name());
+    emit statusChanged(m_statusMessage);
+    emit sharingChanged();
+    return true;
+}
+
+void SerialHandler::stopSharing()
+{
+    if (!m_sharedRing.isOpen()) return;
+
+    m_statusMessage = tr("Shared ring %1 closed after %2 frames").arg(m_sharedRing.name()).arg(m_sharedRing.published());
+    m_sharedRing.close();
+    emit statusChanged(m_statusMessage);
+    emit sharingChanged();
+}
+
+void SerialHandler::setRollMode(bool enabled)
+{
+    if (enabled == m_rollMode) return;
+
+    // The link carries every conversion as it happens, so only slow
+    // timebases fit; faster ones stay with triggered frames
+    if (enabled && m_sampleRate > RollMaxSampleRate) {
+        m_statusMessage = tr("Roll mode needs a sample rate of %1 S/s or less").arg(RollMaxSampleRate);
+        emit statusChanged(m_statusMessage);
+        emit rollModeChanged();
+        return;
+    }
+
+    // Whatever was running stops; Run starts the new mode
+    stopCapture();
+    m_rollMode = enabled;
+    m_frameAssembler.reset();
+    m_rollPending.clear();
+    if (enabled) {
+        configureRoll();
+        m_statusMessage = tr("Roll mode at %1 S/s; Run starts the stream").arg(m_sampleRate);
+    } else {
+        m_statusMessage = tr("Roll mode off");
+    }
+    emit statusChanged(m_statusMessage);
+    emit rollModeChanged();
+}
+
+void SerialHandler::setRollSpan(double seconds)
+{
+    seconds = qBound(1.0, seconds, 60.0);
+    if (qFuzzyCompare(seconds, m_rollSpan)) return;
+    m_rollSpan = seconds;
+    if (m_rollMode) configureRoll();
+    emit rollModeChanged();
+}
+
+void SerialHandler::configureRoll()
+{
+    // A new rate or span starts the history over; a running stream carries
+    // on into it, so a tick split across reads is kept
+    m_roll.configure(Calibration::Channels, qBound(16, qRound(m_rollSpan * m_sampleRate), MaxRollSamples));
+    m_rollEmulated = 0;
+    m_rollClock.start();
+}
+
+void SerialHandler::startRoll()
+{
+    configureRoll();
+    m_rollPending.clear();
+    m_rollRunning = true;
+
+    if (!m_connected) {
+        m_rollTimer.start(RollEmulationInterval);
+        return;
+    }
+
+    // Capture (C command) in streaming mode: samples are sent as they are
+    // converted, channels interleaved, until the abort command
+    QByteArray rollCmd;
+    rollCmd.append(0x43); // 'C'
+    rollCmd.append(static_cast<char>(0x02));
+    rollCmd.append(static_cast<char>(0x00));
+    sendCommand(rollCmd);
+}
+
+void SerialHandler::processRollData(const QByteArray &data)
+{
+    // Every whole tick goes to the history as soon as it is read; a tick
+    // split across reads waits for its remaining bytes
+    m_rollPending.append(data);
+    const int tickBytes = int(sampleBytes(m_sampleFormat, Calibration::Channels));
+    const int ticks = int(m_rollPending.size()) / tickBytes;
+    if (ticks == 0) return;
+
+    const uchar *bytes = reinterpret_cast<const uchar *>(m_rollPending.constData());
+    switch (m_sampleFormat) {
+    case Packed12:
+        unpackRoll<Packed12>(bytes, ticks);
+        break;
+    case Little10:
+        unpackRoll<Little10>(bytes, ticks);
+        break;
+    case Little16:
+        unpackRoll<Little16>(bytes, ticks);
+        break;
+    case Bits8:
+    default:
+        unpackRoll<Bits8>(bytes, ticks);
+        break;
+    }
+    m_rollPending.remove(0, ticks * tickBytes);
+}
+
+template<SampleFormat F>
+void SerialHandler::unpackRoll(const uchar *data, int ticks)
+{
+    using Layout = SampleLayout<F>;
+    const int channels = Calibration::Channels;
+    const int count = ticks * channels;
+
+    // Interleaved samples unpack like one planar run; 8-bit codes are
+    // widened to the 8.8 scale the channel scales take
+    m_rollCodes.resize(count);
+    if constexpr (sizeof(typename Layout::Code) > 1) {
+        Layout::unpack(data, count, m_rollCodes.data());
+    } else {
+        for (int i = 0; i < count; ++i) m_rollCodes[i] = quint16(data[i] << 8);
+    }
+
+    m_rollVolts.resize(count);
+    for (int c = 0; c < channels; ++c) {
+        const ChannelScale &scale = m_calibration.scale(c);
+        for (int t = 0; t < ticks; ++t) m_rollVolts[t * channels + c] = scale.volts(m_rollCodes[t * channels + c]);
+    }
+    m_roll.append(m_rollVolts.constData(), ticks);
+    emit rollSamplesAdded();
+}
+
+void SerialHandler::emulateRoll()
+{
+    if (m_connected || !m_rollRunning) {
+        m_rollTimer.stop();
+        return;
+    }
+
+    // Whatever the sample clock would have produced since the last tick,
+    // the same test signals as the emulated frames
+    const qint64 due = m_rollClock.elapsed() * qint64(m_sampleRate) / 1000;
+    const int ticks = int(qMin<qint64>(due - m_rollEmulated, m_roll.capacity()));
+    if (ticks <= 0) return;
+
+    const int channels = Calibration::Channels;
+    const qint64 first = due - ticks;
+    m_rollVolts.resize(ticks * channels);
+    for (int t = 0; t < ticks; ++t) {
+        const double n = double(first + t);
+        const double y1 = 5.0 * qSin(2 * M_PI * n / 50.0);
+        const double y2 = 3.0 * qSin(2 * M_PI * n / 25.0 + M_PI/4);
+        m_rollVolts[t * channels] = m_calibration.scale(0).volts(quint16(emulateFrontEnd(0, y1) << 8));
+        m_rollVolts[t * channels + 1] = m_calibration.scale(1).volts(quint16(emulateFrontEnd(1, y2) << 8));
+    }
+    m_rollEmulated = due;
+    m_roll.append(m_rollVolts.constData(), ticks);
+    emit rollSamplesAdded();
+}
+
+void SerialHandler::replayStep()
+{
+    // Unpaced replay yields to the event loop every so often so the display
+    // and the stop button stay alive
+    QElapsedTimer slice;
+    slice.start();
+
+    while (m_replay.isOpen()) {
+        if (!m_replayPending) {
+            if (!m_replay.next(&m_replayRecord)) {
+                finishReplay();
+                return;
+            }
+            m_replayPending = true;
+        }
+
+        if (m_replaySpeed > 0) {
+            const qint64 due = static_cast<qint64>(m_replayRecord.timestamp / m_replaySpeed);
+            const qint64 now = m_replayClock.nsecsElapsed();
+            if (due > now) {
+                m_replayTimer.start(static_cast<int>((due - now) / 1000000));
+                break;
+            }
+        } else if (slice.elapsed() >= 50) {
+            m_replayTimer.start(0);
+            break;
+        }
+
+        // Commands are in the journal for context; only received bytes go
+        // to the parser
+        m_replayPending = false;
+        ++m_replayRecords;
+        if (m_replayRecord.direction == SerialJournal::Received) {
+            QElapsedTimer parse;
+            parse.start();
+            processIncomingData(QByteArray::fromRawData(m_replayRecord.data, m_replayRecord.size),
+                                m_replayRecord.timestamp);
+            m_replayParseTime += parse.nsecsElapsed();
+            m_replayBytes += m_replayRecord.size;
+        }
+    }
+    emit replayChanged();
+}
+
+void SerialHandler::finishReplay()
+{
+    const QVariantMap stats = replayStats();
+    m_statusMessage = tr("Replayed %1 records, %2 bytes; parser throughput %3 MB/s")
+                          .arg(m_replayRecords)
+                          .arg(m_replayBytes)
+                          .arg(stats["bytesPerSecond"].toDouble() / 1e6, 0, 'f', 1);
+    emit statusChanged(m_statusMessage);
+    m_replay.close();
+    m_frameAssembler.reset();
+    emit replayChanged();
+}
+
+void SerialHandler::setEquivalentTime(bool enabled)
+{
+    if (enabled == m_equivalentTimeEnabled) return;
+    m_equivalentTimeEnabled = enabled;
+    m_equivalentTime.reset();
+    emit equivalentTimeChanged();
+}
+
+void SerialHandler::setEquivalentTimeFactor(int factor)
+{
+    if (factor == m_equivalentTime.factor()) return;
+    m_equivalentTime.configure(Calibration::Channels, m_recordLength, factor);
+    emit equivalentTimeChanged();
+}
+
+QString SerialHandler::defaultCalibrationPath() const
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation) + "/calibration.json";
+}
+
+bool SerialHandler::loadCalibration(const QString &path)
+{
+    const QString file = path.isEmpty() ? defaultCalibrationPath() : path;
+    QString error;
+    if (!m_calibration.load(file, &error)) {
+        m_statusMessage = tr("Failed to load calibration: %1").arg(error);
+        emit statusChanged(m_statusMessage);
+        return false;
+    }
+
+    ++m_settingsRevision;
+    checkRecordingScale();
+    m_statusMessage = tr("Calibration loaded from %1").arg(file);
+    emit statusChanged(m_statusMessage);
+    publishFrame();
+    return true;
+}
+
+bool SerialHandler::saveCalibration(const QString &path)
+{
+    const QString file = path.isEmpty() ? defaultCalibrationPath() : path;
+    QDir().mkpath(QFileInfo(file).absolutePath());
+    QString error;
+    if (!m_calibration.save(file, &error)) {
+        m_statusMessage = tr("Failed to save calibration: %1").arg(error);
+        emit statusChanged(m_statusMessage);
+        return false;
+    }
+
+    m_statusMessage = tr("Calibration saved to %1").arg(file);
+    emit statusChanged(m_statusMessage);
+    return true;
+}
+
+void SerialHandler::clearCalibration()
+{
+    m_calibration.clear();
+    ++m_settingsRevision;
+    checkRecordingScale();
+    m_statusMessage = tr("Calibration cleared");
+    emit statusChanged(m_statusMessage);
+}
+
+void SerialHandler::startSelfCalibration(int channel, double referenceAmplitude)
+{
+    if (channel < 0 || channel >= Calibration::Channels || referenceAmplitude <= 0) return;
+
+    m_calibrationChannel = channel;
+    m_calibrationStep = 0;
+    m_calibrationAmplitude = referenceAmplitude;
+    m_calibrationSkipped = 0;
+    setRollMode(false);
+    m_calibrationRestoreGain = m_calibration.selectedGain(channel);
+    m_calibrationRestoreOffset = m_calibration.selectedOffset(channel);
+    // The reference steps through every range, which is no measurement to
+    // keep; recording it would only split into a part per step
+    if (m_recorder.isOpen()) stopRecording();
+    setAcquisitionMode(NormalAcquisition);
+    setDDSFrequency(1000);
+    emit calibrationChanged();
+    beginCalibrationStep();
+}
+
+void SerialHandler::cancelSelfCalibration()
+{
+    if (m_calibrationChannel < 0) return;
+
+    const int channel = m_calibrationChannel;
+    m_calibrationChannel = -1;
+    stopDDS();
+    restoreCalibrationRange(channel);
+    emit calibrationChanged();
+    m_statusMessage = tr("Self-calibration cancelled");
+    emit statusChanged(m_statusMessage);
+}
+
+void SerialHandler::beginCalibrationStep()
+{
+    const int gainIndex = m_calibrationStep / 2;
+    const bool triangle = m_calibrationStep % 2 == 0;
+
+    // Start each range from the nominal transfer so the measurement is not
+    // coloured by a previous calibration
+    if (triangle) {
+        m_calibration.setEntry(m_calibrationChannel, gainIndex, Calibration::Entry());
+    }
+    // The reference is measured with the front-end offset at zero, to
+    // match the table selected for it
+    m_calibration.select(m_calibrationChannel, gainIndex, 0);
+    if (m_connected) {
+        sendGain(m_calibrationChannel, gainIndex);
+        sendOffset(m_calibrationChannel, 0);
+    }
+    checkRecordingScale();
+
+    setDDSWaveform(triangle ? TriangleWave : SquareWave);
+    runDDS();
+
+    m_calibrationMeasurement.reset();
+    m_statusMessage = tr("Calibrating CH%1 at %2x: %3 reference, step %4 of %5")
+                          .arg(m_calibrationChannel + 1)
+                          .arg(Calibration::gainValue(gainIndex))
+                          .arg(triangle ? tr("triangle") : tr("square"))
+                          .arg(m_calibrationStep + 1)
+                          .arg(2 * Calibration::GainSteps);
+    emit statusChanged(m_statusMessage);
+
+    // Let the DDS and front end settle before the first capture
+    QTimer::singleShot(50, this, [this]() { if (m_calibrationChannel >= 0) runCapture(false); });
+}
+
+void SerialHandler::finishCalibrationStep()
+{
+    if (m_calibrationChannel < 0) return;
+
+    const int channel = m_calibrationChannel;
+    const int gainIndex = m_calibrationStep / 2;
+    const bool triangle = m_calibrationStep % 2 == 0;
+
+    Calibration::Entry entry = m_calibration.entry(channel, gainIndex);
+    double low = 0.0;
+    double high = 0.0;
+    if (m_calibrationMeasurement.saturated() || (!triangle && !m_calibrationMeasurement.levels(&low, &high))) {
+        // The reference does not fit this range; keep it nominal and move on
+        ++m_calibrationSkipped;
+        m_calibration.setEntry(channel, gainIndex, Calibration::Entry());
+        if (triangle) ++m_calibrationStep;
+    } else if (triangle) {
+        entry.nonlinearity = m_calibrationMeasurement.nonlinearity();
+        m_calibration.setEntry(channel, gainIndex, entry);
+    } else {
+        // The square table toggles between DAC codes 5 and 250
+        const double refLow = (m_squareTable.constFirst() - 127.5) / 127.5 * m_calibrationAmplitude;
+        const double refHigh = (m_squareTable.constLast() - 127.5) / 127.5 * m_calibrationAmplitude;
+        const double lowNominal = m_calibration.nominalVolts(channel, low);
+        const double highNominal = m_calibration.nominalVolts(channel, high);
+        if (highNominal - lowNominal > 1e-6) {
+            entry.gain = (refHigh - refLow) / (highNominal - lowNominal);
+            entry.offset = lowNominal - refLow / entry.gain;
+            m_calibration.setEntry(channel, gainIndex, entry);
+        }
+    }
+
+    ++m_calibrationStep;
+    emit calibrationChanged();
+
+    if (m_calibrationStep < 2 * Calibration::GainSteps) {
+        beginCalibrationStep();
+        return;
+    }
+
+    m_calibrationChannel = -1;
+    stopDDS();
+    restoreCalibrationRange(channel);
+    saveCalibration();
+    m_statusMessage = m_calibrationSkipped == 0
+        ? tr("Self-calibration of CH%1 complete").arg(channel + 1)
+        : tr("Self-calibration of CH%1 complete; %2 ranges saturated and were left nominal, "
+             "reduce the reference amplitude to calibrate them").arg(channel + 1).arg(m_calibrationSkipped);
+    emit statusChanged(m_statusMessage);
+    emit calibrationChanged();
+}
+
+void SerialHandler::restoreCalibrationRange(int channel)
+{
+    // Back to the user's range on both the device and the table, now
+    // corrected by whatever was just measured
+    m_calibration.select(channel, m_calibrationRestoreGain, m_calibrationRestoreOffset);
+    if (m_connected) {
+        sendGain(channel, m_calibrationRestoreGain);
+        sendOffset(channel, m_calibrationRestoreOffset);
+    }
+    resetAcquisition();
+    ++m_settingsRevision;
+    checkRecordingScale();
+}
+
+void SerialHandler::generateTestData()
+{
+    // Generate some test oscilloscope data for demonstration, quantised like
+    // a real capture with a little noise so the acquisition modes have
+    // something to work on
+    const int length = m_recordLength;
+    quint8 *ch1 = m_codes.channel(0);
+    quint8 *ch2 = m_codes.channel(1);
+
+    // The sample clock is not locked to the signal, so each capture starts
+    // at a random fraction of a sample after the trigger
+    QRandomGenerator *rng = QRandomGenerator::global();
+    const double phase = rng->generateDouble();
+
+    if (m_ddsRunning) {
+        // DDS output looped back to both inputs, as on the calibration
+        // fixture. The table is interpolated like the DAC's output filter.
+        const double tableStep = 256.0 / 97.3;
+        const double amplitude = m_calibrationChannel >= 0 ? m_calibrationAmplitude : 5.0;
+        m_emulatedDdsPhase = rng->generateDouble() * 256.0;
+        for (int i = 0; i < length; i++) {
+            const double pos = m_emulatedDdsPhase + (i + phase) * tableStep;
+            const int index = static_cast<int>(pos) & 0xFF;
+            const double frac = pos - qFloor(pos);
+            const double code = m_waveformTable[index] * (1.0 - frac)
+                                + m_waveformTable[(index + 1) % m_waveformTable.size()] * frac;
+            const double volts = (code - 127.5) / 127.5 * amplitude;
+            ch1[i] = emulateFrontEnd(0, volts);
+            ch2[i] = emulateFrontEnd(1, volts);
+        }
+        acquireFrame();
+        return;
+    }
+
+    for (int i = 0; i < length; i++) {
+        double y1 = 5.0 * qSin(2 * M_PI * (i + phase) / 50.0); // 5V amplitude sine wave
+        double y2 = 3.0 * qSin(2 * M_PI * (i + phase) / 25.0 + M_PI/4); // 3V amplitude, phase shifted
+
+        ch1[i] = emulateFrontEnd(0, y1);
+        ch2[i] = emulateFrontEnd(1, y2);
+    }
+
+    acquireFrame();
+}
+
+quint8 SerialHandler::emulateFrontEnd(int channel, double volts)
+{
+    // A slightly imperfect front end: gain and offset errors, a bowed
+    // transfer curve and a little noise, so calibration has work to do
+    static const double gainError[] = { 1.02, 0.985 };
+    static const double offsetError[] = { 0.05, -0.03 };
+
+    const double adcVolts = volts * Calibration::gainValue(m_calibration.selectedGain(channel)) * gainError[channel]
+                            + offsetError[channel] + Calibration::offsetVolts(m_calibration.selectedOffset(channel));
+    double code = (adcVolts + 10.0) * 255.0 / 20.0;
+    code += 0.8 * qSin(M_PI * qBound(0.0, code, 255.0) / 255.0);
+    code += (QRandomGenerator::global()->generateDouble() - 0.5) * 0.8;
+    return static_cast<quint8>(qBound(0, qRound(code), 255));
+}
+
+void SerialHandler::handleReadyRead()
+{
+    QByteArray data = m_serial->readAll();
+    m_journal.append(SerialJournal::Received, data);
+    processIncomingData(data, m_frameClock.nsecsElapsed());
+}
+
+void SerialHandler::handleError(QSerialPort::SerialPortError error)
+{
+    if (error == QSerialPort::NoError) return;
+
+    m_statusMessage = tr("Serial Error: %1").arg(m_serial->errorString());
+    emit statusChanged(m_statusMessage);
+
+    if (error == QSerialPort::ResourceError) {
+        disconnectPort();
+    }
+}
+
+void SerialHandler::processIncomingData(const QByteArray &data, qint64 timestamp)
+{
+    if (data.isEmpty()) return;
+
+    // The answer to a record length command: 'R' and the accepted length - 1,
+    // possibly split across reads. Captures wait for it, so it is only
+    // looked for while none is running, and a length the device could not
+    // have picked means the bytes were something else.
+    if (m_requestedRecordLength > 0 && !m_captureRunning && !m_rollRunning && m_frameAssembler.isIdle()
+        && (!m_recordLengthReply.isEmpty() || data[0] == 'R')) {
+        const int used = qMin(int(data.size()), 3 - int(m_recordLengthReply.size()));
+        m_recordLengthReply.append(data.constData(), used);
+        if (m_recordLengthReply.size() < 3) return;
+
+        const int length = ((quint8(m_recordLengthReply[1]) << 8) | quint8(m_recordLengthReply[2])) + 1;
+        if (length >= MinRecordLength && length <= m_requestedRecordLength) {
+            confirmRecordLength(length);
+            processIncomingData(data.mid(used), timestamp);
+        } else {
+            // Stop waiting and parse the bytes as they are
+            const QByteArray bytes = m_recordLengthReply + data.mid(used);
+            confirmRecordLength(m_requestedRecordLength);
+            processIncomingData(bytes, timestamp);
+        }
+        return;
+    }
+
+    if (m_rollMode) {
+        processRollData(data);
+        return;
+    }
+
+    // A lone byte between frames answers the digital input query
+    if (data.size() == 1 && m_frameAssembler.isIdle()) {
+        quint8 inputs = static_cast<quint8>(data[0]);
+        emit digitalInputsChanged(inputs);
+        return;
+    }
+
+    // Scope data: CH1 samples then CH2 samples, recordLength each, split
+    // across reads however the port delivers them
+    const char *bytes = data.constData();
+    int remaining = data.size();
+    while (remaining > 0) {
+        const int used = m_frameAssembler.feed(bytes, remaining, timestamp);
+        bytes += used;
+        remaining -= used;
+        if (!m_frameAssembler.isComplete()) break;
+
+        // The format is resolved once per frame; the kernels themselves
+        // never branch on it
+        switch (m_sampleFormat) {
+        case Packed12:
+            unpackFrame<Packed12>();
+            break;
+        case Little10:
+            unpackFrame<Little10>();
+            break;
+        case Little16:
+            unpackFrame<Little16>();
+            break;
+        case Bits8:
+        default:
+            unpackFrame<Bits8>();
+            break;
+        }
+        if (!m_captureContinuous) m_captureRunning = false;
+    }
+}
+
+template<SampleFormat F>
+void SerialHandler::unpackFrame()
+{
+    using Layout = SampleLayout<F>;
+    constexpr bool wide = sizeof(typename Layout::Code) > 1;
+    for (int c = 0; c < Calibration::Channels; ++c) {
+        if constexpr (wide) {
+            Layout::unpack(m_frameAssembler.channel(c), m_recordLength, m_wideCodes.channel(c));
+        } else {
+            Layout::unpack(m_frameAssembler.channel(c), m_recordLength, m_codes.channel(c));
+        }
+    }
+    acquireFrame(wide);
+}
+
+void SerialHandler::acquireFrame(bool wide)
+{
+    // Allocations of the capture path on this thread. Outputs that hand
+    // data on through the event queue, QML or viewers allocate by design
+    // and are excluded where they happen.
+    const quint64 allocationsBefore = AllocationCounter::count();
+
+    // Recordings and the self-calibration histogram hold 8-bit codes, so
+    // wide frames are narrowed only while one of them needs the codes
+    if (wide && (m_recorder.isOpen() || m_calibrationChannel >= 0)) {
+        for (int c = 0; c < m_codes.channels(); ++c) {
+            const quint16 *in = m_wideCodes.channel(c);
+            quint8 *out = m_codes.channel(c);
+            for (int i = 0; i < m_codes.length(); ++i) out[i] = static_cast<quint8>(in[i] >> 8);
+        }
+    }
+
+    if (m_recorder.isOpen()) {
+        // A record length change would break the fixed frame size
+        if (m_codes.length() != m_recorder.recordLength()) {
+            stopRecording();
+        } else {
+            m_recorder.writeFrame(m_codes);
+            m_pyramidBuilder.addFrame(m_codes);
+            emit recordingChanged();
+        }
+    }
+
+    if (m_calibrationChannel >= 0) {
+        const AllocationCounter::Exclude exclude;   // The next step is queued
+        m_calibrationMeasurement.addFrame(m_codes.channel(m_calibrationChannel), m_codes.length());
+        // Square levels settle quickly; the triangle histogram needs many
+        // samples per code before the widths mean anything
+        const quint64 target = (m_calibrationStep % 2 == 0) ? 256 * 200 : 4000;
+        if (m_calibrationMeasurement.samples() >= target) {
+            QTimer::singleShot(0, this, &SerialHandler::finishCalibrationStep);
+        } else {
+            QTimer::singleShot(0, this, [this]() { if (m_calibrationChannel >= 0) runCapture(false); });
+        }
+    }
+
+    const int channels = m_codes.channels();
+    const int length = m_codes.length();
+    const bool envelope = acquisitionMode() == FrameAccumulator::Envelope;
+
+    // A fresh pooled frame each capture: whoever still holds the previous
+    // one keeps reading it undisturbed
+    ScaledFramePool::Writer frame = m_framePool.acquire();
+    frame->configure(channels, length);
+    frame->info.timestamp = m_frameClock.nsecsElapsed();
+    frame->info.sampleRate = m_sampleRate;
+    frame->info.revision = m_settingsRevision;
+
+    for (int c = 0; c < channels; ++c) {
+        // Accumulators follow the record length of the incoming frames
+        FrameAccumulator &accumulator = m_accumulators[c];
+        const int codeBytes = wide ? 2 : 1;
+        if (accumulator.length() != length || accumulator.codeBytes() != codeBytes) {
+            accumulator.configure(accumulator.mode(), length, accumulator.depth(), codeBytes);
+        }
+        if (wide) {
+            accumulator.addFrame(m_wideCodes.channel(c));
+        } else {
+            accumulator.addFrame(m_codes.channel(c));
+        }
+
+        // Kept as codes; volts are produced as consumers read them
+        std::copy(accumulator.result(), accumulator.result() + length, frame->channel(c));
+        frame->scale(c) = m_calibration.scale(c);
+    }
+
+    if (envelope) {
+        ScaledFramePool::Writer minimum = m_framePool.acquire();
+        minimum->configure(channels, length);
+        minimum->info = frame->info;
+        for (int c = 0; c < channels; ++c) {
+            const FrameAccumulator &accumulator = m_accumulators[c];
+            std::copy(accumulator.minimum(), accumulator.minimum() + length, minimum->channel(c));
+            minimum->scale(c) = m_calibration.scale(c);
+        }
+        m_minimum = m_framePool.publish(std::move(minimum));
+    } else {
+        m_minimum.reset();
+    }
+    m_frame = m_framePool.publish(std::move(frame));
+    m_voltsCurrent = false;
+    {
+        const AllocationCounter::Exclude exclude;   // Queued to viewers
+        m_stream.publishFrame(m_frame);
+    }
+    if (m_sharedRing.isOpen()) m_sharedRing.write(*m_frame);
+
+    if (acquisitionMode() != FrameAccumulator::Normal) {
+        emit acquisitionChanged();
+    }
+
+    if (isSignalConnected(QMetaMethod::fromSignal(&SerialHandler::frameReady))) {
+        const AllocationCounter::Exclude exclude;
+        emit frameReady(currentVolts());
+    }
+
+    // Spectral analysis runs on real-time frames at the real sample rate,
+    // before any equivalent-time composite replaces them. Its results go
+    // to QML and viewers as fresh containers.
+    if (m_dftEnabled || m_stream.wants(StreamServer::SpectrumStream)) {
+        const AllocationCounter::Exclude exclude;
+        calculateDFT(currentVolts().channel(0), length);
+    }
+    if (m_distortionEnabled) analyzeDistortion();
+    if (m_maskEnabled && !m_mask.isEmpty()) testMask();
+    if (m_crossChannelEnabled) {
+        const VoltFrame &volts = currentVolts();
+        m_crossChannel.addFrame(volts.channel(0), volts.channel(1), length, m_sampleRate);
+        emit crossChannelChanged();
+    }
+    if (m_stream.wants(StreamServer::MeasurementStream)) {
+        const AllocationCounter::Exclude exclude;
+        streamMeasurements();
+    }
+
+    m_sampleSpacing = 1.0;
+    if (m_equivalentTimeEnabled) {
+        if (m_equivalentTime.length() != length) {
+            m_equivalentTime.configure(channels, length, m_equivalentTime.factor());
+        }
+
+        const VoltFrame &volts = currentVolts();
+        QVarLengthArray<const float *, 8> frame(channels);
+        for (int c = 0; c < channels; ++c) frame[c] = volts.channel(c);
+        if (m_equivalentTime.addFrame(frame.constData()) || m_equivalentTime.frameCount() > 0) {
+            const int bins = length * m_equivalentTime.factor();
+            m_volts.configure(channels, bins);
+            for (int c = 0; c < channels; ++c) {
+                std::copy(m_equivalentTime.composite(c), m_equivalentTime.composite(c) + bins, m_volts.channel(c));
+            }
+            m_sampleSpacing = 1.0 / m_equivalentTime.factor();
+            m_volts.info.sampleRate = m_sampleRate * m_equivalentTime.factor();
+        }
+        emit equivalentTimeChanged();
+    }
+
+    // Display is left out too: the chart pulls its points through QML
+    if (AllocationCounter::isEnabled()) {
+        const qint64 allocations = qint64(AllocationCounter::count() - allocationsBefore);
+        if (allocations != m_frameAllocations || m_framePool.size() != m_framePoolSize) {
+            m_frameAllocations = allocations;
+            m_framePoolSize = m_framePool.size();
+            emit frameStatsChanged();
+        }
+    }
+
+    publishFrame();
+}
+
+const VoltFrame &SerialHandler::currentVolts()
+{
+    if (!m_voltsCurrent) {
+        if (m_frame.isNull()) {
+            m_volts.clear();
+        } else {
+            m_frame->toVolts(m_volts);
+        }
+        m_voltsCurrent = true;
+    }
+    return m_volts;
+}
+
+void SerialHandler::publishFrame()
+{
+    if (m_voltsCurrent ? m_volts.isEmpty() : m_frame.isNull()) return;
+
+    emit dataReceived();
+
+    if (acquisitionMode() == FrameAccumulator::Envelope && m_sampleSpacing == 1.0 && !m_minimum.isNull()) {
+        emit envelopeReceived();
+    }
+}
+
+SerialHandler::Trace SerialHandler::displayTrace(int channel, bool minimum)
+{
+    const SharedFrame &frame = minimum ? m_minimum : m_frame;
+    Trace trace = { nullptr, 0, 0.0, 1.0 };
+
+    // Converted volts win while they hold what is shown; otherwise only the
+    // visible codes and the interpolator's context are converted
+    const bool fromVolts = m_voltsCurrent && &frame == &m_frame;
+    const int count = fromVolts ? m_volts.length() : (frame.isNull() ? 0 : frame->length());
+    if (count == 0 || channel < 0 || channel >= (fromVolts ? m_volts.channels() : frame->channels())) {
+        return trace;
+    }
+
+    // Only the visible window is reconstructed, so the cost follows what is
+    // on screen rather than the record length
+    const int first = qBound(0, qFloor(m_visibleFirst / m_sampleSpacing), count);
+    const int last = m_visibleLast < 0 ? count
+                                       : qBound(first, qCeil(m_visibleLast / m_sampleSpacing), count);
+
+    const float *volts = nullptr;
+    int offset = 0;
+    int available = count;
+    if (fromVolts) {
+        volts = m_volts.channel(channel);
+    } else {
+        offset = qMax(0, first - Interpolator::TapCount);
+        available = qMin(count, last + Interpolator::TapCount) - offset;
+        m_displayVolts.resize(available);
+        frame->volts(channel, offset, available, m_displayVolts.data());
+        volts = m_displayVolts.constData();
+    }
+
+    m_displayBuffer.resize(m_interpolator.outputLength(last - first));
+    const int n = m_interpolator.process(volts, available, first - offset, last - offset, m_displayBuffer.data());
+
+    trace.values = m_displayBuffer.constData();
+    trace.count = n;
+    trace.start = first * m_sampleSpacing;
+    trace.step = m_interpolator.outputStep() * m_sampleSpacing;
+    return trace;
+}
+
+SerialHandler::Overview SerialHandler::recordingOverview(int channel, double start, double end, int columns)
+{
+    Overview overview = { nullptr, nullptr, nullptr, 0, 0.0, 0.0 };
+    if (!m_pyramid.isOpen() || m_playback.sampleRate() <= 0 || columns <= 0) return overview;
+
+    const double rate = m_playback.sampleRate();
+    const qint64 first = qMax<qint64>(0, qFloor(start * rate));
+    const qint64 last = qMin(m_playback.sampleCount(), qint64(qCeil(end * rate)));
+    m_overviewMinimum.resize(columns);
+    m_overviewMaximum.resize(columns);
+    m_overviewMean.resize(columns);
+    const int count = m_pyramid.overview(m_playback, channel, first, last, columns, m_overviewMinimum.data(),
+                                         m_overviewMaximum.data(), m_overviewMean.data());
+
+    overview.minimum = m_overviewMinimum.constData();
+    overview.maximum = m_overviewMaximum.constData();
+    overview.mean = m_overviewMean.constData();
+    overview.count = count;
+    overview.start = first / rate;
+    overview.step = count > 0 ? double(last - first) / count / rate : 0.0;
+    return overview;
+}
+
+void SerialHandler::calculateDFT(const float *volts, int count)
+{
+    if (count < 4) return;
+
+    // Hann windowed and zero padded to a power of two; the window and plan
+    // are rebuilt only when the record length changes
+    const int N = count;
+    const int size = FFT::nextPowerOfTwo(N);
+    if (m_dftWindow.size() != N) {
+        Window::fill(Window::Hann, N, m_dftWindow);
+        m_dftPlan.setSize(size);
+        m_dftBlock.fill(0.0f, size);
+        m_dftSpectrum.resize(size / 2 + 1);
+    }
+    for (int n = 0; n < N; ++n) m_dftBlock[n] = volts[n] * m_dftWindow[n];
+    m_dftPlan.forward(m_dftBlock.constData(), m_dftSpectrum.data());
+
+    // A fresh vector each time, since queued viewers share it
+    if (m_stream.wants(StreamServer::SpectrumStream)) {
+        QVector<float> magnitudes(size / 2);
+        for (int k = 0; k < size / 2; k++) magnitudes[k] = std::abs(m_dftSpectrum[k]) * 4.0f / N;
+        m_stream.publishSpectrum(magnitudes, m_sampleRate / size);
+    }
+    if (!m_dftEnabled) return;
+
+    // Only the first half of the spectrum, up to Nyquist
+    QVector<QPointF> dftData;
+    dftData.reserve(size / 2);
+    for (int k = 0; k < size / 2; k++) {
+        const double magnitude = std::abs(m_dftSpectrum[k]) * 4.0 / N; // Hann coherent gain is 1/2
+        const double frequency = k * m_sampleRate / size;
+        dftData.append(QPointF(frequency, magnitude));
     }
 
     emit dftCalculated(pointsToVariantList(dftData));
 }
 
+void SerialHandler::analyzeDistortion()
+{
+    const VoltFrame &volts = currentVolts();
+    m_distortion.analyze(volts.channel(m_distortionChannel), volts.length(), m_sampleRate);
+    emit distortionChanged();
+}
+
+void SerialHandler::streamMeasurements()
+{
+    // Whatever the enabled analyzers produced for this frame
+    QVariantMap values;
+    values["revision"] = m_settingsRevision;
+    values["sampleRate"] = m_sampleRate;
+    if (m_distortionEnabled) values["distortion"] = distortion();
+    if (m_crossChannelEnabled) values["crossChannel"] = crossChannel();
+    if (m_maskEnabled && !m_mask.isEmpty()) {
+        QVariantMap mask;
+        mask["tested"] = maskTested();
+        mask["failed"] = maskFailed();
+        mask["passed"] = m_maskLastPassed;
+        values["mask"] = mask;
+    }
+    m_stream.publishMeasurements(values);
+}
+
 void SerialHandler::sendCommand(const QByteArray &command)
 {
     if (m_connected && m_serial->isOpen()) {
@@ -523,6 +2440,7 @@ void SerialHandler::sendCommand(const QByteArray &command)
             m_statusMessage = tr("Failed to write command: %1").arg(m_serial->errorString());
             emit statusChanged(m_statusMessage);
         } else {
+            m_journal.append(SerialJournal::Sent, command);
             m_serial->waitForBytesWritten(1000);
         }
     }
@@ -7,17 +7,88 @@
 #include <QVector>
 #include <QPointF>
 #include <QStringList>
-#include <QQmlEngine>
+#include <QFutureWatcher>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <atomic>
+#include "interpolator.h"
+#include "acquisition.h"
+#include "equivalenttime.h"
+#include "calibration.h"
+#include "fft.h"
+#include "distortion.h"
+#include "crosschannel.h"
+#include "masktest.h"
+#include "recording.h"
+#include "eventsearch.h"
+#include "recordingpyramid.h"
+#include "exporter.h"
+#include "journal.h"
+#include "frameassembler.h"
+#include "scopeframe.h"
+#include "scaledframe.h"
+#include "sampleformat.h"
+#include "allocationcounter.h"
+#include "streamserver.h"
+#include "sharedring.h"
+#include "portmonitor.h"
+#include "rollbuffer.h"
 
 class SerialHandler : public QObject
 {
     Q_OBJECT
-    QML_ELEMENT
-    QML_SINGLETON
 
     Q_PROPERTY(QStringList availablePorts READ availablePorts NOTIFY portsChanged)
     Q_PROPERTY(bool connected READ connected NOTIFY connectionChanged)
     Q_PROPERTY(QString statusMessage READ statusMessage NOTIFY statusChanged)
+    Q_PROPERTY(int interpolationMode READ interpolationMode WRITE setInterpolationMode NOTIFY interpolationChanged)
+    Q_PROPERTY(int interpolationFactor READ interpolationFactor WRITE setInterpolationFactor NOTIFY interpolationChanged)
+    Q_PROPERTY(int acquisitionMode READ acquisitionMode WRITE setAcquisitionMode NOTIFY acquisitionChanged)
+    Q_PROPERTY(int acquisitionDepth READ acquisitionDepth WRITE setAcquisitionDepth NOTIFY acquisitionChanged)
+    Q_PROPERTY(int acquiredFrames READ acquiredFrames NOTIFY acquisitionChanged)
+    Q_PROPERTY(bool equivalentTime READ equivalentTime WRITE setEquivalentTime NOTIFY equivalentTimeChanged)
+    Q_PROPERTY(int equivalentTimeFactor READ equivalentTimeFactor WRITE setEquivalentTimeFactor NOTIFY equivalentTimeChanged)
+    Q_PROPERTY(double equivalentTimeCoverage READ equivalentTimeCoverage NOTIFY equivalentTimeChanged)
+    Q_PROPERTY(bool calibrating READ calibrating NOTIFY calibrationChanged)
+    Q_PROPERTY(double calibrationProgress READ calibrationProgress NOTIFY calibrationChanged)
+    Q_PROPERTY(double sampleRate READ sampleRate NOTIFY sampleRateChanged)
+    Q_PROPERTY(int recordLength READ recordLength WRITE setRecordLength NOTIFY recordLengthChanged)
+    Q_PROPERTY(int sampleFormat READ sampleFormat WRITE setSampleFormat NOTIFY sampleFormatChanged)
+    Q_PROPERTY(QVariantMap frameStats READ frameStats NOTIFY frameStatsChanged)
+    Q_PROPERTY(bool dftEnabled READ dftEnabled WRITE setDftEnabled NOTIFY dftEnabledChanged)
+    Q_PROPERTY(bool distortionEnabled READ distortionEnabled WRITE setDistortionEnabled NOTIFY distortionSettingsChanged)
+    Q_PROPERTY(int distortionChannel READ distortionChannel WRITE setDistortionChannel NOTIFY distortionSettingsChanged)
+    Q_PROPERTY(int distortionAverages READ distortionAverages WRITE setDistortionAverages NOTIFY distortionSettingsChanged)
+    Q_PROPERTY(QVariantMap distortion READ distortion NOTIFY distortionChanged)
+    Q_PROPERTY(bool crossChannelEnabled READ crossChannelEnabled WRITE setCrossChannelEnabled NOTIFY crossChannelSettingsChanged)
+    Q_PROPERTY(int crossChannelAverages READ crossChannelAverages WRITE setCrossChannelAverages NOTIFY crossChannelSettingsChanged)
+    Q_PROPERTY(QVariantMap crossChannel READ crossChannel NOTIFY crossChannelChanged)
+    Q_PROPERTY(bool maskEnabled READ maskEnabled WRITE setMaskEnabled NOTIFY maskSettingsChanged)
+    Q_PROPERTY(int maskChannel READ maskChannel WRITE setMaskChannel NOTIFY maskSettingsChanged)
+    Q_PROPERTY(bool maskSaveFailures READ maskSaveFailures WRITE setMaskSaveFailures NOTIFY maskSettingsChanged)
+    Q_PROPERTY(bool maskDefined READ maskDefined NOTIFY maskChanged)
+    Q_PROPERTY(quint64 maskTested READ maskTested NOTIFY maskResultsChanged)
+    Q_PROPERTY(quint64 maskFailed READ maskFailed NOTIFY maskResultsChanged)
+    Q_PROPERTY(double maskFailureRate READ maskFailureRate NOTIFY maskResultsChanged)
+    Q_PROPERTY(bool maskLastPassed READ maskLastPassed NOTIFY maskResultsChanged)
+    Q_PROPERTY(bool recording READ recording NOTIFY recordingChanged)
+    Q_PROPERTY(quint64 recordedFrames READ recordedFrames NOTIFY recordingChanged)
+    Q_PROPERTY(QString playbackPath READ playbackPath NOTIFY playbackChanged)
+    Q_PROPERTY(double playbackDuration READ playbackDuration NOTIFY playbackChanged)
+    Q_PROPERTY(bool overviewReady READ overviewReady NOTIFY overviewChanged)
+    Q_PROPERTY(bool searchRunning READ searchRunning NOTIFY searchChanged)
+    Q_PROPERTY(int eventCount READ eventCount NOTIFY searchChanged)
+    Q_PROPERTY(int currentEvent READ currentEvent NOTIFY searchChanged)
+    Q_PROPERTY(bool exporting READ exporting NOTIFY exportChanged)
+    Q_PROPERTY(double exportProgress READ exportProgress NOTIFY exportChanged)
+    Q_PROPERTY(bool journaling READ journaling NOTIFY journalChanged)
+    Q_PROPERTY(bool replaying READ replaying NOTIFY replayChanged)
+    Q_PROPERTY(QVariantMap replayStats READ replayStats NOTIFY replayChanged)
+    Q_PROPERTY(bool streaming READ streaming NOTIFY streamChanged)
+    Q_PROPERTY(QVariantMap streamStats READ streamStats NOTIFY streamChanged)
+    Q_PROPERTY(bool sharing READ sharing NOTIFY sharingChanged)
+    Q_PROPERTY(bool rollMode READ rollMode WRITE setRollMode NOTIFY rollModeChanged)
+    Q_PROPERTY(double rollSpan READ rollSpan WRITE setRollSpan NOTIFY rollModeChanged)
 
 public:
     explicit SerialHandler(QObject *parent = nullptr);
@@ -26,6 +97,84 @@ public:
     QStringList availablePorts() const;
     bool connected() const;
     QString statusMessage() const;
+    int interpolationMode() const;
+    int interpolationFactor() const;
+    int acquisitionMode() const;
+    int acquisitionDepth() const;
+    int acquiredFrames() const;
+    bool equivalentTime() const;
+    int equivalentTimeFactor() const;
+    double equivalentTimeCoverage() const;
+    bool calibrating() const;
+    double calibrationProgress() const;
+    double sampleRate() const;
+    int recordLength() const;
+    int sampleFormat() const;
+    QVariantMap frameStats() const;
+    bool dftEnabled() const;
+    bool distortionEnabled() const;
+    int distortionChannel() const;
+    int distortionAverages() const;
+    QVariantMap distortion() const;
+    bool crossChannelEnabled() const;
+    int crossChannelAverages() const;
+    QVariantMap crossChannel() const;
+    bool maskEnabled() const;
+    int maskChannel() const;
+    bool maskSaveFailures() const;
+    bool maskDefined() const;
+    quint64 maskTested() const;
+    quint64 maskFailed() const;
+    double maskFailureRate() const;
+    bool maskLastPassed() const;
+    bool recording() const;
+    quint64 recordedFrames() const;
+    QString playbackPath() const;
+    double playbackDuration() const;
+    bool overviewReady() const;
+    bool searchRunning() const;
+    int eventCount() const;
+    int currentEvent() const;
+    bool exporting() const;
+    double exportProgress() const;
+    bool journaling() const;
+    bool replaying() const;
+    QVariantMap replayStats() const;
+    bool streaming() const;
+    QVariantMap streamStats() const;
+    bool sharing() const;
+    bool rollMode() const;
+    double rollSpan() const;
+
+    // Roll mode samples, newest last; rollSamplesAdded() follows each append
+    const RollBuffer &rollBuffer() const { return m_roll; }
+    static constexpr double RollMaxSampleRate = 5e3;
+
+    // Visible part of a channel reconstructed for display: `count` volts,
+    // the first at x = start and then every `step` record samples. The
+    // minimum trace is the lower envelope. Values stay valid until the next
+    // call.
+    struct Trace {
+        const float *values;
+        int count;
+        double start;
+        double step;
+    };
+    Trace displayTrace(int channel, bool minimum = false);
+
+    // Envelope and mean of a channel of the open recording between two
+    // times in seconds, in up to `columns` columns: `count` of each, the
+    // first column at x = start and then every `step` seconds. Values stay
+    // valid until the next call.
+    struct Overview {
+        const float *minimum;
+        const float *maximum;
+        const float *mean;
+        int count;
+        double start;
+        double step;
+    };
+    Overview recordingOverview(int channel, double start, double end, int columns);
 
     enum WaveformType {
         SineWave = 0,
@@ -37,6 +186,21 @@ public:
     };
     Q_ENUM(WaveformType)
 
+    enum InterpolationMode {
+        LinearInterpolation = Interpolator::LinearInterpolation,
+        SincInterpolation = Interpolator::SincInterpolation
+    };
+    Q_ENUM(InterpolationMode)
+
+    enum AcquisitionMode {
+        NormalAcquisition = FrameAccumulator::Normal,
+        AverageAcquisition = FrameAccumulator::RunningAverage,
+        ExponentialAcquisition = FrameAccumulator::ExponentialAverage,
+        EnvelopeAcquisition = FrameAccumulator::Envelope,
+        HighResAcquisition = FrameAccumulator::HighResolution
+    };
+    Q_ENUM(AcquisitionMode)
+
 public slots:
     void refreshPorts();
     bool connectToPort(const QString &portName);
@@ -56,12 +220,104 @@ public slots:
     quint8 readDigitalInputs();
     void startSweep(double startFreq, double endFreq, int steps, int delayMs);
     void stopSweep();
+    void setInterpolationMode(int mode);
+    void setInterpolationFactor(int factor);
+    void setVisibleWindow(int first, int last);
+    void setAcquisitionMode(int mode);
+    void setAcquisitionDepth(int depth);
+    void resetAcquisition();
+    void setEquivalentTime(bool enabled);
+    void setEquivalentTimeFactor(int factor);
+    bool loadCalibration(const QString &path = QString());
+    bool saveCalibration(const QString &path = QString());
+    void clearCalibration();
+    void startSelfCalibration(int channel, double referenceAmplitude);
+    void cancelSelfCalibration();
+    void setSampleRate(int index);
+    void setRecordLength(int length);
+    void setSampleFormat(int format);
+    void setDftEnabled(bool enabled);
+    void setDistortionEnabled(bool enabled);
+    void setDistortionChannel(int channel);
+    void setDistortionAverages(int averages);
+    void setCrossChannelEnabled(bool enabled);
+    void setCrossChannelAverages(int averages);
+    void setMaskEnabled(bool enabled);
+    void setMaskChannel(int channel);
+    void setMaskSaveFailures(bool save);
+    void setMaskFromReference(double tolerance, int horizontal);
+    bool loadMask(const QString &path);
+    bool saveMask(const QString &path);
+    void clearMask();
+    void resetMaskCounters();
+    bool startRecording(const QString &path = QString());
+    void stopRecording();
+    bool openRecording(const QString &path);
+    void closeRecording();
+    void searchRecording(int type, int channel, double level, double width, bool negative);
+    void showEvent(int index);
+    void nextEvent();
+    void previousEvent();
+    void exportFrame(const QString &path, int format);
+    void exportRecording(const QString &path, int format);
+    void cancelExport();
+    bool startJournal(const QString &path = QString());
+    void stopJournal();
+    bool startReplay(const QString &path, double speed);
+    void stopReplay();
+    // Serves remote viewers on `port`; loopback only unless `lan` is set
+    bool startStreaming(int port = StreamServer::DefaultPort, bool lan = false);
+    void stopStreaming();
+    // Publishes every frame to the shared-memory ring /dev/shm/<name>
+    bool startSharing(const QString &name = QStringLiteral("scopex"));
+    void stopSharing();
+    // Samples stream in as the device converts them and scroll across a
+    // `rollSpan` second history instead of arriving as triggered frames.
+    // runCapture() starts the stream and stopCapture() ends it.
+    void setRollMode(bool enabled);
+    void setRollSpan(double seconds);
 
 signals:
     void portsChanged();
     void connectionChanged();
     void statusChanged(const QString &message);
-    void dataReceived(const QVariantList &ch1Data, const QVariantList &ch2Data);
+    void interpolationChanged();
+    void acquisitionChanged();
+    void equivalentTimeChanged();
+    void calibrationChanged();
+    void sampleRateChanged();
+    void recordLengthChanged();
+    void sampleFormatChanged();
+    void frameStatsChanged();
+    void dftEnabledChanged();
+    void distortionSettingsChanged();
+    void distortionChanged();
+    void crossChannelSettingsChanged();
+    void crossChannelChanged();
+    void maskSettingsChanged();
+    // Bounds in volts per sample for drawing; open columns are left out
+    void maskChanged(const QVariantList &upper, const QVariantList &lower);
+    void maskResultsChanged();
+    void recordingChanged();
+    void playbackChanged();
+    void overviewChanged();
+    void searchChanged();
+    // A search hit loaded for display: the event starts `offset` samples into
+    // the shown frame and lasts `width` samples (0 for edges)
+    void eventShown(int index, int offset, qint64 width);
+    void exportChanged();
+    void journalChanged();
+    void replayChanged();
+    void streamChanged();
+    void sharingChanged();
+    void rollModeChanged();
+    void rollSamplesAdded();
+    // A new frame or display window; charts pull it with displayTrace()
+    void dataReceived();
+    void envelopeReceived();
+    // Every frame converted in full, for C++ analysis consumers. Frames are
+    // only converted while something is connected.
+    void frameReady(const VoltFrame &frame);
     void dftCalculated(const QVariantList &dftData);
     void digitalInputsChanged(quint8 inputs);
 
@@ -70,7 +326,11 @@ private slots:
     void handleError(QSerialPort::SerialPortError error);
 
 private:
+    // Feeds processIncomingData() directly to check the capture path
+    friend class TestAllocations;
+
     QSerialPort *m_serial;
+    PortMonitor m_portMonitor;   // Enumerates in the background, so reads are free
     QString m_statusMessage;
     bool m_connected;
 
@@ -81,12 +341,220 @@ private:
     QVector<quint8> m_rampUpTable;
     QVector<quint8> m_rampDownTable;
 
-    void processIncomingData(const QByteArray &data);
-    void calculateDFT(const QVector<QPointF> &timeData);
+    // Samples per channel per capture, negotiated with the device. The code
+    // buffers are sized when it changes and reused for every frame.
+    static constexpr int MinRecordLength = 200;
+    static constexpr int MaxRecordLength = 65536;
+    int m_recordLength;
+    int m_deviceRecordLength;      // Last length the device confirmed, 0 if unknown
+    int m_requestedRecordLength;   // Sent and not yet confirmed, 0 if none
+    QByteArray m_recordLengthReply;
+    // Firmware without the command never answers; past the deadline the
+    // requested length is taken as confirmed
+    QTimer m_recordLengthTimer;
+    static constexpr int RecordLengthReplyTimeout = 200;   // ms
+    // Triggered capture sent to the device and not yet finished. A capture
+    // asked for while a record length reply is due waits for the reply, so
+    // its frames are never mistaken for it.
+    bool m_captureRunning;
+    bool m_captureContinuous;
+    bool m_captureDeferred;
+    SampleFormat m_sampleFormat;   // How the device packs samples on the wire
+    FrameAssembler m_frameAssembler;
+
+    // Raw ADC codes of the most recent capture, and one accumulator per
+    // channel. Frames are stamped from m_frameClock with the revision of
+    // the settings they were captured under.
+    CodeFrame m_codes;
+    WideCodeFrame m_wideCodes;   // Unpacked codes of 10 to 16-bit formats
+    QVector<FrameAccumulator> m_accumulators;
+    QElapsedTimer m_frameClock;
+    quint32 m_settingsRevision;
+
+    // Conversion tables for the current gain and offset of each channel
+    Calibration m_calibration;
+
+    // Guided self-calibration: one triangle and one square step per gain,
+    // with the DDS output wired to the channel under calibration
+    CalibrationMeasurement m_calibrationMeasurement;
+    int m_calibrationChannel;
+    int m_calibrationStep;
+    double m_calibrationAmplitude;
+    int m_calibrationSkipped;
+    // Range the channel was on before calibrating, put back when it ends
+    int m_calibrationRestoreGain;
+    int m_calibrationRestoreOffset;
+
+    // Emulated DDS output when no device is connected
+    bool m_ddsRunning;
+    double m_emulatedDdsPhase;
+
+    // Latest frame as codes, kept so display settings can be re-applied
+    // without waiting for the next capture; m_minimum holds the lower trace
+    // in envelope mode. Both come from m_framePool, so consumers that outlive
+    // the next capture share them instead of copying. m_volts is converted
+    // from m_frame on demand through currentVolts(), or holds a frame that
+    // only exists in volts (an equivalent-time composite or a recording)
+    // when m_voltsCurrent is set and m_frame is not what is shown.
+    ScaledFramePool m_framePool;
+    SharedFrame m_frame;
+    SharedFrame m_minimum;
+    VoltFrame m_volts;
+    bool m_voltsCurrent;
+
+    // Equivalent-time composite replaces the frame for display when enabled;
+    // m_sampleSpacing is the distance between display samples in record
+    // samples (1 / factor for a composite)
+    EquivalentTimeSampler m_equivalentTime;
+    bool m_equivalentTimeEnabled;
+    double m_sampleSpacing;
+
+    // Sample rate of the selected timebase, in Hz
+    int m_sampleRateIndex;
+    double m_sampleRate;
+
+    // Spectrum for the DFT chart, computed only while it is shown
+    bool m_dftEnabled;
+    RealFFT m_dftPlan;
+    QVector<float> m_dftWindow;
+    QVector<float> m_dftBlock;
+    QVector<std::complex<float>> m_dftSpectrum;
+
+    DistortionAnalyzer m_distortion;
+    bool m_distortionEnabled;
+    int m_distortionChannel;
+
+    CrossChannelAnalyzer m_crossChannel;
+    bool m_crossChannelEnabled;
+
+    // Go/no-go testing of one channel; failing frames are optionally saved
+    // as CSV, up to MaxSavedMaskFailures per counter reset
+    MaskTest m_mask;
+    bool m_maskEnabled;
+    int m_maskChannel;
+    bool m_maskSaveFailures;
+    bool m_maskLastPassed;
+    int m_maskSavedFailures;
+    static constexpr int MaxSavedMaskFailures = 1000;
+
+    // Raw codes of every acquired frame go to disk while recording. An open
+    // recording can be searched in the background; each hit is shown by
+    // loading its frame in place of the live one.
+    // A change of gain, offset, calibration or timebase would leave the
+    // header converting new frames wrongly, so the recording continues in
+    // a new part file with its own header
+    RecordingWriter m_recorder;
+    QString m_recordingPath;    // First part
+    int m_recordingPart;
+    RecordingReader m_playback;
+    BlockSummary m_summary;
+    // Zoomable overview: the pyramid is collected while recording, or built
+    // in the background the first time an older recording is opened
+    PyramidBuilder m_pyramidBuilder;
+    RecordingPyramid m_pyramid;
+    QFutureWatcher<bool> m_pyramidWatcher;
+    QVector<float> m_overviewMinimum;
+    QVector<float> m_overviewMaximum;
+    QVector<float> m_overviewMean;
+    QFutureWatcher<QVector<EventSearch::Event>> m_searchWatcher;
+    EventSearch::Query m_searchQuery;
+    bool m_searchDone;
+    QVector<EventSearch::Event> m_events;
+    int m_currentEvent;
+
+    // Exports run in the background and report progress per batch; the
+    // watcher's result is the error, empty on success
+    QFutureWatcher<QString> m_exportWatcher;
+    QString m_exportPath;
+    double m_exportProgress;
+    std::atomic<bool> m_exportCancel;
+
+    // Serial traffic journal, and replay of one into the parser. Speed is a
+    // multiple of real time, 0 for as fast as possible; only the time spent
+    // in the parser counts towards the reported throughput.
+    SerialJournal m_journal;
+    JournalReader m_replay;
+    QTimer m_replayTimer;
+    QElapsedTimer m_replayClock;
+    double m_replaySpeed;
+    JournalReader::Record m_replayRecord;
+    bool m_replayPending;
+    quint64 m_replayRecords;
+    quint64 m_replayBytes;
+    qint64 m_replayParseTime;   // Nanoseconds
+
+    // Remote viewers; frames, spectra and measurements are only produced
+    // for it while some client subscribed to them
+    StreamServer m_stream;
+
+    // Frames for co-located readers, as codes in a seqlocked ring
+    static constexpr int SharedRingSlots = 16;
+    SharedRingWriter m_sharedRing;
+
+    // Roll mode: the device streams each conversion as it happens, one
+    // sample per channel in the selected format, and the parser appends
+    // every whole tick to the history at once. Without a device a timer
+    // emulates the stream at the sample rate.
+    bool m_rollMode;
+    bool m_rollRunning;         // Streaming, between Run and Stop
+    double m_rollSpan;
+    RollBuffer m_roll;
+    QByteArray m_rollPending;   // Bytes of a tick split across reads
+    QVector<float> m_rollVolts;
+    QVector<quint16> m_rollCodes;
+    QTimer m_rollTimer;
+    QElapsedTimer m_rollClock;
+    qint64 m_rollEmulated;
+    static constexpr int MaxRollSamples = 1 << 20;
+    static constexpr int RollEmulationInterval = 5;   // ms
+
+    Interpolator m_interpolator;
+    QVector<float> m_displayBuffer;
+    QVector<float> m_displayVolts;   // Visible codes and filter context in volts
+
+    // Heap allocations on the capture path of the last frame, display
+    // excluded; -1 unless the build counts allocations
+    qint64 m_frameAllocations;
+    int m_framePoolSize;
+    int m_visibleFirst;
+    int m_visibleLast;
+
+    void processIncomingData(const QByteArray &data, qint64 timestamp);
+    template<SampleFormat F> void unpackFrame();
+    template<SampleFormat F> void unpackRoll(const uchar *data, int ticks);
+    void processRollData(const QByteArray &data);
+    void configureRoll();
+    void startRoll();
+    void emulateRoll();
+    void acquireFrame(bool wide = false);
+    const VoltFrame &currentVolts();
+    void publishFrame();
+    void calculateDFT(const float *volts, int count);
+    void analyzeDistortion();
+    void streamMeasurements();
+    void testMask();
+    void saveMaskFailure();
+    void publishMask();
+    void finishSearch();
+    void finishPyramid();
+    void startExport(const QString &path, int format, const ExportSource &source);
+    void finishExport();
+    void replayStep();
+    void finishReplay();
     quint16 calculatePhaseStep(double frequency, quint32 clockFrequency);
     void sendCommand(const QByteArray &command);
     void initializeWaveformTables();
     void generateTestData();
+    quint8 emulateFrontEnd(int channel, double volts);
+    QString defaultCalibrationPath() const;
+    void beginCalibrationStep();
+    void finishCalibrationStep();
+    void sendGain(int channel, int gainIndex);
+    void sendOffset(int channel, int offsetSetting);
+    void restoreCalibrationRange(int channel);
+    void applyRecordLength(int length);
+    void confirmRecordLength(int length);
+    void checkRecordingScale();
 
     // Helper functions to convert between QVector<QPointF> and QVariantList
     QVariantList pointsToVariantList(const QVector<QPointF> &points);
@@ -0,0 +1,142 @@
+#include "sharedring.h"
+#include "sharedringreader.h"
+#include <new>
+
+#if defined(Q_OS_UNIX)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+SharedRingWriter::SharedRingWriter() :
+    m_map(nullptr),
+    m_size(0),
+    m_next(0)
+{
+}
+
+SharedRingWriter::~SharedRingWriter()
+{
+    close();
+}
+
+SharedRing::RingHeader *SharedRingWriter::header() const
+{
+    return reinterpret_cast<SharedRing::RingHeader *>(m_map);
+}
+
+bool SharedRingWriter::open(const QString &name, int slotCount, int maxChannels, int maxLength, QString *error)
+{
+    close();
+
+#if defined(Q_OS_UNIX)
+
+    const QByteArray path = (name.startsWith('/') ? name : QStringLiteral("/") + name).toLocal8Bit();
+    const quint32 headerBytes = SharedRing::alignUp(sizeof(SharedRing::RingHeader));
+    const quint32 slotBytes = SharedRing::slotBytes(maxChannels, maxLength);
+    const qsizetype size = qsizetype(headerBytes) + qsizetype(slotCount) * slotBytes;
+
+    // A fresh object each time, so a reader still mapping an old ring keeps
+    // its layout until it reopens
+    ::shm_unlink(path.constData());
+    const int fd = ::shm_open(path.constData(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        if (error) *error = QString::fromLocal8Bit(strerror(errno));
+        return false;
+    }
+    if (::ftruncate(fd, size) != 0) {
+        if (error) *error = QString::fromLocal8Bit(strerror(errno));
+        ::close(fd);
+        ::shm_unlink(path.constData());
+        return false;
+    }
+    void *map = ::mmap(nullptr, size_t(size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        if (error) *error = QString::fromLocal8Bit(strerror(errno));
+        ::shm_unlink(path.constData());
+        return false;
+    }
+
+    // ftruncate zero-fills, so every slot starts with sequence 0: empty
+    m_map = static_cast<uchar *>(map);
+    m_size = size;
+    m_name = QString::fromLocal8Bit(path);
+    m_next = 0;
+
+    SharedRing::RingHeader *h = new (m_map) SharedRing::RingHeader;
+    h->slotCount = quint32(slotCount);
+    h->maxChannels = quint32(maxChannels);
+    h->maxLength = quint32(maxLength);
+    h->slotBytes = slotBytes;
+    h->headerBytes = headerBytes;
+    h->dataOffset = SharedRing::dataOffset(maxChannels);
+    h->channelStride = SharedRing::channelStride(maxLength);
+    h->writerOpen = 1;
+    h->version = SharedRing::Version;
+    h->published.store(0, std::memory_order_relaxed);
+    // Readers check the magic last, so they never see a half-made header
+    std::atomic_thread_fence(std::memory_order_release);
+    h->magic = SharedRing::Magic;
+    return true;
+#else
+    Q_UNUSED(name);
+    Q_UNUSED(slotCount);
+    Q_UNUSED(maxChannels);
+    Q_UNUSED(maxLength);
+    if (error) *error = QStringLiteral("shared-memory rings need POSIX shared memory");
+    return false;
+#endif
+}
+
+void SharedRingWriter::close()
+{
+    if (!m_map) return;
+    header()->writerOpen = 0;
+#if defined(Q_OS_UNIX)
+    ::munmap(m_map, size_t(m_size));
+    ::shm_unlink(m_name.toLocal8Bit().constData());
+#endif
+    m_map = nullptr;
+    m_size = 0;
+}
+
+bool SharedRingWriter::write(const ScaledFrame &frame)
+{
+    if (!m_map) return false;
+    SharedRing::RingHeader *h = header();
+    if (quint32(frame.channels()) > h->maxChannels || quint32(frame.length()) > h->maxLength) return false;
+
+    uchar *slot = m_map + h->headerBytes + qsizetype(m_next % h->slotCount) * h->slotBytes;
+    SharedRing::SlotHeader *sh = reinterpret_cast<SharedRing::SlotHeader *>(slot);
+    SharedRing::ChannelInfo *info = reinterpret_cast<SharedRing::ChannelInfo *>(slot + sizeof(SharedRing::SlotHeader));
+
+    // Odd while the slot is rewritten; readers that saw the old even value
+    // find it changed and discard what they read
+    sh->sequence.store(2 * m_next + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    sh->timestamp = frame.info.timestamp;
+    sh->sampleRate = frame.info.sampleRate;
+    sh->revision = frame.info.revision;
+    sh->channels = quint32(frame.channels());
+    sh->length = quint32(frame.length());
+    for (int c = 0; c < frame.channels(); ++c) {
+        const ChannelScale &scale = frame.scale(c);
+        info[c].scale = scale.scale;
+        info[c].offset = scale.offset;
+        if (scale.table.size() == SharedRing::TableSize) {
+            info[c].tableSize = SharedRing::TableSize;
+            std::memcpy(info[c].table, scale.table.constData(), sizeof(info[c].table));
+        } else {
+            info[c].tableSize = 0;
+        }
+        std::memcpy(slot + h->dataOffset + qsizetype(c) * h->channelStride, frame.channel(c),
+                    size_t(frame.length()) * sizeof(quint16));
+    }
+
+    sh->sequence.store(2 * m_next + 2, std::memory_order_release);
+    h->published.store(++m_next, std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,41 @@
+#ifndef SHAREDRING_H
+#define SHAREDRING_H
+
+#include <QString>
+#include <QByteArray>
+#include "scaledframe.h"
+
+namespace SharedRing { struct RingHeader; }
+
+// Writer side of the shared-memory frame ring described in
+// sharedringreader.h. Each frame is copied once, as codes, into the next
+// slot under its sequence counter; the writer never looks at readers.
+// POSIX shared memory only; elsewhere open() fails and nothing is shared.
+class SharedRingWriter
+{
+public:
+    SharedRingWriter();
+    ~SharedRingWriter();
+
+    // Creates or replaces /dev/shm/<name> sized for frames up to the given
+    // dimensions
+    bool open(const QString &name, int slotCount, int maxChannels, int maxLength, QString *error = nullptr);
+    void close();
+
+    bool isOpen() const { return m_map != nullptr; }
+    QString name() const { return m_name; }
+    quint64 published() const { return m_next; }
+
+    // False when the frame exceeds the ring's dimensions
+    bool write(const ScaledFrame &frame);
+
+private:
+    SharedRing::RingHeader *header() const;
+
+    QString m_name;
+    uchar *m_map;
+    qsizetype m_size;
+    quint64 m_next;
+};
+
+#endif // SHAREDRING_H
@@ -0,0 +1,255 @@
+#ifndef SHAREDRINGREADER_H
+#define SHAREDRINGREADER_H
+
+// Layout of the shared-memory frame ring and a reader for it. This header
+// needs only C++17, so analysis tools can include it without Qt; the
+// reader also needs POSIX shared memory and is left out elsewhere.
+//
+// The writer creates /dev/shm/<name> holding a RingHeader followed by
+// `slotCount` slots of `slotBytes` each, the first at `headerBytes`. Every
+// offset is from the start of the mapping and every field is in the host's
+// byte order. A slot is a SlotHeader, then `maxChannels` ChannelInfo, then
+// `maxChannels` code arrays of `maxLength` u16 each, starting at
+// `dataOffset` and `channelStride` bytes apart; only the first `channels`
+// hold data, and only their first `length` codes.
+//
+// Frame n goes to slot n % slotCount. Its SlotHeader::sequence is 2n + 1 while
+// the writer fills it and 2n + 2 once it is complete; RingHeader::published
+// is the number of frames completed so far. A reader checks the sequence
+// before and after reading a slot and discards the read if it changed, so
+// the writer never waits for readers and readers never take a lock. A
+// reader that falls more than `slotCount` frames behind finds its frame
+// overwritten and skips ahead.
+//
+// Codes are 8.8 fixed point. Volts are code * scale + offset, or, when
+// tableSize is non-zero, interpolated from the table:
+//   k = code >> 8, volts = table[k] + (table[k + 1] - table[k]) * (code & 0xFF) / 256
+//
+// In bytes: RingHeader is 64, its ten u32 fields in order from 0 and
+// `published` (u64) at 40. SlotHeader is 64: sequence u64 at 0, timestamp
+// i64 at 8, sampleRate f64 at 16, then u32 revision, channels and length at
+// 24, 28 and 32. ChannelInfo is 1040. From Python, numpy.frombuffer over an
+// mmap of the file with these offsets gives the same zero-copy view.
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SHAREDRING_READER 1
+#endif
+
+namespace SharedRing {
+
+constexpr uint32_t Magic = 0x47525853;   // "SXRG"
+constexpr uint32_t Version = 1;
+constexpr int TableSize = 257;
+
+struct alignas(64) RingHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t maxChannels;
+    uint32_t maxLength;
+    uint32_t slotBytes;
+    uint32_t headerBytes;
+    uint32_t dataOffset;      // Of channel 0's codes within a slot
+    uint32_t channelStride;
+    uint32_t writerOpen;      // Cleared when the writer closes the ring
+    std::atomic<uint64_t> published;
+};
+
+struct alignas(64) SlotHeader
+{
+    std::atomic<uint64_t> sequence;
+    int64_t timestamp;        // Monotonic nanoseconds at acquisition
+    double sampleRate;        // Hz
+    uint32_t revision;        // Settings revision; changes with gain, timebase, ...
+    uint32_t channels;
+    uint32_t length;
+};
+
+struct ChannelInfo
+{
+    float scale;
+    float offset;
+    uint32_t tableSize;       // 0 when linear, otherwise TableSize
+    float table[TableSize];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the ring needs lock-free 64-bit atomics");
+static_assert(sizeof(RingHeader) == 64 && sizeof(SlotHeader) == 64 && sizeof(ChannelInfo) == 1040,
+              "the layout is shared with other processes");
+
+inline uint32_t alignUp(uint64_t bytes)
+{
+    return uint32_t((bytes + 63) & ~uint64_t(63));
+}
+
+inline uint32_t dataOffset(uint32_t maxChannels)
+{
+    return alignUp(sizeof(SlotHeader) + maxChannels * sizeof(ChannelInfo));
+}
+
+inline uint32_t channelStride(uint32_t maxLength)
+{
+    return alignUp(uint64_t(maxLength) * sizeof(uint16_t));
+}
+
+inline uint32_t slotBytes(uint32_t maxChannels, uint32_t maxLength)
+{
+    return dataOffset(maxChannels) + maxChannels * channelStride(maxLength);
+}
+
+#ifdef SHAREDRING_READER
+
+// Read-only view of a ring. Frames are read in place; a reader following
+// the writer looks like
+//
+//   for (uint64_t next = reader.published(); ; ) {
+//       SharedRing::Reader::Frame frame;
+//       if (reader.frame(next, &frame)) {
+//           ... read frame.codes(c) ...
+//           if (reader.valid(frame)) ... use what was read ...
+//           ++next;
+//       } else if (next < reader.oldest()) {
+//           next = reader.oldest();   // Fell behind the writer
+//       } else {
+//           ... not written yet, wait a little ...
+//       }
+//   }
+//
+// copy() reads one channel into caller memory in one step.
+class Reader
+{
+public:
+    struct Frame {
+        uint64_t index = 0;
+        uint64_t sequence = 0;
+        const SlotHeader *header = nullptr;
+        const ChannelInfo *info = nullptr;
+        const uint8_t *data = nullptr;
+        uint32_t stride = 0;
+
+        const uint16_t *codes(int channel) const
+        {
+            return reinterpret_cast<const uint16_t *>(data + size_t(channel) * stride);
+        }
+
+        float volts(int channel, uint16_t code) const
+        {
+            const ChannelInfo &c = info[channel];
+            if (c.tableSize == 0) return code * c.scale + c.offset;
+            const int k = code >> 8;
+            return c.table[k] + (c.table[k + 1] - c.table[k]) * (code & 0xFF) * (1.0f / 256.0f);
+        }
+    };
+
+    Reader() = default;
+    Reader(const Reader &) = delete;
+    Reader &operator=(const Reader &) = delete;
+    ~Reader() { close(); }
+
+    bool open(const std::string &name)
+    {
+        close();
+        const std::string path = name.empty() || name[0] != '/' ? "/" + name : name;
+        const int fd = ::shm_open(path.c_str(), O_RDONLY, 0);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(RingHeader)) {
+            ::close(fd);
+            return false;
+        }
+        void *map = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) return false;
+
+        m_map = static_cast<const uint8_t *>(map);
+        m_size = size_t(st.st_size);
+        const RingHeader *h = header();
+        if (h->magic != Magic || h->version != Version
+            || uint64_t(h->headerBytes) + uint64_t(h->slotCount) * h->slotBytes > m_size) {
+            close();
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return true;
+    }
+
+    void close()
+    {
+        if (m_map) ::munmap(const_cast<uint8_t *>(m_map), m_size);
+        m_map = nullptr;
+        m_size = 0;
+    }
+
+    bool isOpen() const { return m_map != nullptr; }
+    // False once the writer has closed the ring; reopen to follow a new one
+    bool writerOpen() const { return m_map && header()->writerOpen != 0; }
+    uint32_t slotCount() const { return header()->slotCount; }
+    uint32_t maxChannels() const { return header()->maxChannels; }
+    uint32_t maxLength() const { return header()->maxLength; }
+    uint64_t published() const { return header()->published.load(std::memory_order_acquire); }
+
+    // First frame still safe to start reading; the one before it may
+    // already be being overwritten
+    uint64_t oldest() const
+    {
+        const uint64_t count = published();
+        return count >= slotCount() ? count - slotCount() + 1 : 0;
+    }
+
+    // Frame `index` if it is complete and still in the ring. Its contents
+    // are only trustworthy if valid() still holds after reading them.
+    bool frame(uint64_t index, Frame *out) const
+    {
+        const RingHeader *h = header();
+        const uint8_t *slot = m_map + h->headerBytes + size_t(index % h->slotCount) * h->slotBytes;
+        const SlotHeader *sh = reinterpret_cast<const SlotHeader *>(slot);
+        const uint64_t sequence = sh->sequence.load(std::memory_order_acquire);
+        if (sequence != 2 * index + 2) return false;
+
+        out->index = index;
+        out->sequence = sequence;
+        out->header = sh;
+        out->info = reinterpret_cast<const ChannelInfo *>(slot + sizeof(SlotHeader));
+        out->data = slot + h->dataOffset;
+        out->stride = h->channelStride;
+        return true;
+    }
+
+    bool valid(const Frame &frame) const
+    {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return frame.header->sequence.load(std::memory_order_relaxed) == frame.sequence;
+    }
+
+    // Copies channel `channel` of frame `index` as codes, up to `capacity`;
+    // returns the number of samples, or -1 if the frame is not available
+    int copy(uint64_t index, int channel, uint16_t *codes, int capacity) const
+    {
+        Frame f;
+        if (!frame(index, &f) || channel < 0 || uint32_t(channel) >= f.header->channels) return -1;
+        const int count = int(f.header->length) < capacity ? int(f.header->length) : capacity;
+        std::memcpy(codes, f.codes(channel), size_t(count) * sizeof(uint16_t));
+        return valid(f) ? count : -1;
+    }
+
+private:
+    const RingHeader *header() const { return reinterpret_cast<const RingHeader *>(m_map); }
+
+    const uint8_t *m_map = nullptr;
+    size_t m_size = 0;
+};
+#endif // SHAREDRING_READER
+
+} // namespace SharedRing
+
+#endif // SHAREDRINGREADER_H
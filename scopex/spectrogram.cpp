@@ -0,0 +1,146 @@
+#include "spectrogram.h"
+#include <QColor>
+#include <QtMath>
+#include <cstring>
+
+namespace {
+struct ColorStop {
+    double position;
+    int r, g, b;
+};
+
+// Perceptually ordered dark-to-bright map, so weak components stay visible
+const ColorStop colorStops[] = {
+    { 0.00,   0,   0,   4 },
+    { 0.25,  87,  16, 110 },
+    { 0.50, 188,  55,  84 },
+    { 0.75, 249, 142,   9 },
+    { 1.00, 252, 255, 164 }
+};
+}
+
+Spectrogram::Spectrogram() :
+    m_inputMode(Stream),
+    m_overlap(0.5),
+    m_minDb(-80.0f),
+    m_maxDb(20.0f),
+    m_amplitudeScale(1.0f),
+    m_inputFill(0),
+    m_head(0),
+    m_rowsProduced(0)
+{
+    for (int i = 0; i < 256; ++i) {
+        const double t = i / 255.0;
+        int s = 0;
+        while (s < 3 && colorStops[s + 1].position < t) ++s;
+        const ColorStop &a = colorStops[s];
+        const ColorStop &b = colorStops[s + 1];
+        const double f = (t - a.position) / (b.position - a.position);
+        const uchar rgba[4] = {
+            static_cast<uchar>(a.r + (b.r - a.r) * f),
+            static_cast<uchar>(a.g + (b.g - a.g) * f),
+            static_cast<uchar>(a.b + (b.b - a.b) * f),
+            255
+        };
+        std::memcpy(&m_palette[i], rgba, sizeof(rgba));
+    }
+
+    configure(2048, 256, 0.5);
+}
+
+void Spectrogram::configure(int fftSize, int rows, double overlap)
+{
+    fftSize = FFT::nextPowerOfTwo(qBound(64, fftSize, 65536));
+    rows = qBound(16, rows, 4096);
+    m_overlap = qBound(0.0, overlap, 0.95);
+
+    m_fft.setSize(fftSize);
+    m_amplitudeScale = static_cast<float>(2.0 / Window::fill(Window::Hann, fftSize, m_window));
+    m_input.resize(fftSize);
+    m_block.resize(fftSize);
+    m_spectrum.resize(fftSize / 2 + 1);
+
+    if (m_image.width() != fftSize / 2 || m_image.height() != rows) {
+        m_image = QImage(fftSize / 2, rows, QImage::Format_RGBA8888);
+    }
+    reset();
+}
+
+void Spectrogram::setInputMode(InputMode mode)
+{
+    m_inputMode = mode;
+    m_inputFill = 0;
+}
+
+void Spectrogram::setRange(float minDb, float maxDb)
+{
+    m_minDb = minDb;
+    m_maxDb = qMax(minDb + 1.0f, maxDb);
+}
+
+void Spectrogram::reset()
+{
+    m_image.fill(QColor(0, 0, 4));
+    m_head = 0;
+    m_inputFill = 0;
+    m_rowsProduced = 0;
+}
+
+int Spectrogram::addSamples(const float *samples, int count)
+{
+    const int size = m_fft.size();
+    int produced = 0;
+
+    if (m_inputMode == PerFrame) {
+        // One row per frame, truncated or zero padded to the FFT size
+        const int n = qMin(count, size);
+        std::copy(samples, samples + n, m_block.begin());
+        std::fill(m_block.begin() + n, m_block.end(), 0.0f);
+        produceRow(m_block.constData());
+        return 1;
+    }
+
+    // Stream mode: fill the window, emit a row, then keep the overlap
+    const int hop = qMax(1, qRound(size * (1.0 - m_overlap)));
+    while (count > 0) {
+        const int take = qMin(count, size - m_inputFill);
+        std::copy(samples, samples + take, m_input.begin() + m_inputFill);
+        m_inputFill += take;
+        samples += take;
+        count -= take;
+
+        if (m_inputFill == size) {
+            produceRow(m_input.constData());
+            ++produced;
+            std::memmove(m_input.data(), m_input.constData() + hop, (size - hop) * sizeof(float));
+            m_inputFill = size - hop;
+        }
+    }
+    return produced;
+}
+
+void Spectrogram::produceRow(const float *block)
+{
+    const int size = m_fft.size();
+    const int bins = size / 2;
+
+    float *windowed = m_block.data();
+    const float *window = m_window.constData();
+    for (int n = 0; n < size; ++n) {
+        windowed[n] = block[n] * window[n];
+    }
+    m_fft.forward(windowed, m_spectrum.data());
+
+    // Power in dB against the colour range, written straight into the ring
+    const float power = m_amplitudeScale * m_amplitudeScale;
+    const float indexScale = 255.0f / (m_maxDb - m_minDb);
+    quint32 *row = reinterpret_cast<quint32 *>(m_image.scanLine(m_head));
+    for (int k = 0; k < bins; ++k) {
+        const float db = 10.0f * std::log10(std::norm(m_spectrum[k]) * power + 1e-20f);
+        const int index = qBound(0, static_cast<int>((db - m_minDb) * indexScale), 255);
+        row[k] = m_palette[index];
+    }
+
+    m_head = (m_head + 1) % m_image.height();
+    ++m_rowsProduced;
+}
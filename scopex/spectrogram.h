@@ -0,0 +1,65 @@
+#ifndef SPECTROGRAM_H
+#define SPECTROGRAM_H
+
+#include <QImage>
+#include <QVector>
+#include <complex>
+#include "fft.h"
+
+// Time-frequency rows for the waterfall view. Samples are either transformed
+// one frame at a time or treated as a continuous stream cut into overlapping
+// windows. Each magnitude row is colour mapped straight into a preallocated
+// ring image, rows() high and bins() wide, whose row head() is written next.
+class Spectrogram
+{
+public:
+    enum InputMode {
+        PerFrame = 0,
+        Stream = 1
+    };
+
+    Spectrogram();
+
+    void configure(int fftSize, int rows, double overlap);
+    void setInputMode(InputMode mode);
+    void setRange(float minDb, float maxDb);
+    void reset();
+
+    InputMode inputMode() const { return m_inputMode; }
+    int fftSize() const { return m_fft.size(); }
+    int bins() const { return m_fft.size() / 2; }
+    int rows() const { return m_image.height(); }
+    double overlap() const { return m_overlap; }
+
+    // Feeds samples; a PerFrame call is one whole frame. Returns the number
+    // of rows produced.
+    int addSamples(const float *samples, int count);
+
+    const QImage &image() const { return m_image; }
+    int head() const { return m_head; }
+    quint64 rowsProduced() const { return m_rowsProduced; }
+
+private:
+    void produceRow(const float *block);
+
+    InputMode m_inputMode;
+    double m_overlap;
+    float m_minDb;
+    float m_maxDb;
+
+    RealFFT m_fft;
+    QVector<float> m_window;
+    float m_amplitudeScale;
+
+    QVector<float> m_input;   // Stream mode window being filled
+    int m_inputFill;
+    QVector<float> m_block;
+    QVector<std::complex<float>> m_spectrum;
+
+    QImage m_image;
+    int m_head;
+    quint64 m_rowsProduced;
+    quint32 m_palette[256];
+};
+
+#endif // SPECTROGRAM_H
@@ -0,0 +1,334 @@
+#include "streamserver.h"
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+const int SubscribeBytes = 16;
+const int MaxRequestBytes = 1024;
+
+template<typename T>
+void put(QByteArray &out, T value)
+{
+    char bytes[sizeof(T)];
+    qToLittleEndian<T>(value, bytes);
+    out.append(bytes, sizeof(T));
+}
+
+void putFloat(QByteArray &out, float value)
+{
+    quint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put<quint32>(out, bits);
+}
+
+void putDouble(QByteArray &out, double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put<quint64>(out, bits);
+}
+
+float takeFloat(const uchar *in)
+{
+    const quint32 bits = qFromLittleEndian<quint32>(in);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Numbers only; nested maps become dotted names
+void flatten(const QVariantMap &map, const QByteArray &prefix, QVector<QPair<QByteArray, double>> &out)
+{
+    for (auto it = map.cbegin(); it != map.cend(); ++it) {
+        const QByteArray name = prefix + it.key().toUtf8();
+        switch (it.value().typeId()) {
+        case QMetaType::QVariantMap:
+            flatten(it.value().toMap(), name + '.', out);
+            break;
+        case QMetaType::Bool:
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::LongLong:
+        case QMetaType::ULongLong:
+        case QMetaType::Float:
+        case QMetaType::Double:
+            if (name.size() <= 255) out.append(qMakePair(name, it.value().toDouble()));
+            break;
+        default:
+            break;
+        }
+    }
+}
+}
+
+StreamServer::StreamServer(QObject *parent) : QObject(parent),
+    m_subscribed(0),
+    m_sequence{0, 0, 0},
+    m_dropped(0)
+{
+    m_clock.start();
+    connect(&m_server, &QTcpServer::newConnection, this, &StreamServer::handleConnection);
+}
+
+StreamServer::~StreamServer()
+{
+    close();
+}
+
+bool StreamServer::listen(const QHostAddress &address, quint16 port, QString *error)
+{
+    close();
+    if (!m_server.listen(address, port)) {
+        if (error) *error = m_server.errorString();
+        return false;
+    }
+    m_dropped = 0;
+    return true;
+}
+
+void StreamServer::close()
+{
+    m_server.close();
+    while (!m_clients.isEmpty()) removeClient(m_clients.last());
+}
+
+void StreamServer::handleConnection()
+{
+    while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+        Client *client = new Client;
+        client->socket = socket;
+        client->queue.reserve(client->depth);
+        // Small messages go out as they are written; frames are large anyway
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        m_clients.append(client);
+
+        connect(socket, &QTcpSocket::readyRead, this, [this, client]() { handleReadyRead(client); });
+        connect(socket, &QTcpSocket::bytesWritten, this, [this, client]() { flush(client); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, client]() { removeClient(client); });
+
+        beginMessage(Hello);
+        put<quint32>(m_buffer, FrameStream | SpectrumStream | MeasurementStream);
+        endMessage();
+        socket->write(m_buffer);
+    }
+    emit clientsChanged();
+}
+
+void StreamServer::handleReadyRead(Client *client)
+{
+    client->received.append(client->socket->readAll());
+
+    while (client->received.size() >= HeaderBytes) {
+        const uchar *header = reinterpret_cast<const uchar *>(client->received.constData());
+        const quint32 length = qFromLittleEndian<quint32>(header + 4);
+        if (length > quint32(MaxRequestBytes)) {
+            // Not a viewer speaking this protocol
+            removeClient(client);
+            return;
+        }
+        if (client->received.size() < HeaderBytes + qsizetype(length)) return;
+
+        if (header[0] == Subscribe && length >= quint32(SubscribeBytes)) {
+            const uchar *payload = header + HeaderBytes;
+            const float rate = takeFloat(payload + 8);
+            client->streams = int(qFromLittleEndian<quint32>(payload)) & (FrameStream | SpectrumStream | MeasurementStream);
+            client->decimation = int(qBound<quint32>(1, qFromLittleEndian<quint32>(payload + 4), 65536));
+            client->minInterval = rate > 0.0f ? qint64(1e9 / rate) : 0;
+            client->depth = int(qBound<quint32>(1, qFromLittleEndian<quint32>(payload + 12), MaxQueueDepth));
+            while (client->queue.size() > client->depth) client->queue.removeFirst();
+            client->queue.reserve(client->depth);
+            updateSubscriptions();
+        }
+        client->received.remove(0, HeaderBytes + length);
+    }
+}
+
+void StreamServer::removeClient(Client *client)
+{
+    if (!m_clients.removeOne(client)) return;
+    disconnect(client->socket, nullptr, this, nullptr);
+    client->socket->abort();
+    client->socket->deleteLater();
+    delete client;
+    updateSubscriptions();
+    emit clientsChanged();
+}
+
+void StreamServer::updateSubscriptions()
+{
+    m_subscribed = 0;
+    for (const Client *client : std::as_const(m_clients)) m_subscribed |= client->streams;
+}
+
+void StreamServer::publishFrame(const SharedFrame &frame)
+{
+    if (!wants(FrameStream) || frame.isNull()) return;
+    Message message;
+    message.type = Frame;
+    message.sequence = m_sequence[0]++;
+    message.frame = frame;
+    enqueue(message, 0);
+}
+
+void StreamServer::publishSpectrum(const QVector<float> &magnitudes, double binWidth)
+{
+    if (!wants(SpectrumStream)) return;
+    Message message;
+    message.type = Spectrum;
+    message.sequence = m_sequence[1]++;
+    message.spectrum = magnitudes;
+    message.binWidth = binWidth;
+    enqueue(message, 1);
+}
+
+void StreamServer::publishMeasurements(const QVariantMap &values)
+{
+    if (!wants(MeasurementStream)) return;
+    Message message;
+    message.type = Measurements;
+    message.sequence = m_sequence[2]++;
+    flatten(values, QByteArray(), message.values);
+    enqueue(message, 2);
+}
+
+void StreamServer::enqueue(const Message &message, int stream)
+{
+    const qint64 now = m_clock.nsecsElapsed();
+    const quint64 droppedBefore = m_dropped;
+
+    for (Client *client : std::as_const(m_clients)) {
+        if (!(client->streams & (1 << stream))) continue;
+
+        qint64 &last = client->lastQueued[stream];
+        if (client->minInterval > 0 && last >= 0 && now - last < client->minInterval) continue;
+        last = now;
+
+        if (client->queue.size() >= client->depth) {
+            // Stale data of the same kind goes first, so a burst of frames
+            // cannot push out the measurements queued behind them
+            int victim = 0;
+            for (int i = 0; i < client->queue.size(); ++i) {
+                if (client->queue[i].type == message.type) {
+                    victim = i;
+                    break;
+                }
+            }
+            client->queue.removeAt(victim);
+            ++m_dropped;
+        }
+        client->queue.append(message);
+        flush(client);
+    }
+
+    if (m_dropped != droppedBefore) emit droppedChanged();
+}
+
+void StreamServer::flush(Client *client)
+{
+    // Only as much as the socket takes without buffering up; the rest waits
+    // in the queue, where newer data can still replace it
+    while (!client->queue.isEmpty() && client->socket->bytesToWrite() < MaxBuffered) {
+        const Message message = client->queue.takeFirst();
+        encode(message, *client);
+        client->socket->write(m_buffer);
+    }
+}
+
+void StreamServer::encode(const Message &message, const Client &client)
+{
+    const int decimation = client.decimation;
+    beginMessage(message.type);
+
+    switch (message.type) {
+    case Frame: {
+        const ScaledFrame &frame = *message.frame;
+        const int length = (frame.length() + decimation - 1) / decimation;
+        put<quint64>(m_buffer, message.sequence);
+        put<qint64>(m_buffer, frame.info.timestamp);
+        putDouble(m_buffer, frame.info.sampleRate / decimation);
+        put<quint32>(m_buffer, frame.info.revision);
+        put<quint16>(m_buffer, quint16(frame.channels()));
+        put<quint16>(m_buffer, 0);
+        put<quint32>(m_buffer, quint32(length));
+
+        for (int c = 0; c < frame.channels(); ++c) {
+            const ChannelScale &scale = frame.scale(c);
+            const bool linear = scale.table.isEmpty();
+            putFloat(m_buffer, scale.scale);
+            putFloat(m_buffer, scale.offset);
+            put<quint8>(m_buffer, linear ? 0 : 1);
+            m_buffer.append(3, '\0');
+
+            const qsizetype at = m_buffer.size();
+            if (linear) {
+                m_buffer.resize(at + qsizetype(length) * 2);
+                uchar *out = reinterpret_cast<uchar *>(m_buffer.data() + at);
+                const quint16 *codes = frame.channel(c);
+                if (decimation == 1) {
+                    qToLittleEndian<quint16>(codes, length, out);
+                } else {
+                    for (int i = 0; i < length; ++i) qToLittleEndian<quint16>(codes[i * decimation], out + i * 2);
+                }
+            } else {
+                m_volts.resize(length);
+                if (decimation == 1) {
+                    frame.volts(c, 0, length, m_volts.data());
+                } else {
+                    for (int i = 0; i < length; ++i) m_volts[i] = frame.volts(c, i * decimation);
+                }
+                m_buffer.resize(at + qsizetype(length) * 4);
+                uchar *out = reinterpret_cast<uchar *>(m_buffer.data() + at);
+                for (int i = 0; i < length; ++i) {
+                    quint32 bits;
+                    std::memcpy(&bits, &m_volts[i], sizeof(bits));
+                    qToLittleEndian<quint32>(bits, out + i * 4);
+                }
+            }
+        }
+        break;
+    }
+    case Spectrum: {
+        const QVector<float> &spectrum = message.spectrum;
+        const int bins = int((spectrum.size() + decimation - 1) / decimation);
+        put<quint64>(m_buffer, message.sequence);
+        putDouble(m_buffer, message.binWidth * decimation);
+        put<quint32>(m_buffer, quint32(bins));
+        for (int b = 0; b < bins; ++b) {
+            const int first = b * decimation;
+            const int last = qMin(int(spectrum.size()), first + decimation);
+            float peak = spectrum[first];
+            for (int k = first + 1; k < last; ++k) peak = qMax(peak, spectrum[k]);
+            putFloat(m_buffer, peak);
+        }
+        break;
+    }
+    case Measurements:
+        put<quint64>(m_buffer, message.sequence);
+        put<quint16>(m_buffer, quint16(qMin<qsizetype>(message.values.size(), 65535)));
+        for (int i = 0; i < message.values.size() && i < 65535; ++i) {
+            const QByteArray &name = message.values[i].first;
+            put<quint8>(m_buffer, quint8(name.size()));
+            m_buffer.append(name);
+            putDouble(m_buffer, message.values[i].second);
+        }
+        break;
+    default:
+        break;
+    }
+
+    endMessage();
+}
+
+void StreamServer::beginMessage(MessageType type)
+{
+    m_buffer.clear();
+    put<quint8>(m_buffer, quint8(type));
+    put<quint8>(m_buffer, Version);
+    put<quint16>(m_buffer, 0);
+    put<quint32>(m_buffer, 0);
+}
+
+void StreamServer::endMessage()
+{
+    qToLittleEndian<quint32>(quint32(m_buffer.size() - HeaderBytes), m_buffer.data() + 4);
+}
@@ -0,0 +1,133 @@
+#ifndef STREAMSERVER_H
+#define STREAMSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QVariantMap>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QPair>
+#include "scaledframe.h"
+
+// Publishes frames, spectra and measurements to viewers over TCP. Every
+// message is an 8 byte header
+//   u8 type, u8 version, u16 reserved, u32 payload bytes
+// followed by the payload, all little-endian. The server greets each client
+// with Hello (u32 streams offered); a client subscribes by sending Subscribe
+//   u32 streams, u32 decimation, f32 max rate (Hz, 0 = every frame),
+//   u32 queue depth
+// and may resend it at any time. The server then sends
+//   Frame        u64 sequence, i64 timestamp ns, f64 sample rate,
+//                u32 revision, u16 channels, u16 reserved, u32 length, then per
+//                channel f32 scale, f32 offset, u8 encoding, 3 pad bytes and
+//                `length` samples: u16 codes (volts = code * scale + offset)
+//                or, for channels with a nonlinear table, f32 volts
+//   Spectrum     u64 sequence, f64 bin width Hz, u32 bins, f32 magnitudes
+//   Measurements u64 sequence, u16 count, then per value u8 name length,
+//                name, f64 value
+// Decimation keeps every Nth sample, as a slower timebase would, and takes
+// the peak of each N bins of a spectrum.
+//
+// Each client has a bounded queue. Frames are queued by handle, so
+// publishing costs a reference count per client, and are encoded only when
+// the socket has drained below MaxBuffered. When the queue is full the
+// oldest message of the same type is dropped, so a slow viewer sees the
+// latest data late rather than old data forever, and acquisition never
+// waits for it.
+class StreamServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum MessageType {
+        Hello = 1,
+        Subscribe = 2,
+        Frame = 3,
+        Spectrum = 4,
+        Measurements = 5
+    };
+
+    enum Stream {
+        FrameStream = 0x1,
+        SpectrumStream = 0x2,
+        MeasurementStream = 0x4
+    };
+
+    static constexpr quint8 Version = 1;
+    static constexpr quint16 DefaultPort = 52100;
+    static constexpr int HeaderBytes = 8;
+    static constexpr int DefaultQueueDepth = 4;
+    static constexpr int MaxQueueDepth = 64;
+    static constexpr qint64 MaxBuffered = 256 * 1024;
+
+    explicit StreamServer(QObject *parent = nullptr);
+    ~StreamServer();
+
+    bool listen(const QHostAddress &address, quint16 port, QString *error = nullptr);
+    void close();
+
+    bool isListening() const { return m_server.isListening(); }
+    quint16 port() const { return m_server.serverPort(); }
+    int clientCount() const { return m_clients.size(); }
+    quint64 droppedMessages() const { return m_dropped; }
+
+    // True when some client subscribed to any of `streams`, so producers can
+    // skip work nobody receives
+    bool wants(int streams) const { return (m_subscribed & streams) != 0; }
+
+    void publishFrame(const SharedFrame &frame);
+    void publishSpectrum(const QVector<float> &magnitudes, double binWidth);
+    void publishMeasurements(const QVariantMap &values);
+
+signals:
+    void clientsChanged();
+    void droppedChanged();
+
+private:
+    // A queued message keeps its source data, so each client encodes it
+    // with its own decimation
+    struct Message {
+        MessageType type = Frame;
+        quint64 sequence = 0;
+        SharedFrame frame;
+        QVector<float> spectrum;
+        double binWidth = 0.0;
+        QVector<QPair<QByteArray, double>> values;
+    };
+
+    struct Client {
+        QTcpSocket *socket = nullptr;
+        QByteArray received;
+        int streams = 0;
+        int decimation = 1;
+        qint64 minInterval = 0;   // Nanoseconds between messages of a type
+        qint64 lastQueued[3] = { -1, -1, -1 };
+        int depth = DefaultQueueDepth;
+        QVector<Message> queue;
+    };
+
+    void handleConnection();
+    void handleReadyRead(Client *client);
+    void removeClient(Client *client);
+    void updateSubscriptions();
+
+    // `stream` is the index of the stream bit: 0 frames, 1 spectra, 2 measurements
+    void enqueue(const Message &message, int stream);
+    void flush(Client *client);
+    void encode(const Message &message, const Client &client);
+    void beginMessage(MessageType type);
+    void endMessage();
+
+    QTcpServer m_server;
+    QVector<Client *> m_clients;
+    QByteArray m_buffer;       // Reused for encoding
+    QVector<float> m_volts;    // Channels with a nonlinear table, converted for encoding
+    QElapsedTimer m_clock;
+    int m_subscribed;
+    quint64 m_sequence[3];
+    quint64 m_dropped;
+};
+
+#endif // STREAMSERVER_H
@@ -0,0 +1,79 @@
+#include <QtTest>
+#include <QStandardPaths>
+#include "serialhandler.h"
+
+// Steady-state capture must not touch the heap: once the frame pool, the
+// assembler and the accumulators have settled, every frame from the parser
+// through the accumulators to the published pooled frame allocates nothing
+// on the capture thread. Outputs that hand data to QML or viewers (the
+// spectrum, measurement streams, frameReady) are excluded in acquireFrame().
+// Recording is not covered: the pyramid's level 0 grows with the recording,
+// so it allocates now and then, never per frame.
+class TestAllocations : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void steadyState_data();
+    void steadyState();
+};
+
+void TestAllocations::initTestCase()
+{
+    QVERIFY2(AllocationCounter::isEnabled(), "build with SCOPEX_COUNT_ALLOCATIONS");
+    // Keeps a calibration saved by the application out of the test
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void TestAllocations::steadyState_data()
+{
+    QTest::addColumn<int>("format");
+    QTest::addColumn<int>("mode");
+    QTest::addColumn<int>("length");
+
+    QTest::newRow("8-bit normal") << int(Bits8) << int(FrameAccumulator::Normal) << 1000;
+    QTest::newRow("8-bit average") << int(Bits8) << int(FrameAccumulator::RunningAverage) << 1000;
+    QTest::newRow("8-bit exponential") << int(Bits8) << int(FrameAccumulator::ExponentialAverage) << 1000;
+    QTest::newRow("8-bit envelope") << int(Bits8) << int(FrameAccumulator::Envelope) << 1000;
+    QTest::newRow("8-bit high resolution") << int(Bits8) << int(FrameAccumulator::HighResolution) << 1000;
+    QTest::newRow("12-bit packed normal") << int(Packed12) << int(FrameAccumulator::Normal) << 1000;
+    QTest::newRow("10-bit average") << int(Little10) << int(FrameAccumulator::RunningAverage) << 1000;
+    QTest::newRow("16-bit envelope") << int(Little16) << int(FrameAccumulator::Envelope) << 1000;
+    QTest::newRow("8-bit normal, 64k") << int(Bits8) << int(FrameAccumulator::Normal) << 65536;
+}
+
+void TestAllocations::steadyState()
+{
+    QFETCH(int, format);
+    QFETCH(int, mode);
+    QFETCH(int, length);
+
+    SerialHandler handler;
+    handler.setSampleFormat(format);
+    handler.setRecordLength(length);
+    handler.setAcquisitionMode(mode);
+    handler.setAcquisitionDepth(16);
+
+    // Both channels of one frame in the wire format, delivered in one read
+    QByteArray frame(2 * sampleBytes(SampleFormat(format), length), Qt::Uninitialized);
+    for (int i = 0; i < frame.size(); ++i) frame[i] = static_cast<char>((i * 37) & 0xFF);
+
+    // Past the averaging depth, so every ring and pool has its final size
+    constexpr int WarmUpFrames = 32;
+    constexpr int Frames = 256;
+    qint64 timestamp = 0;
+    for (int i = 0; i < WarmUpFrames; ++i) {
+        handler.processIncomingData(frame, timestamp += 1000000);
+    }
+
+    for (int i = 0; i < Frames; ++i) {
+        const quint64 before = AllocationCounter::count();
+        handler.processIncomingData(frame, timestamp += 1000000);
+        const quint64 allocations = AllocationCounter::count() - before;
+        if (allocations != 0) QFAIL(qPrintable(QStringLiteral("frame %1 allocated %2 times").arg(i).arg(allocations)));
+    }
+}
+
+QTEST_GUILESS_MAIN(TestAllocations)
+#include "tst_allocations.moc"
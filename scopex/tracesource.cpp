@@ -0,0 +1,141 @@
+#include "tracesource.h"
+#include "serialhandler.h"
+#include <QXYSeries>
+
+TraceSource::TraceSource(QObject *parent) : QObject(parent),
+    m_dataPending(false),
+    m_envelopePending(false),
+    m_updates(0),
+    m_dropped(0),
+    m_presented(0),
+    m_fps(0.0)
+{
+    m_idleTimer.setSingleShot(true);
+    m_idleTimer.setInterval(1000);
+    connect(&m_idleTimer, &QTimer::timeout, this, &TraceSource::presentIdle);
+}
+
+SerialHandler *TraceSource::handler() const
+{
+    return m_handler;
+}
+
+void TraceSource::setHandler(SerialHandler *handler)
+{
+    if (handler == m_handler) return;
+    if (m_handler) disconnect(m_handler, nullptr, this, nullptr);
+    m_handler = handler;
+    if (m_handler) {
+        connect(m_handler, &SerialHandler::dataReceived, this, [this]() { markPending(false); });
+        connect(m_handler, &SerialHandler::envelopeReceived, this, [this]() { markPending(true); });
+    }
+    emit handlerChanged();
+}
+
+bool TraceSource::pending() const
+{
+    return m_dataPending || m_envelopePending;
+}
+
+QVariantMap TraceSource::displayStats() const
+{
+    QVariantMap stats;
+    stats["fps"] = m_fps;
+    stats["dropped"] = m_dropped;
+    return stats;
+}
+
+void TraceSource::markPending(bool envelope)
+{
+    const bool wasPending = pending();
+    if (envelope) {
+        m_envelopePending = true;
+    } else {
+        m_dataPending = true;
+        ++m_updates;
+    }
+    if (!wasPending) emit pendingChanged();
+}
+
+void TraceSource::present()
+{
+    if (!pending()) return;
+
+    const bool data = m_dataPending;
+    const bool envelope = m_envelopePending;
+    m_dataPending = false;
+    m_envelopePending = false;
+    if (m_updates > 1) m_dropped += m_updates - 1;
+    m_updates = 0;
+    emit pendingChanged();
+
+    if (data) emit dataReady();
+    if (envelope) emit envelopeReady();
+
+    ++m_presented;
+    if (!m_fpsClock.isValid()) {
+        m_fpsClock.start();
+        m_presented = 0;
+    } else if (m_fpsClock.elapsed() >= 1000) {
+        m_fps = m_presented * 1000.0 / m_fpsClock.restart();
+        m_presented = 0;
+        emit displayStatsChanged();
+    }
+    m_idleTimer.start();
+}
+
+void TraceSource::presentIdle()
+{
+    // Nothing presented for a whole window, so the next frame starts a new one
+    m_fpsClock.invalidate();
+    m_presented = 0;
+    if (m_fps == 0.0) return;
+    m_fps = 0.0;
+    emit displayStatsChanged();
+}
+
+void TraceSource::updateSeries(QAbstractSeries *series, int channel, double gain)
+{
+    fillSeries(series, channel, gain, false);
+}
+
+void TraceSource::updateEnvelopeSeries(QAbstractSeries *series, int channel, double gain)
+{
+    fillSeries(series, channel, gain, true);
+}
+
+void TraceSource::updateOverviewSeries(QAbstractSeries *maximum, QAbstractSeries *minimum,
+                                       QAbstractSeries *mean, int channel, double start, double end,
+                                       int columns)
+{
+    if (!m_handler) return;
+
+    const SerialHandler::Overview overview = m_handler->recordingOverview(channel, start, end, columns);
+    const float *values[3] = { overview.maximum, overview.minimum, overview.mean };
+    QAbstractSeries *targets[3] = { maximum, minimum, mean };
+    for (int s = 0; s < 3; ++s) {
+        QXYSeries *xySeries = qobject_cast<QXYSeries *>(targets[s]);
+        if (!xySeries) continue;
+        QList<QPointF> points;
+        points.reserve(overview.count);
+        for (int i = 0; i < overview.count; ++i) {
+            points.append(QPointF(overview.start + (i + 0.5) * overview.step, values[s][i]));
+        }
+        xySeries->replace(points);
+    }
+}
+
+void TraceSource::fillSeries(QAbstractSeries *series, int channel, double gain, bool minimum)
+{
+    QXYSeries *xySeries = qobject_cast<QXYSeries *>(series);
+    if (!xySeries || !m_handler) return;
+
+    const SerialHandler::Trace trace = m_handler->displayTrace(channel, minimum);
+    const double scale = gain != 0.0 ? 1.0 / gain : 1.0;
+    QList<QPointF> points;
+    points.reserve(trace.count);
+    for (int i = 0; i < trace.count; ++i) {
+        points.append(QPointF(trace.start + i * trace.step, trace.values[i] * scale));
+    }
+    xySeries->replace(points);
+}
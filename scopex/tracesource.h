@@ -0,0 +1,75 @@
+#ifndef TRACESOURCE_H
+#define TRACESOURCE_H
+
+#include <QObject>
+#include <QPointer>
+#include <QVariantMap>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QAbstractSeries>
+
+class SerialHandler;
+Q_MOC_INCLUDE("serialhandler.h")
+
+// Feeds chart series from a SerialHandler. The handler itself knows
+// nothing of Qt Charts, so it can run without a GUI; this writes the
+// visible trace straight into a QXYSeries in one replace().
+//
+// It also paces the display. New data from the handler only marks the
+// trace pending; a FrameAnimation calls present() once per rendered frame
+// while something is pending, and dataReady() then redraws with whatever
+// is newest. Updates arriving between two vsyncs are coalesced and counted
+// as dropped, so the display is never more than a frame behind however
+// fast frames come in. Analysis in the handler still sees every frame.
+class TraceSource : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(SerialHandler *handler READ handler WRITE setHandler NOTIFY handlerChanged)
+    Q_PROPERTY(bool pending READ pending NOTIFY pendingChanged)
+    Q_PROPERTY(QVariantMap displayStats READ displayStats NOTIFY displayStatsChanged)
+
+public:
+    explicit TraceSource(QObject *parent = nullptr);
+
+    SerialHandler *handler() const;
+    void setHandler(SerialHandler *handler);
+    bool pending() const;
+    QVariantMap displayStats() const;
+
+public slots:
+    // Volts are divided by `gain`; the envelope variant draws the lower trace
+    void updateSeries(QAbstractSeries *series, int channel, double gain);
+    void updateEnvelopeSeries(QAbstractSeries *series, int channel, double gain);
+    // Recording overview between two times in seconds, one point per column
+    void updateOverviewSeries(QAbstractSeries *maximum, QAbstractSeries *minimum, QAbstractSeries *mean,
+                              int channel, double start, double end, int columns);
+    // Once per rendered frame: hands pending updates to the charts
+    void present();
+
+signals:
+    void handlerChanged();
+    void pendingChanged();
+    void displayStatsChanged();
+    void dataReady();
+    void envelopeReady();
+
+private:
+    void fillSeries(QAbstractSeries *series, int channel, double gain, bool minimum);
+    void markPending(bool envelope);
+    void presentIdle();
+
+    QPointer<SerialHandler> m_handler;
+    bool m_dataPending;
+    bool m_envelopePending;
+    int m_updates;            // Handler updates since the last present()
+    quint64 m_dropped;
+
+    // Presented frames per second, over windows of about a second; a window
+    // with nothing presented drops the rate to zero
+    QElapsedTimer m_fpsClock;
+    QTimer m_idleTimer;
+    int m_presented;
+    double m_fps;
+};
+
+#endif // TRACESOURCE_H
@@ -0,0 +1,187 @@
+#include "waterfallview.h"
+#include "serialhandler.h"
+#include <QSGSimpleTextureNode>
+
+namespace {
+// Two quads over the ring image: rows [0, head) on top, rows [head, rows)
+// below, both mirrored so the newest row of each is at its top edge
+class WaterfallNode : public QSGNode
+{
+public:
+    explicit WaterfallNode(ImageTexture *texture) :
+        m_texture(texture)
+    {
+        for (QSGSimpleTextureNode *&quad : m_quads) {
+            quad = new QSGSimpleTextureNode;
+            quad->setTexture(texture);
+            quad->setOwnsTexture(false);
+            quad->setFiltering(QSGTexture::Linear);
+            quad->setTextureCoordinatesTransform(QSGSimpleTextureNode::MirrorVertically);
+            appendChildNode(quad);
+        }
+    }
+
+    ~WaterfallNode() override
+    {
+        delete m_texture;
+    }
+
+    ImageTexture *texture() const { return m_texture; }
+
+    void layout(const QRectF &rect, int head)
+    {
+        const QSize size = m_texture->textureSize();
+        const qreal split = rect.height() * head / size.height();
+
+        m_quads[0]->setRect(QRectF(rect.x(), rect.y(), rect.width(), split));
+        m_quads[0]->setSourceRect(QRectF(0, 0, size.width(), head));
+        m_quads[1]->setRect(QRectF(rect.x(), rect.y() + split, rect.width(), rect.height() - split));
+        m_quads[1]->setSourceRect(QRectF(0, head, size.width(), size.height() - head));
+
+        // The texture changed even if the geometry did not
+        m_quads[0]->markDirty(QSGNode::DirtyMaterial);
+        m_quads[1]->markDirty(QSGNode::DirtyMaterial);
+    }
+
+private:
+    ImageTexture *m_texture;
+    QSGSimpleTextureNode *m_quads[2];
+};
+}
+
+WaterfallView::WaterfallView(QQuickItem *parent) : QQuickItem(parent),
+    m_channel(0),
+    m_minDb(-80.0),
+    m_maxDb(20.0),
+    m_uploadedRows(0),
+    m_rebuild(true),
+    m_rateRows(0),
+    m_rowRate(0.0)
+{
+    setFlag(ItemHasContents, true);
+    m_spectrogram.configure(2048, 256, 0.75);
+    m_rateTimer.start();
+}
+
+SerialHandler *WaterfallView::source() const
+{
+    return m_source;
+}
+
+void WaterfallView::setSource(SerialHandler *source)
+{
+    if (source == m_source) return;
+
+    disconnect(m_connection);
+    m_source = source;
+    if (m_source) {
+        m_connection = connect(m_source, &SerialHandler::frameReady, this, &WaterfallView::handleFrame);
+    }
+    emit sourceChanged();
+}
+
+void WaterfallView::setChannel(int channel)
+{
+    if (channel == m_channel) return;
+    m_channel = channel;
+    clear();
+    emit settingsChanged();
+}
+
+void WaterfallView::setFftSize(int size)
+{
+    if (size == fftSize()) return;
+    m_spectrogram.configure(size, rows(), overlap());
+    m_rebuild = true;
+    update();
+    emit settingsChanged();
+}
+
+void WaterfallView::setRows(int rows)
+{
+    if (rows == this->rows()) return;
+    m_spectrogram.configure(fftSize(), rows, overlap());
+    m_rebuild = true;
+    update();
+    emit settingsChanged();
+}
+
+void WaterfallView::setOverlap(double overlap)
+{
+    if (qFuzzyCompare(overlap, this->overlap())) return;
+    m_spectrogram.configure(fftSize(), rows(), overlap);
+    m_rebuild = true;
+    update();
+    emit settingsChanged();
+}
+
+void WaterfallView::setStreaming(bool streaming)
+{
+    if (streaming == this->streaming()) return;
+    m_spectrogram.setInputMode(streaming ? Spectrogram::Stream : Spectrogram::PerFrame);
+    emit settingsChanged();
+}
+
+void WaterfallView::setMinDb(double db)
+{
+    if (qFuzzyCompare(db, m_minDb)) return;
+    m_minDb = db;
+    m_spectrogram.setRange(m_minDb, m_maxDb);
+    emit settingsChanged();
+}
+
+void WaterfallView::setMaxDb(double db)
+{
+    if (qFuzzyCompare(db, m_maxDb)) return;
+    m_maxDb = db;
+    m_spectrogram.setRange(m_minDb, m_maxDb);
+    emit settingsChanged();
+}
+
+void WaterfallView::clear()
+{
+    m_spectrogram.reset();
+    m_rebuild = true;
+    update();
+}
+
+void WaterfallView::handleFrame(const VoltFrame &frame)
+{
+    if (m_channel >= frame.channels()) return;
+    if (m_spectrogram.addSamples(frame.channel(m_channel), frame.length()) > 0) {
+        update();
+    }
+
+    const qint64 elapsed = m_rateTimer.elapsed();
+    if (m_spectrogram.rowsProduced() < m_rateRows) m_rateRows = 0;
+    if (elapsed >= 1000) {
+        m_rowRate = (m_spectrogram.rowsProduced() - m_rateRows) * 1000.0 / elapsed;
+        m_rateRows = m_spectrogram.rowsProduced();
+        m_rateTimer.restart();
+        emit rowRateChanged();
+    }
+}
+
+QSGNode *WaterfallView::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
+{
+    WaterfallNode *node = static_cast<WaterfallNode *>(oldNode);
+    const QImage &image = m_spectrogram.image();
+
+    if (node && (m_rebuild || node->texture()->textureSize() != image.size())) {
+        delete node;
+        node = nullptr;
+    }
+
+    if (!node) {
+        node = new WaterfallNode(new ImageTexture(image));
+    } else {
+        const quint64 pending = m_spectrogram.rowsProduced() - m_uploadedRows;
+        node->texture()->updateRows(image, m_spectrogram.head(),
+                                    static_cast<int>(qMin<quint64>(pending, image.height())));
+    }
+
+    m_rebuild = false;
+    m_uploadedRows = m_spectrogram.rowsProduced();
+    node->layout(boundingRect(), m_spectrogram.head());
+    return node;
+}
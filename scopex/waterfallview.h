@@ -0,0 +1,82 @@
+#ifndef WATERFALLVIEW_H
+#define WATERFALLVIEW_H
+
+#include <QQuickItem>
+#include <QPointer>
+#include <QElapsedTimer>
+#include "imagetexture.h"
+#include "spectrogram.h"
+#include "scopeframe.h"
+
+class SerialHandler;
+Q_MOC_INCLUDE("serialhandler.h")
+
+// Scrolling spectrogram of one channel. The newest row is drawn at the top;
+// scrolling is done by moving the split point of the ring between two
+// textured quads, so the texture is never rebuilt or shifted.
+class WaterfallView : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(SerialHandler *source READ source WRITE setSource NOTIFY sourceChanged)
+    Q_PROPERTY(int channel READ channel WRITE setChannel NOTIFY settingsChanged)
+    Q_PROPERTY(int fftSize READ fftSize WRITE setFftSize NOTIFY settingsChanged)
+    Q_PROPERTY(int rows READ rows WRITE setRows NOTIFY settingsChanged)
+    Q_PROPERTY(double overlap READ overlap WRITE setOverlap NOTIFY settingsChanged)
+    Q_PROPERTY(bool streaming READ streaming WRITE setStreaming NOTIFY settingsChanged)
+    Q_PROPERTY(double minDb READ minDb WRITE setMinDb NOTIFY settingsChanged)
+    Q_PROPERTY(double maxDb READ maxDb WRITE setMaxDb NOTIFY settingsChanged)
+    Q_PROPERTY(double rowRate READ rowRate NOTIFY rowRateChanged)
+
+public:
+    explicit WaterfallView(QQuickItem *parent = nullptr);
+
+    SerialHandler *source() const;
+    void setSource(SerialHandler *source);
+
+    int channel() const { return m_channel; }
+    void setChannel(int channel);
+    int fftSize() const { return m_spectrogram.fftSize(); }
+    void setFftSize(int size);
+    int rows() const { return m_spectrogram.rows(); }
+    void setRows(int rows);
+    double overlap() const { return m_spectrogram.overlap(); }
+    void setOverlap(double overlap);
+    bool streaming() const { return m_spectrogram.inputMode() == Spectrogram::Stream; }
+    void setStreaming(bool streaming);
+    double minDb() const { return m_minDb; }
+    void setMinDb(double db);
+    double maxDb() const { return m_maxDb; }
+    void setMaxDb(double db);
+    double rowRate() const { return m_rowRate; }
+
+public slots:
+    void clear();
+
+signals:
+    void sourceChanged();
+    void settingsChanged();
+    void rowRateChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+
+private:
+    void handleFrame(const VoltFrame &frame);
+
+    QPointer<SerialHandler> m_source;
+    QMetaObject::Connection m_connection;
+
+    Spectrogram m_spectrogram;
+    int m_channel;
+    double m_minDb;
+    double m_maxDb;
+
+    quint64 m_uploadedRows;  // rowsProduced() at the last sync
+    bool m_rebuild;          // Texture must be recreated at the next sync
+
+    QElapsedTimer m_rateTimer;
+    quint64 m_rateRows;
+    double m_rowRate;
+};
+
+#endif // WATERFALLVIEW_H
@@ -0,0 +1,157 @@
+#include "xyraster.h"
+#include <QtMath>
+#include <cstring>
+
+namespace {
+// Intensity deposited per sample interval, shared by the pixels it covers
+const int SampleEnergy = 8192;
+}
+
+XYRaster::XYRaster() :
+    m_range(5.0),
+    m_persistence(0.0),
+    m_connectPoints(true),
+    m_color(Qt::green)
+{
+    m_interpolator.setFactor(8);
+    setColor(m_color);
+    setSize(512);
+}
+
+void XYRaster::setSize(int size)
+{
+    size = qBound(64, size, 2048);
+    if (size == this->size()) return;
+    m_image = QImage(size, size, QImage::Format_RGBA8888);
+    m_intensity.resize(size * size);
+    clear();
+}
+
+void XYRaster::setRange(double volts)
+{
+    m_range = qMax(0.01, volts);
+    clear();
+}
+
+void XYRaster::setPersistence(double retained)
+{
+    m_persistence = qBound(0.0, retained, 1.0);
+}
+
+void XYRaster::setConnectPoints(bool connect)
+{
+    m_connectPoints = connect;
+}
+
+void XYRaster::setInterpolation(bool enabled)
+{
+    m_interpolator.setMode(enabled ? Interpolator::SincInterpolation : Interpolator::LinearInterpolation);
+}
+
+void XYRaster::setColor(const QColor &color)
+{
+    m_color = color;
+
+    // Square-root ramp so a single fast trace is still visible over black
+    for (int i = 0; i < 256; ++i) {
+        const double level = qSqrt(i / 255.0);
+        const uchar rgba[4] = {
+            static_cast<uchar>(color.red() * level),
+            static_cast<uchar>(color.green() * level),
+            static_cast<uchar>(color.blue() * level),
+            255
+        };
+        std::memcpy(&m_palette[i], rgba, sizeof(rgba));
+    }
+    colorize();
+}
+
+void XYRaster::clear()
+{
+    m_intensity.fill(0);
+    m_image.fill(QColor(0, 0, 0));
+}
+
+void XYRaster::deposit(int column, int row, int weight)
+{
+    quint16 &cell = m_intensity[row * size() + column];
+    cell = static_cast<quint16>(qMin(MaxIntensity, cell + weight));
+}
+
+void XYRaster::fade()
+{
+    if (m_persistence >= 1.0) return;
+    if (m_persistence <= 0.0) {
+        m_intensity.fill(0);
+        return;
+    }
+
+    const quint32 keep = static_cast<quint32>(m_persistence * 65536.0);
+    quint16 *cell = m_intensity.data();
+    const int cells = m_intensity.size();
+    for (int i = 0; i < cells; ++i) {
+        cell[i] = static_cast<quint16>((cell[i] * keep) >> 16);
+    }
+}
+
+void XYRaster::colorize()
+{
+    if (m_image.isNull()) return;
+
+    const int cells = m_intensity.size();
+    const quint16 *cell = m_intensity.constData();
+    quint32 *pixel = reinterpret_cast<quint32 *>(m_image.bits());
+    for (int i = 0; i < cells; ++i) {
+        // Square root of the 16-bit intensity indexes the 8-bit palette
+        pixel[i] = m_palette[qMin(255, static_cast<int>(std::sqrt(float(cell[i]))))];
+    }
+}
+
+void XYRaster::addFrame(const float *x, const float *y, int count)
+{
+    fade();
+
+    if (count > 0) {
+        const int points = m_interpolator.outputLength(count);
+        m_x.resize(points);
+        m_y.resize(points);
+        const int n = m_interpolator.process(x, count, 0, count, m_x.data());
+        m_interpolator.process(y, count, 0, count, m_y.data());
+
+        const int last = size() - 1;
+        const float scale = static_cast<float>(last / (2.0 * m_range));
+        const float offset = static_cast<float>(m_range);
+        auto column = [&](float v) { return (v + offset) * scale; };
+        auto row = [&](float v) { return last - (v + offset) * scale; };
+
+        auto plot = [&](float c, float r, int weight) {
+            const int ci = qRound(c);
+            const int ri = qRound(r);
+            if (ci >= 0 && ci <= last && ri >= 0 && ri <= last) deposit(ci, ri, weight);
+        };
+
+        float x0 = column(m_x[0]);
+        float y0 = row(m_y[0]);
+        plot(x0, y0, SampleEnergy);
+        for (int i = 1; i < n; ++i) {
+            const float x1 = column(m_x[i]);
+            const float y1 = row(m_y[i]);
+            if (!m_connectPoints) {
+                plot(x1, y1, SampleEnergy);
+            } else {
+                // Step along the segment one pixel at a time; the same energy
+                // spread over more pixels draws fast edges dimmer, as on a CRT
+                const int steps = qMax(1, qCeil(qMax(qAbs(x1 - x0), qAbs(y1 - y0))));
+                const int weight = qMax(1, SampleEnergy / steps);
+                for (int s = 1; s <= steps; ++s) {
+                    const float t = float(s) / steps;
+                    plot(x0 + (x1 - x0) * t, y0 + (y1 - y0) * t, weight);
+                }
+            }
+            x0 = x1;
+            y0 = y1;
+        }
+    }
+
+    colorize();
+}
@@ -0,0 +1,60 @@
+#ifndef XYRASTER_H
+#define XYRASTER_H
+
+#include <QImage>
+#include <QColor>
+#include <QVector>
+#include "interpolator.h"
+
+// CH1 against CH2, drawn into an intensity buffer the way a CRT beam would:
+// each sample interval deposits the same energy, spread along the segment
+// between consecutive points (or on the point alone when not connected).
+// Older traces fade by a fixed factor per frame. The colour mapped result
+// is an RGBA image of size() x size() with +range at the right and top.
+class XYRaster
+{
+public:
+    static constexpr int MaxIntensity = 65535;
+
+    XYRaster();
+
+    void setSize(int size);
+    void setRange(double volts);
+    void setPersistence(double retained);  // Fraction kept per frame, 0 to 1
+    void setConnectPoints(bool connect);
+    void setInterpolation(bool enabled);
+    void setColor(const QColor &color);
+    void clear();
+
+    int size() const { return m_image.width(); }
+    double range() const { return m_range; }
+    double persistence() const { return m_persistence; }
+    bool connectPoints() const { return m_connectPoints; }
+    bool interpolation() const { return m_interpolator.mode() == Interpolator::SincInterpolation; }
+    QColor color() const { return m_color; }
+
+    // Pairs x[i] with y[i], fades the previous content and redraws the image
+    void addFrame(const float *x, const float *y, int count);
+
+    const QImage &image() const { return m_image; }
+
+private:
+    void deposit(int column, int row, int weight);
+    void fade();
+    void colorize();
+
+    QImage m_image;
+    QVector<quint16> m_intensity;
+    double m_range;
+    double m_persistence;
+    bool m_connectPoints;
+    QColor m_color;
+    quint32 m_palette[256];
+
+    // Both channels go through the same upsampler, so pairs stay aligned
+    Interpolator m_interpolator;
+    QVector<float> m_x;
+    QVector<float> m_y;
+};
+
+#endif // XYRASTER_H
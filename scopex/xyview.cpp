@@ -0,0 +1,126 @@
+#include "xyview.h"
+#include "serialhandler.h"
+#include "imagetexture.h"
+#include <QSGSimpleTextureNode>
+
+XYView::XYView(QQuickItem *parent) : QQuickItem(parent),
+    m_dirty(false),
+    m_rebuild(true)
+{
+    setFlag(ItemHasContents, true);
+}
+
+SerialHandler *XYView::source() const
+{
+    return m_source;
+}
+
+void XYView::setSource(SerialHandler *source)
+{
+    if (source == m_source) return;
+
+    disconnect(m_connection);
+    m_source = source;
+    if (m_source) {
+        m_connection = connect(m_source, &SerialHandler::frameReady, this, &XYView::handleFrame);
+    }
+    emit sourceChanged();
+}
+
+void XYView::setRange(double volts)
+{
+    if (qFuzzyCompare(volts, range())) return;
+    m_raster.setRange(volts);
+    redraw();
+    emit settingsChanged();
+}
+
+void XYView::setPersistence(double retained)
+{
+    if (qFuzzyCompare(retained, persistence())) return;
+    m_raster.setPersistence(retained);
+    emit settingsChanged();
+}
+
+void XYView::setConnectPoints(bool connect)
+{
+    if (connect == connectPoints()) return;
+    m_raster.setConnectPoints(connect);
+    emit settingsChanged();
+}
+
+void XYView::setInterpolation(bool enabled)
+{
+    if (enabled == interpolation()) return;
+    m_raster.setInterpolation(enabled);
+    emit settingsChanged();
+}
+
+void XYView::setColor(const QColor &color)
+{
+    if (color == this->color()) return;
+    m_raster.setColor(color);
+    redraw();
+    emit settingsChanged();
+}
+
+void XYView::setResolution(int size)
+{
+    if (size == resolution()) return;
+    m_raster.setSize(size);
+    m_rebuild = true;
+    update();
+    emit settingsChanged();
+}
+
+void XYView::clear()
+{
+    m_raster.clear();
+    redraw();
+}
+
+void XYView::redraw()
+{
+    m_dirty = true;
+    update();
+}
+
+void XYView::handleFrame(const VoltFrame &frame)
+{
+    // Nothing to rasterize while another display mode is shown
+    if (!isVisible() || frame.channels() < 2) return;
+
+    m_raster.addFrame(frame.channel(0), frame.channel(1), frame.length());
+    redraw();
+}
+
+QSGNode *XYView::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
+{
+    QSGSimpleTextureNode *node = static_cast<QSGSimpleTextureNode *>(oldNode);
+    const QImage &image = m_raster.image();
+
+    if (node && m_rebuild) {
+        delete node;
+        node = nullptr;
+    }
+
+    // The ring texture of the waterfall serves here with every row dirty
+    if (!node) {
+        node = new QSGSimpleTextureNode;
+        node->setTexture(new ImageTexture(image));
+        node->setOwnsTexture(true);
+        node->setFiltering(QSGTexture::Linear);
+    } else if (m_dirty) {
+        static_cast<ImageTexture *>(node->texture())->updateRows(image, 0, image.height());
+        node->markDirty(QSGNode::DirtyMaterial);
+    }
+
+    m_rebuild = false;
+    m_dirty = false;
+
+    // Square plot area, centred in the item
+    const QRectF bounds = boundingRect();
+    const qreal side = qMin(bounds.width(), bounds.height());
+    node->setRect(QRectF(bounds.center().x() - side / 2, bounds.center().y() - side / 2, side, side));
+    return node;
+}
@@ -0,0 +1,67 @@
+#ifndef XYVIEW_H
+#define XYVIEW_H
+
+#include <QQuickItem>
+#include <QPointer>
+#include <QColor>
+#include "xyraster.h"
+#include "scopeframe.h"
+
+class SerialHandler;
+Q_MOC_INCLUDE("serialhandler.h")
+
+// XY (Lissajous) display. Points are paired and rasterized in C++ on every
+// frame and the image reaches the scene graph as a single texture upload.
+class XYView : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(SerialHandler *source READ source WRITE setSource NOTIFY sourceChanged)
+    Q_PROPERTY(double range READ range WRITE setRange NOTIFY settingsChanged)
+    Q_PROPERTY(double persistence READ persistence WRITE setPersistence NOTIFY settingsChanged)
+    Q_PROPERTY(bool connectPoints READ connectPoints WRITE setConnectPoints NOTIFY settingsChanged)
+    Q_PROPERTY(bool interpolation READ interpolation WRITE setInterpolation NOTIFY settingsChanged)
+    Q_PROPERTY(QColor color READ color WRITE setColor NOTIFY settingsChanged)
+    Q_PROPERTY(int resolution READ resolution WRITE setResolution NOTIFY settingsChanged)
+
+public:
+    explicit XYView(QQuickItem *parent = nullptr);
+
+    SerialHandler *source() const;
+    void setSource(SerialHandler *source);
+
+    double range() const { return m_raster.range(); }
+    void setRange(double volts);
+    double persistence() const { return m_raster.persistence(); }
+    void setPersistence(double retained);
+    bool connectPoints() const { return m_raster.connectPoints(); }
+    void setConnectPoints(bool connect);
+    bool interpolation() const { return m_raster.interpolation(); }
+    void setInterpolation(bool enabled);
+    QColor color() const { return m_raster.color(); }
+    void setColor(const QColor &color);
+    int resolution() const { return m_raster.size(); }
+    void setResolution(int size);
+
+public slots:
+    void clear();
+
+signals:
+    void sourceChanged();
+    void settingsChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+
+private:
+    void handleFrame(const VoltFrame &frame);
+    void redraw();
+
+    QPointer<SerialHandler> m_source;
+    QMetaObject::Connection m_connection;
+
+    XYRaster m_raster;
+    bool m_dirty;    // Image changed since the last sync
+    bool m_rebuild;  // Texture must be recreated at the next sync
+};
+
+#endif // XYVIEW_H